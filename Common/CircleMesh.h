@@ -0,0 +1,63 @@
+#ifndef __Circle_Mesh_h__
+#define __Circle_Mesh_h__
+
+// Unit circle as triangle fan around node 0, generated at compile time.
+//   constexpr CircleMesh<60> mesh;
+// has mesh.node_num = 61 nodes (x, y) and 60 triangles.
+namespace CircleMeshDetail
+{
+	constexpr double pi = 3.14159265358979323846;
+
+	// taylor series, x in [-pi, pi]
+	constexpr double sin_series(double x)
+	{
+		double term = x, sum = x;
+		for (int n = 1; n < 16; ++n)
+		{
+			term *= -x * x / double((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr double wrap_angle(double a)
+	{
+		while (a > pi)
+			a -= 2.0 * pi;
+		while (a < -pi)
+			a += 2.0 * pi;
+		return a;
+	}
+
+	constexpr double sin(double a) { return sin_series(wrap_angle(a)); }
+	constexpr double cos(double a) { return sin_series(wrap_angle(a + 0.5 * pi)); }
+}
+
+template <unsigned int SegNum>
+struct CircleMesh
+{
+	static_assert(SegNum >= 3, "Circle needs at least 3 segments.");
+
+	static constexpr unsigned int node_num = SegNum + 1;
+	static constexpr unsigned int elem_num = SegNum;
+
+	float nodes[node_num * 2];
+	unsigned int elems[elem_num * 3];
+
+	constexpr CircleMesh() : nodes(), elems()
+	{
+		nodes[0] = 0.0f;
+		nodes[1] = 0.0f;
+		for (unsigned int s_id = 0; s_id < SegNum; ++s_id)
+		{
+			double a = 2.0 * CircleMeshDetail::pi * double(s_id) / double(SegNum);
+			nodes[(s_id + 1) * 2] = float(CircleMeshDetail::cos(a));
+			nodes[(s_id + 1) * 2 + 1] = float(CircleMeshDetail::sin(a));
+			elems[s_id * 3] = 0;
+			elems[s_id * 3 + 1] = s_id + 1;
+			elems[s_id * 3 + 2] = s_id + 1 < SegNum ? s_id + 2 : 1;
+		}
+	}
+};
+
+#endif
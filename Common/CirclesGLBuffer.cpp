@@ -1,114 +1,573 @@
 #include <math.h>
+#include <string.h>
 
-#include "circle_mesh_data.h"
+#include <glm/gtc/packing.hpp>
+
+#include "ParallelFor.h"
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
 
 #include "CirclesGLBuffer.h"
 
 CirclesGLBuffer::CirclesGLBuffer() :
-	vao(0), vbo(0), vbo_inst(0), ebo(0)
+	pt_num(0), vao(0), vao_points(0), vbo(0), vbo_inst(0), ebo(0),
+	cmd_buf(0), max_pt_num(0), inst_style(UniformStyle),
+	pt_radius(0.0f), pt_color(1.0f), max_pt_radius(0.0f),
+	inst_base(0),
+	draw_mode(AutoMode), pixel_scale(0.0f), max_point_size(0.0f),
+	base_inst_support(false), blend_enabled(GL_TRUE),
+	blend_src(GL_ONE), blend_dst(GL_ZERO),
+	uniform_program(0), draw_mode_loc(-1), pixel_scale_loc(-1)
 {
-
+	set_circle_mesh<60>();
 }
 
 CirclesGLBuffer::~CirclesGLBuffer() { clear(); }
 
 void CirclesGLBuffer::clear()
 {
+	GLStateCache& gl_state = GLStateCache::get();
+
 	if (ebo)
 	{
-		glDeleteBuffers(1, &ebo);
+		gl_state.delete_buffers(1, &ebo);
 		ebo = 0;
 	}
 	if (vbo)
 	{
-		glDeleteBuffers(1, &vbo);
+		gl_state.delete_buffers(1, &vbo);
 		vbo = 0;
 	}
 	if (vbo_inst)
 	{
-		glDeleteBuffers(1, &vbo_inst);
+		gl_state.delete_buffers(1, &vbo_inst);
 		vbo_inst = 0;
 	}
+	if (cmd_buf)
+	{
+		gl_state.delete_buffers(1, &cmd_buf);
+		cmd_buf = 0;
+	}
 	if (vao)
 	{
-		glDeleteVertexArrays(1, &vao);
+		gl_state.delete_vertex_arrays(1, &vao);
 		vao = 0;
 	}
+	if (vao_points)
+	{
+		gl_state.delete_vertex_arrays(1, &vao_points);
+		vao_points = 0;
+	}
+	inst_stream.clear();
+	inst_base = 0;
+	pt_num = 0;
+	max_pt_num = 0;
 }
 
-int CirclesGLBuffer::init(
-	std::vector<glm::vec2> &pts,
-	float pt_area,
-	glm::vec3& pt_color
-	)
+// quad corners after mesh nodes
+static const GLfloat quad_nodes[] = {
+	-1.0f, -1.0f,
+	 1.0f, -1.0f,
+	-1.0f,  1.0f,
+	 1.0f,  1.0f
+};
+
+void CirclesGLBuffer::init_circle_mesh()
 {
+	GLStateCache& gl_state = GLStateCache::get();
+
+	GLfloat point_size_range[2] = { 0.0f, 0.0f };
+	glGetFloatv(GL_POINT_SIZE_RANGE, point_size_range);
+	max_point_size = point_size_range[1];
+	GLint major_version = 0, minor_version = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+	glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+	base_inst_support =
+		(major_version > 4 || (major_version == 4 && minor_version >= 2));
+
 	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	gl_state.bind_vertex_array(vao);
 
 	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glGenBuffers(1, &ebo);
+	upload_circle_mesh();
+	gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(GLfloat), (GLvoid *)0);
+	glEnableVertexAttribArray(0);
+	gl_state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+}
+
+void CirclesGLBuffer::upload_circle_mesh()
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	size_t mesh_size = sizeof(GLfloat) * 2 * mesh_node_num;
+	gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo);
 	glBufferData(GL_ARRAY_BUFFER,
-		sizeof(circle_nodes),
-		circle_nodes,
+		mesh_size + sizeof(quad_nodes),
+		nullptr,
 		GL_STATIC_DRAW
 		);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(GLfloat), (GLvoid *)0);
-	glEnableVertexAttribArray(0);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, mesh_size, mesh_nodes);
+	glBufferSubData(GL_ARRAY_BUFFER, mesh_size, sizeof(quad_nodes), quad_nodes);
+	gl_state.bind_buffer(GL_ARRAY_BUFFER, 0);
 
-	glGenBuffers(1, &ebo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-		sizeof(circle_elems),
-		circle_elems,
+	// element buffer binding is part of vao state
+	gl_state.bind_buffer(GL_COPY_WRITE_BUFFER, ebo);
+	glBufferData(GL_COPY_WRITE_BUFFER,
+		sizeof(GLuint) * 3 * mesh_elem_num,
+		mesh_elems,
 		GL_STATIC_DRAW
 		);
+	gl_state.bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (cmd_buf)
+	{
+		DrawCommands cmds;
+		cmds.mesh.elem_num = 3 * mesh_elem_num;
+		cmds.quad.first_vert = mesh_node_num;
+		gl_state.bind_buffer(GL_DRAW_INDIRECT_BUFFER, cmd_buf);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER,
+			offsetof(DrawCommands, mesh.elem_num),
+			sizeof(GLuint), &cmds.mesh.elem_num);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER,
+			offsetof(DrawCommands, quad.first_vert),
+			sizeof(GLuint), &cmds.quad.first_vert);
+		gl_state.bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+}
+
+// set instance attributes of vao and vao_points
+void CirclesGLBuffer::init_inst_attribs(GLuint inst_buf)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	glGenVertexArrays(1, &vao_points);
+	const GLuint vaos[2] = { vao, vao_points };
+	const GLuint divisors[2] = { 1, 0 };
+	for (size_t v_id = 0; v_id < 2; ++v_id)
+	{
+		gl_state.bind_vertex_array(vaos[v_id]);
+		gl_state.bind_buffer(GL_ARRAY_BUFFER, inst_buf);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, get_inst_size(), (GLvoid *)0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribDivisor(1, divisors[v_id]);
+		if (inst_style == UniformStyle)
+		{
+			// constant attributes set in draw()
+			glDisableVertexAttribArray(2);
+			glDisableVertexAttribArray(3);
+			continue;
+		}
+		glVertexAttribPointer(2, 1, GL_HALF_FLOAT, GL_FALSE, sizeof(InstData), (GLvoid*)offsetof(InstData, radius));
+		glEnableVertexAttribArray(2);
+		glVertexAttribDivisor(2, divisors[v_id]);
+		// shader reads rgb of normalized rgba8
+		glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstData), (GLvoid*)offsetof(InstData, color));
+		glEnableVertexAttribArray(3);
+		glVertexAttribDivisor(3, divisors[v_id]);
+	}
+	gl_state.bind_vertex_array(0);
+	gl_state.bind_buffer(GL_ARRAY_BUFFER, 0);
+}
 
-	pt_num = pts.size();
-	float pt_r = sqrt(pt_area);
-	InstData *inst_data = new InstData[pt_num];
-	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+void CirclesGLBuffer::fill_inst_data(void *data, const glm::vec2 *pts,
+	const float *radii, const glm::vec3 *colors, size_t num)
+{
+	// write sequentially, the mapping may be write combined memory
+	// threads are created per call, so each one gets at least
+	// min_pt_num_per_thread points and smaller per frame updates
+	// are written by the calling thread only
+	const size_t min_pt_num_per_thread = 1 << 16;
+	size_t thread_num = num / min_pt_num_per_thread;
+	if (thread_num > get_default_thread_num())
+		thread_num = get_default_thread_num();
+	if (thread_num == 0)
+		thread_num = 1;
+	if (inst_style == UniformStyle)
 	{
-		glm::vec2 &pt = pts[p_id];
-		InstData &id = inst_data[p_id];
-		id.x = pt.x;
-		id.y = pt.y;
-		id.radius = pt_r;
-		id.r = pt_color.r;
-		id.g = pt_color.g;
-		id.b = pt_color.b;
+		glm::vec2 *pos_data = (glm::vec2 *)data;
+		parallel_for(num, thread_num,
+			[&](size_t th_id, size_t begin, size_t end)
+		{
+			memcpy(pos_data + begin, pts + begin, sizeof(glm::vec2) * (end - begin));
+		});
+		max_pt_radius = pt_radius;
+		return;
 	}
+
+	std::vector<float> th_max_radii(thread_num, pt_radius);
+	const GLushort def_radius = GLushort(glm::packHalf1x16(pt_radius));
+	const GLuint def_color = glm::packUnorm4x8(glm::vec4(pt_color, 1.0f));
+	InstData *inst_data = (InstData *)data;
+	parallel_for(num, thread_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t p_id = begin; p_id < end; ++p_id)
+		{
+			InstData &id = inst_data[p_id];
+			id.x = pts[p_id].x;
+			id.y = pts[p_id].y;
+			id.radius = radii ? GLushort(glm::packHalf1x16(radii[p_id])) : def_radius;
+			id.padding = 0;
+			id.color = colors ? glm::packUnorm4x8(glm::vec4(colors[p_id], 1.0f)) : def_color;
+		}
+		if (radii && end > begin)
+		{
+			float &max_radius = th_max_radii[th_id];
+			max_radius = radii[begin];
+			for (size_t p_id = begin + 1; p_id < end; ++p_id)
+				if (max_radius < radii[p_id])
+					max_radius = radii[p_id];
+		}
+	});
+	max_pt_radius = 0.0f;
+	for (size_t th_id = 0; th_id < thread_num; ++th_id)
+		if (max_pt_radius < th_max_radii[th_id])
+			max_pt_radius = th_max_radii[th_id];
+}
+
+int CirclesGLBuffer::init(
+	const glm::vec2 *pts,
+	size_t _pt_num,
+	float pt_area,
+	const glm::vec3 &_pt_color
+	)
+{
+	clear();
+	init_circle_mesh();
+
+	pt_num = _pt_num;
+	max_pt_num = _pt_num;
+	inst_style = UniformStyle;
+	set_point_style(pt_area, _pt_color);
+	// points can be uploaded as they are
 	glGenBuffers(1, &vbo_inst);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_inst);
+	GLStateCache::get().bind_buffer(GL_ARRAY_BUFFER, vbo_inst);
 	glBufferData(GL_ARRAY_BUFFER,
-		sizeof(InstData) * pt_num,
-		inst_data,
+		sizeof(glm::vec2) * pt_num,
+		pts,
 		GL_STATIC_DRAW
 		);
-	delete[] inst_data;
 
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(InstData), (GLvoid *)0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribDivisor(1, 1);
-	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(InstData), (GLvoid*)offsetof(InstData, radius));
-	glEnableVertexAttribArray(2);
-	glVertexAttribDivisor(2, 1);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(InstData), (GLvoid*)offsetof(InstData, r));
-	glEnableVertexAttribArray(3);
-	glVertexAttribDivisor(3, 1);
+	init_inst_attribs(vbo_inst);
 
-	glBindVertexArray(0);
+	return 0;
+}
+
+int CirclesGLBuffer::init(
+	const glm::vec2 *pts,
+	const float *radii,
+	const glm::vec3 *colors,
+	size_t _pt_num
+	)
+{
+	clear();
+	init_circle_mesh();
+
+	pt_num = _pt_num;
+	max_pt_num = _pt_num;
+	inst_style = PerInstanceStyle;
+	std::vector<InstData> inst_data(pt_num);
+	fill_inst_data(inst_data.size() ? &inst_data[0] : nullptr,
+		pts, radii, colors, pt_num);
+	glGenBuffers(1, &vbo_inst);
+	GLStateCache::get().bind_buffer(GL_ARRAY_BUFFER, vbo_inst);
+	glBufferData(GL_ARRAY_BUFFER,
+		sizeof(InstData) * pt_num,
+		inst_data.size() ? &inst_data[0] : nullptr,
+		GL_STATIC_DRAW
+		);
+
+	init_inst_attribs(vbo_inst);
 
 	return 0;
 }
 
-void CirclesGLBuffer::draw(OpenGLShaderProgram& shader)
+int CirclesGLBuffer::init_gpu(
+	size_t _max_pt_num,
+	float pt_area,
+	const glm::vec3 &_pt_color
+	)
 {
-	glBindVertexArray(vao);
-	glDrawElementsInstanced(
-		GL_TRIANGLES,
-		sizeof(circle_elems) / sizeof(circle_elems[0]),
-		GL_UNSIGNED_INT,
+	GLStateCache& gl_state = GLStateCache::get();
+
+	clear();
+	init_circle_mesh();
+
+	pt_num = 0;
+	max_pt_num = _max_pt_num;
+	inst_style = UniformStyle;
+	set_point_style(pt_area, _pt_color);
+	// written by compute shader, read by vertex fetch
+	glGenBuffers(1, &vbo_inst);
+	gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo_inst);
+	glBufferData(GL_ARRAY_BUFFER,
+		sizeof(glm::vec2) * max_pt_num,
 		nullptr,
-		pt_num
+		GL_DYNAMIC_COPY
 		);
+
+	init_inst_attribs(vbo_inst);
+
+	DrawCommands cmds;
+	cmds.mesh.elem_num = 3 * mesh_elem_num;
+	cmds.mesh.inst_num = 0;
+	cmds.mesh.first_elem = 0;
+	cmds.mesh.base_vertex = 0;
+	cmds.mesh.base_inst = 0;
+	cmds.quad.vert_num = 4;
+	cmds.quad.inst_num = 0;
+	cmds.quad.first_vert = mesh_node_num;
+	cmds.quad.base_inst = 0;
+	cmds.points.vert_num = 0;
+	cmds.points.inst_num = 1;
+	cmds.points.first_vert = 0;
+	cmds.points.base_inst = 0;
+	glGenBuffers(1, &cmd_buf);
+	gl_state.bind_buffer(GL_DRAW_INDIRECT_BUFFER, cmd_buf);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(cmds), &cmds, GL_DYNAMIC_COPY);
+	gl_state.bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	return 0;
+}
+
+int CirclesGLBuffer::init_stream(
+	size_t _max_pt_num,
+	float pt_area,
+	const glm::vec3 &_pt_color,
+	InstStyle style
+	)
+{
+	clear();
+	inst_style = style;
+	if (inst_stream.init(GL_ARRAY_BUFFER, get_inst_size() * _max_pt_num))
+		return -1;
+	init_circle_mesh();
+
+	pt_num = 0;
+	max_pt_num = _max_pt_num;
+	set_point_style(pt_area, _pt_color);
+	// regions are selected with base instance when drawing,
+	// so attribute pointers stay at offset 0
+	init_inst_attribs(inst_stream.get_id());
+	return 0;
+}
+
+int CirclesGLBuffer::update(
+	const glm::vec2 *pts,
+	const float *radii,
+	const glm::vec3 *colors,
+	size_t _pt_num
+	)
+{
+	if (!is_stream_buffer())
+		return -1;
+	if (_pt_num > max_pt_num)
+	{
+		std::cout << "CirclesGLBuffer: Too many points for stream buffer.\n";
+		_pt_num = max_pt_num;
+	}
+
+	FrameProfiler::Scope scope(FrameProfiler::get_cur_profiler(), "circles_upload");
+	void *inst_data = inst_stream.map_region();
+	if (!inst_data)
+		return -1;
+	fill_inst_data(inst_data, pts, radii, colors, _pt_num);
+	inst_base = inst_stream.unmap_region() / get_inst_size();
+	pt_num = _pt_num;
+	return 0;
+}
+
+void CirclesGLBuffer::reset_gpu_point_num()
+{
+	if (!cmd_buf)
+		return;
+	GLuint zero = 0;
+	GLStateCache::get().bind_buffer(GL_DRAW_INDIRECT_BUFFER, cmd_buf);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER,
+		offsetof(DrawCommands, mesh.inst_num), sizeof(zero), &zero);
+	GLStateCache::get().bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+size_t CirclesGLBuffer::get_point_num()
+{
+	if (!cmd_buf)
+		return pt_num;
+	GLuint inst_num = 0;
+	GLStateCache::get().bind_buffer(GL_DRAW_INDIRECT_BUFFER, cmd_buf);
+	glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER,
+		offsetof(DrawCommands, mesh.inst_num), sizeof(inst_num), &inst_num);
+	GLStateCache::get().bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	return inst_num;
+}
+
+int CirclesGLBuffer::read_points(std::vector<glm::vec2> &pts)
+{
+	pts.clear();
+	if (!vbo_inst)
+		return -1;
+	size_t num = get_point_num();
+	if (num == 0)
+		return 0;
+	pts.resize(num);
+	GLStateCache::get().bind_buffer(GL_ARRAY_BUFFER, vbo_inst);
+	if (inst_style == UniformStyle)
+	{
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0,
+			sizeof(glm::vec2) * num, &pts[0]);
+	}
+	else
+	{
+		std::vector<InstData> inst_data(num);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0,
+			sizeof(InstData) * num, &inst_data[0]);
+		for (size_t p_id = 0; p_id < num; ++p_id)
+		{
+			pts[p_id].x = inst_data[p_id].x;
+			pts[p_id].y = inst_data[p_id].y;
+		}
+	}
+	GLStateCache::get().bind_buffer(GL_ARRAY_BUFFER, 0);
+	return 0;
+}
+
+CirclesGLBuffer::DrawMode CirclesGLBuffer::get_draw_mode() const
+{
+	if (draw_mode != AutoMode)
+		return draw_mode;
+	if (pixel_scale <= 0.0f)
+		return QuadMode;
+
+	// sprites are cheapest for circles of a few pixels,
+	// fan saves the empty corners of large quads
+	const float radius = max_pt_radius * pixel_scale;
+	if (radius < 4.0f && 2.0f * (radius + 1.0f) <= max_point_size)
+		return PointMode;
+	if (radius > 256.0f)
+		return MeshMode;
+	return QuadMode;
+}
+
+CirclesGLBuffer::DrawMode CirclesGLBuffer::begin_draw(OpenGLShaderProgram& shader)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	if (uniform_program != shader.get_id())
+	{
+		draw_mode_loc = shader.uniform_loc("draw_mode");
+		pixel_scale_loc = shader.uniform_loc("pixel_scale");
+		uniform_program = shader.get_id();
+	}
+	const DrawMode mode = get_draw_mode();
+	shader.set_uniform(draw_mode_loc, GLint(mode));
+	shader.set_uniform(pixel_scale_loc, GLfloat(pixel_scale));
+
+	if (mode != MeshMode)
+	{
+		// antialiased edge
+		blend_enabled = gl_state.is_enabled(GL_BLEND);
+		gl_state.get_blend_func(blend_src, blend_dst);
+		gl_state.enable(GL_BLEND);
+		gl_state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		if (mode == PointMode)
+			gl_state.enable(GL_PROGRAM_POINT_SIZE);
+	}
+
+	gl_state.bind_vertex_array(mode == PointMode ? vao_points : vao);
+	if (inst_style == UniformStyle)
+	{
+		// current values of disabled attribute arrays
+		glVertexAttrib1f(2, pt_radius);
+		glVertexAttrib3f(3, pt_color.r, pt_color.g, pt_color.b);
+	}
+	return mode;
+}
+
+void CirclesGLBuffer::draw_instances(DrawMode mode, size_t first, size_t num)
+{
+	// base instance needs opengl 4.2, stream buffer only
+	// uses it with persistent mapping, ranges check support
+	const GLuint base = GLuint(inst_base + first);
+	switch (mode)
+	{
+	case MeshMode:
+		if (base)
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES,
+				3 * mesh_elem_num, GL_UNSIGNED_INT, nullptr,
+				GLsizei(num), base);
+		else
+			glDrawElementsInstanced(GL_TRIANGLES,
+				3 * mesh_elem_num, GL_UNSIGNED_INT, nullptr,
+				GLsizei(num));
+		break;
+	case QuadMode:
+		if (base)
+			glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP,
+				mesh_node_num, 4, GLsizei(num), base);
+		else
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP,
+				mesh_node_num, 4, GLsizei(num));
+		break;
+	default:
+		glDrawArrays(GL_POINTS, base, GLsizei(num));
+		break;
+	}
+}
+
+void CirclesGLBuffer::end_draw(DrawMode mode)
+{
+	if (is_stream_buffer())
+		inst_stream.fence_region();
+
+	if (mode == MeshMode)
+		return;
+	GLStateCache& gl_state = GLStateCache::get();
+	if (mode == PointMode)
+		gl_state.disable(GL_PROGRAM_POINT_SIZE);
+	gl_state.blend_func(blend_src, blend_dst);
+	if (!blend_enabled)
+		gl_state.disable(GL_BLEND);
+}
+
+void CirclesGLBuffer::draw(OpenGLShaderProgram& shader)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	const DrawMode mode = begin_draw(shader);
+	if (cmd_buf)
+	{
+		// instance count never leaves the gpu
+		gl_state.bind_buffer(GL_DRAW_INDIRECT_BUFFER, cmd_buf);
+		if (mode != MeshMode)
+		{
+			gl_state.bind_buffer(GL_COPY_READ_BUFFER, cmd_buf);
+			gl_state.bind_buffer(GL_COPY_WRITE_BUFFER, cmd_buf);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				offsetof(DrawCommands, mesh.inst_num),
+				mode == QuadMode ? offsetof(DrawCommands, quad.inst_num)
+								 : offsetof(DrawCommands, points.vert_num),
+				sizeof(GLuint));
+		}
+		switch (mode)
+		{
+		case MeshMode:
+			glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+				(GLvoid *)offsetof(DrawCommands, mesh));
+			break;
+		case QuadMode:
+			glDrawArraysIndirect(GL_TRIANGLE_STRIP,
+				(GLvoid *)offsetof(DrawCommands, quad));
+			break;
+		default:
+			glDrawArraysIndirect(GL_POINTS,
+				(GLvoid *)offsetof(DrawCommands, points));
+			break;
+		}
+	}
+	else
+	{
+		draw_instances(mode, 0, pt_num);
+	}
+	end_draw(mode);
 }
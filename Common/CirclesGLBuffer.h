@@ -2,35 +2,227 @@
 #define __Circle_GL_Buffer_h__
 
 #include <vector>
+#include <cmath>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "OpenGLShaderUtilities.h"
+#include "StreamGLBuffer.h"
+#include "CircleMesh.h"
 
 // use opengl instancing
+// Instance data layouts:
+//   UniformStyle: only position per instance (8 bytes), radius and
+//     colour are shared by all points as constant vertex attributes
+//   PerInstanceStyle: position, half float radius and normalized
+//     rgba8 colour (16 bytes)
+// Draw modes (draw_mode uniform of circles_shader):
+//   MeshMode: triangle fan of CircleMesh, no antialiasing
+//   QuadMode: instanced quad, disc with analytic antialiased edge
+//   PointMode: GL_POINTS sprites, same disc as QuadMode
+//   AutoMode: choose by on-screen radius, needs set_pixel_scale()
 class CirclesGLBuffer
 {
+public:
+	enum InstStyle
+	{
+		UniformStyle = 0,
+		PerInstanceStyle = 1
+	};
+	enum DrawMode
+	{
+		MeshMode = 0,
+		QuadMode = 1,
+		PointMode = 2,
+		AutoMode = 3
+	};
+
 protected:
 	struct InstData
 	{
 		GLfloat x, y;
-		GLfloat radius;
-		GLfloat r, g, b;
+		GLushort radius; // half float
+		GLushort padding;
+		GLuint color; // rgba8
+	};
+	// layouts required by glDrawElementsIndirect and glDrawArraysIndirect
+	struct DrawElementsCommand
+	{
+		GLuint elem_num;
+		GLuint inst_num;
+		GLuint first_elem;
+		GLint base_vertex;
+		GLuint base_inst;
 	};
-	
+	struct DrawArraysCommand
+	{
+		GLuint vert_num;
+		GLuint inst_num;
+		GLuint first_vert;
+		GLuint base_inst;
+	};
+	// compute shader only counts mesh.inst_num,
+	// the other commands copy it on gpu before drawing
+	struct DrawCommands
+	{
+		DrawElementsCommand mesh;
+		DrawArraysCommand quad;
+		DrawArraysCommand points;
+	};
+
 	size_t pt_num;
-	GLuint vao, vbo, vbo_inst, ebo;
+	// vao_points has no instancing for PointMode
+	GLuint vao, vao_points, vbo, vbo_inst, ebo;
+	// instance count of gpu generated points lives in cmd_buf
+	GLuint cmd_buf;
+	size_t max_pt_num;
+	InstStyle inst_style;
+	// radius and colour of UniformStyle, or default of PerInstanceStyle
+	float pt_radius;
+	glm::vec3 pt_color;
+	// largest radius for AutoMode
+	float max_pt_radius;
+	// instance data rewritten every frame by update()
+	StreamGLBuffer inst_stream;
+	size_t inst_base;
+
+	// circle mesh followed by the 4 quad corners in vbo
+	const float *mesh_nodes;
+	const unsigned int *mesh_elems;
+	unsigned int mesh_node_num;
+	unsigned int mesh_elem_num;
+
+	DrawMode draw_mode;
+	// screen pixels per unit length
+	float pixel_scale;
+	GLfloat max_point_size;
+	// glDraw*BaseInstance needs opengl 4.2
+	bool base_inst_support;
+	// blend state before draw, restored after it
+	GLboolean blend_enabled;
+	GLenum blend_src, blend_dst;
+
+	// uniform locations of uniform_program
+	GLuint uniform_program;
+	GLint draw_mode_loc, pixel_scale_loc;
+
+	inline size_t get_inst_size() const
+	{
+		return inst_style == UniformStyle ? sizeof(glm::vec2) : sizeof(InstData);
+	}
+	// radii and colors may be null for PerInstanceStyle
+	void fill_inst_data(void *data, const glm::vec2 *pts,
+		const float *radii, const glm::vec3 *colors, size_t num);
+
+	void init_circle_mesh();
+	void upload_circle_mesh();
+	void init_inst_attribs(GLuint inst_buf);
+
+	// set up and restore states around draw calls
+	DrawMode begin_draw(OpenGLShaderProgram &shader);
+	void draw_instances(DrawMode mode, size_t first, size_t num);
+	void end_draw(DrawMode mode);
 
 public:
 	CirclesGLBuffer();
 	~CirclesGLBuffer();
 	void clear();
 
-	int init(std::vector<glm::vec2> &pts,
-		float pt_area, glm::vec3 &pt_color);
+	// same radius and colour for all points, UniformStyle
+	int init(const glm::vec2 *pts, size_t pt_num,
+		float pt_area, const glm::vec3 &pt_color);
+	inline int init(std::vector<glm::vec2> &pts,
+		float pt_area, const glm::vec3 &pt_color)
+	{
+		return init(pts.size() ? &pts[0] : nullptr,
+					pts.size(), pt_area, pt_color);
+	}
+	// radius and colour of each point, PerInstanceStyle
+	int init(const glm::vec2 *pts, const float *radii,
+		const glm::vec3 *colors, size_t pt_num);
+	// allocate instance buffer to be filled by compute shader
+	// (see PoissonDiskSamplingGPU), draw with indirect command
+	int init_gpu(size_t max_pt_num, float pt_area, const glm::vec3 &pt_color);
 
+	// allocate ring of instance buffers for per frame update()
+	int init_stream(size_t max_pt_num, float pt_area, const glm::vec3 &pt_color,
+		InstStyle style = UniformStyle);
+	// write points to next region of the ring, at most max_pt_num
+	inline int update(const glm::vec2 *pts, size_t pt_num)
+	{
+		return update(pts, nullptr, nullptr, pt_num);
+	}
+	inline int update(const std::vector<glm::vec2> &pts)
+	{
+		return update(pts.size() ? &pts[0] : nullptr, pts.size());
+	}
+	// radii and colors are ignored by UniformStyle
+	int update(const glm::vec2 *pts, const float *radii,
+		const glm::vec3 *colors, size_t pt_num);
+
+	inline InstStyle get_inst_style() const { return inst_style; }
+	// shared radius and colour of UniformStyle
+	inline void set_point_style(float pt_area, const glm::vec3 &color)
+	{
+		pt_radius = sqrt(pt_area);
+		pt_color = color;
+		if (inst_style == UniformStyle)
+			max_pt_radius = pt_radius;
+	}
+
+	// number of segments of MeshMode circles, 60 by default
+	template <unsigned int SegNum>
+	void set_circle_mesh()
+	{
+		static constexpr CircleMesh<SegNum> mesh;
+		mesh_nodes = mesh.nodes;
+		mesh_elems = mesh.elems;
+		mesh_node_num = CircleMesh<SegNum>::node_num;
+		mesh_elem_num = CircleMesh<SegNum>::elem_num;
+		if (vbo)
+			upload_circle_mesh();
+	}
+	inline void set_draw_mode(DrawMode mode) { draw_mode = mode; }
+	// mode used by next draw(), resolves AutoMode
+	DrawMode get_draw_mode() const;
+	// for projection p, viewport of ht pixels: ht * 0.5 * p[1][1]
+	inline void set_pixel_scale(float scale) { pixel_scale = scale; }
+
+	inline bool support_base_instance() const { return base_inst_support; }
+	inline bool is_gpu_buffer() const { return cmd_buf != 0; }
+	inline bool is_stream_buffer() const { return inst_stream.get_id() != 0; }
+	inline GLuint get_inst_buffer() const { return vbo_inst; }
+	inline GLuint get_cmd_buffer() const { return cmd_buf; }
+	inline size_t get_max_point_num() const { return max_pt_num; }
+	inline float get_point_radius() const { return pt_radius; }
+	inline const glm::vec3 &get_point_color() const { return pt_color; }
+	// reset instance count of gpu buffer to 0
+	void reset_gpu_point_num();
+	// read back number of points, slow for gpu buffer
+	size_t get_point_num();
+	// read back point coordinates for analysis and tests
+	int read_points(std::vector<glm::vec2> &pts);
+
+	// shader should be in use
 	void draw(OpenGLShaderProgram &shader);
+	// draw instances [first, first + num) of each range,
+	// Range has members first and num (e.g. PointQuadtree::Range)
+	// draws all points without base instance support or for gpu buffer
+	template <typename Range>
+	void draw_ranges(OpenGLShaderProgram &shader,
+		const Range *ranges, size_t range_num)
+	{
+		if (!base_inst_support || cmd_buf)
+		{
+			draw(shader);
+			return;
+		}
+		const DrawMode mode = begin_draw(shader);
+		for (size_t r_id = 0; r_id < range_num; ++r_id)
+			draw_instances(mode, size_t(ranges[r_id].first), size_t(ranges[r_id].num));
+		end_draw(mode);
+	}
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,309 @@
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+#include "FrameProfiler.h"
+
+#define INVALID_TIMER_ID size_t(-1)
+
+FrameProfiler *FrameProfiler::cur_profiler = nullptr;
+
+FrameProfiler::FrameProfiler() :
+	enabled(true), trace_enabled(false),
+	window_size(300), max_trace_event_num(1 << 20),
+	start_time(std::chrono::steady_clock::now()),
+	frame_id(0), in_frame(false), frame_begin_time(0.0),
+	dropped_frame_num(0)
+{
+	for (size_t f_id = 0; f_id < QUERY_FRAME_NUM; ++f_id)
+	{
+		frame_queries[f_id].used_query_num = 0;
+		frame_queries[f_id].last_query = 0;
+		frame_queries[f_id].gpu_time_offset = 0.0;
+	}
+	frame_section_id = get_section_id("frame");
+}
+
+FrameProfiler::~FrameProfiler()
+{
+	if (cur_profiler == this)
+		cur_profiler = nullptr;
+}
+
+void FrameProfiler::clear()
+{
+	for (size_t f_id = 0; f_id < QUERY_FRAME_NUM; ++f_id)
+	{
+		FrameQueries &fq = frame_queries[f_id];
+		if (!fq.queries.empty())
+			glDeleteQueries(GLsizei(fq.queries.size()), &fq.queries[0]);
+		fq.queries.clear();
+		fq.used_query_num = 0;
+		fq.timers.clear();
+		fq.last_query = 0;
+	}
+	in_frame = false;
+}
+
+uint32_t FrameProfiler::get_section_id(const char *name)
+{
+	// only a few sections, linear search
+	for (size_t s_id = 0; s_id < sections.size(); ++s_id)
+	{
+		if (!strcmp(sections[s_id].name.c_str(), name))
+			return uint32_t(s_id);
+	}
+	sections.push_back(Section());
+	Section &s = sections.back();
+	s.name = name;
+	s.cpu.next_id = 0;
+	s.gpu.next_id = 0;
+	return uint32_t(sections.size() - 1);
+}
+
+void FrameProfiler::add_sample(RollingSamples &samples, double ms)
+{
+	if (samples.values.size() < window_size)
+	{
+		samples.values.push_back(float(ms));
+		return;
+	}
+	if (samples.next_id >= samples.values.size())
+		samples.next_id = 0;
+	samples.values[samples.next_id++] = float(ms);
+}
+
+void FrameProfiler::add_cpu_time(uint32_t section_id, double begin, double end)
+{
+	add_sample(sections[section_id].cpu, (end - begin) * 0.001);
+	if (trace_enabled && trace_events.size() < max_trace_event_num)
+	{
+		TraceEvent e;
+		e.section_id = section_id;
+		e.is_gpu = false;
+		e.begin = begin;
+		e.end = end;
+		trace_events.push_back(e);
+	}
+}
+
+void FrameProfiler::begin_frame()
+{
+	if (!enabled)
+		return;
+
+	// results of the frame QUERY_FRAME_NUM frames ago
+	FrameQueries &fq = frame_queries[frame_id % QUERY_FRAME_NUM];
+	collect_gpu_times(fq);
+	fq.used_query_num = 0;
+	fq.timers.clear();
+	fq.last_query = 0;
+
+	// current gpu time, doesn't wait for queued commands
+	GLint64 gpu_time = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpu_time);
+	frame_begin_time = get_cpu_time();
+	fq.gpu_time_offset = frame_begin_time - double(gpu_time) * 0.001;
+	in_frame = true;
+}
+
+void FrameProfiler::end_frame()
+{
+	if (!enabled || !in_frame)
+		return;
+	add_cpu_time(frame_section_id, frame_begin_time, get_cpu_time());
+	in_frame = false;
+	++frame_id;
+}
+
+void FrameProfiler::reset_stats()
+{
+	for (size_t s_id = 0; s_id < sections.size(); ++s_id)
+	{
+		sections[s_id].cpu.values.clear();
+		sections[s_id].cpu.next_id = 0;
+		sections[s_id].gpu.values.clear();
+		sections[s_id].gpu.next_id = 0;
+	}
+	dropped_frame_num = 0;
+}
+
+size_t FrameProfiler::begin_gpu_timer(uint32_t section_id)
+{
+	if (!in_frame)
+		return INVALID_TIMER_ID;
+
+	FrameQueries &fq = frame_queries[frame_id % QUERY_FRAME_NUM];
+	if (fq.used_query_num + 2 > fq.queries.size())
+	{
+		size_t old_num = fq.queries.size();
+		fq.queries.resize(old_num ? old_num * 2 : 16);
+		glGenQueries(GLsizei(fq.queries.size() - old_num), &fq.queries[old_num]);
+	}
+	GpuTimer timer;
+	timer.section_id = section_id;
+	timer.begin_query = fq.queries[fq.used_query_num++];
+	timer.end_query = fq.queries[fq.used_query_num++];
+	timer.is_ended = false;
+	glQueryCounter(timer.begin_query, GL_TIMESTAMP);
+	fq.last_query = timer.begin_query;
+	fq.timers.push_back(timer);
+	return fq.timers.size() - 1;
+}
+
+void FrameProfiler::end_gpu_timer(size_t timer_id)
+{
+	if (!in_frame || timer_id == INVALID_TIMER_ID)
+		return;
+	FrameQueries &fq = frame_queries[frame_id % QUERY_FRAME_NUM];
+	GpuTimer &timer = fq.timers[timer_id];
+	glQueryCounter(timer.end_query, GL_TIMESTAMP);
+	timer.is_ended = true;
+	fq.last_query = timer.end_query;
+}
+
+void FrameProfiler::collect_gpu_times(FrameQueries &fq)
+{
+	if (fq.timers.empty())
+		return;
+
+	// queries finish in issue order, the last issued one tells for all
+	GLuint available = 0;
+	glGetQueryObjectuiv(fq.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+	{
+		++dropped_frame_num;
+		return;
+	}
+	for (size_t t_id = 0; t_id < fq.timers.size(); ++t_id)
+	{
+		const GpuTimer &timer = fq.timers[t_id];
+		// end query of a timer that wasn't ended holds no result
+		if (!timer.is_ended)
+			continue;
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(timer.begin_query, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(timer.end_query, GL_QUERY_RESULT, &end);
+		add_sample(sections[timer.section_id].gpu, double(end - begin) * 1.0e-6);
+		if (trace_enabled && trace_events.size() < max_trace_event_num)
+		{
+			TraceEvent e;
+			e.section_id = timer.section_id;
+			e.is_gpu = true;
+			e.begin = double(begin) * 0.001 + fq.gpu_time_offset;
+			e.end = double(end) * 0.001 + fq.gpu_time_offset;
+			trace_events.push_back(e);
+		}
+	}
+}
+
+void FrameProfiler::compute_stats(const std::vector<float> &samples, Stats &stats)
+{
+	memset(&stats, 0, sizeof(stats));
+	stats.count = samples.size();
+	if (!stats.count)
+		return;
+
+	std::vector<float> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.0;
+	for (size_t v_id = 0; v_id < sorted.size(); ++v_id)
+		sum += sorted[v_id];
+	stats.mean = sum / double(sorted.size());
+	stats.min = sorted.front();
+	stats.max = sorted.back();
+	// nearest rank
+	const size_t n = sorted.size();
+	stats.p50 = sorted[(n * 50 + 99) / 100 - 1];
+	stats.p95 = sorted[(n * 95 + 99) / 100 - 1];
+	stats.p99 = sorted[(n * 99 + 99) / 100 - 1];
+}
+
+bool FrameProfiler::get_cpu_stats(const char *name, Stats &stats) const
+{
+	for (size_t s_id = 0; s_id < sections.size(); ++s_id)
+	{
+		if (!strcmp(sections[s_id].name.c_str(), name))
+		{
+			compute_stats(sections[s_id].cpu.values, stats);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FrameProfiler::get_gpu_stats(const char *name, Stats &stats) const
+{
+	for (size_t s_id = 0; s_id < sections.size(); ++s_id)
+	{
+		if (!strcmp(sections[s_id].name.c_str(), name))
+		{
+			compute_stats(sections[s_id].gpu.values, stats);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FrameProfiler::print_stats(std::ostream &out) const
+{
+	out << "section                    mean     p50     p95     p99     max (ms)\n";
+	std::ios::fmtflags flags = out.flags();
+	out << std::fixed << std::setprecision(3);
+	for (size_t s_id = 0; s_id < sections.size(); ++s_id)
+	{
+		const Section &s = sections[s_id];
+		for (int is_gpu = 0; is_gpu < 2; ++is_gpu)
+		{
+			Stats stats;
+			compute_stats(is_gpu ? s.gpu.values : s.cpu.values, stats);
+			if (!stats.count)
+				continue;
+			std::string label = s.name + (is_gpu ? " (gpu)" : " (cpu)");
+			out << std::left << std::setw(24) << label << std::right
+				<< std::setw(8) << stats.mean << std::setw(8) << stats.p50
+				<< std::setw(8) << stats.p95 << std::setw(8) << stats.p99
+				<< std::setw(8) << stats.max << "\n";
+		}
+	}
+	if (dropped_frame_num)
+		out << dropped_frame_num << " frames of gpu timings dropped\n";
+	out.flags(flags);
+}
+
+int FrameProfiler::write_chrome_trace(const char *filename) const
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "Can't open trace file " << filename << ".\n";
+		return -1;
+	}
+
+	// complete events, cpu on thread 0 and gpu on thread 1
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+		<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n"
+		<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+	char buf[64];
+	for (size_t e_id = 0; e_id < trace_events.size(); ++e_id)
+	{
+		const TraceEvent &e = trace_events[e_id];
+		file << ",\n{\"name\":\"";
+		const std::string &name = sections[e.section_id].name;
+		for (size_t c_id = 0; c_id < name.size(); ++c_id)
+		{
+			if (name[c_id] == '"' || name[c_id] == '\\')
+				file << '\\';
+			file << name[c_id];
+		}
+		snprintf(buf, sizeof(buf), "%.3f,\"dur\":%.3f", e.begin, e.end - e.begin);
+		file << "\",\"cat\":\"" << (e.is_gpu ? "gpu" : "cpu")
+			<< "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << (e.is_gpu ? 1 : 0)
+			<< ",\"ts\":" << buf << "}";
+	}
+	file << "\n]}\n";
+	return file.good() ? 0 : -1;
+}
@@ -0,0 +1,190 @@
+#ifndef __Frame_Profiler_h__
+#define __Frame_Profiler_h__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+
+#include <glad/glad.h>
+
+// CPU and GPU timing of named sections of each frame.
+// GPU time is measured with GL_TIMESTAMP queries, which unlike
+// GL_TIME_ELAPSED can nest. Queries of a frame are read back
+// QUERY_FRAME_NUM frames later, results not ready by then are
+// dropped instead of waiting.
+//   profiler.begin_frame();
+//   { FrameProfiler::Scope scope(&profiler, "paint"); paint(); }
+//   profiler.end_frame();
+// Timings are kept as rolling statistics and optionally as
+// a Chrome trace (chrome://tracing, ui.perfetto.dev).
+class FrameProfiler
+{
+public:
+	// milliseconds
+	struct Stats
+	{
+		size_t count;
+		double mean, min, p50, p95, p99, max;
+	};
+
+	// cpu time of enclosing block, profiler may be null
+	class CpuScope
+	{
+	protected:
+		FrameProfiler *profiler;
+		uint32_t section_id;
+		double begin_time;
+
+	public:
+		CpuScope(FrameProfiler *prof, const char *name) :
+			profiler(prof && prof->is_enabled() ? prof : nullptr)
+		{
+			if (profiler)
+			{
+				section_id = profiler->get_section_id(name);
+				begin_time = profiler->get_cpu_time();
+			}
+		}
+		~CpuScope()
+		{
+			if (profiler)
+				profiler->add_cpu_time(section_id, begin_time, profiler->get_cpu_time());
+		}
+	};
+
+	// cpu and gpu time of enclosing block, profiler may be null
+	class Scope : public CpuScope
+	{
+	protected:
+		size_t timer_id;
+
+	public:
+		Scope(FrameProfiler *prof, const char *name) :
+			CpuScope(prof, name)
+		{
+			if (profiler)
+				timer_id = profiler->begin_gpu_timer(section_id);
+		}
+		~Scope()
+		{
+			if (profiler)
+				profiler->end_gpu_timer(timer_id);
+		}
+	};
+
+protected:
+	enum { QUERY_FRAME_NUM = 3 };
+
+	struct RollingSamples
+	{
+		std::vector<float> values;
+		size_t next_id;
+	};
+	struct Section
+	{
+		std::string name;
+		RollingSamples cpu, gpu;
+	};
+	struct TraceEvent
+	{
+		uint32_t section_id;
+		bool is_gpu;
+		double begin, end; // microseconds
+	};
+	struct GpuTimer
+	{
+		uint32_t section_id;
+		GLuint begin_query, end_query;
+		bool is_ended;
+	};
+	// queries of one frame in flight
+	struct FrameQueries
+	{
+		std::vector<GLuint> queries;
+		size_t used_query_num;
+		std::vector<GpuTimer> timers;
+		// nested timers end out of order, results are
+		// ready once the last issued query is
+		GLuint last_query;
+		// gpu timestamp to cpu time in microseconds
+		double gpu_time_offset;
+	};
+
+	bool enabled;
+	bool trace_enabled;
+	size_t window_size;
+	size_t max_trace_event_num;
+
+	std::chrono::steady_clock::time_point start_time;
+	std::vector<Section> sections;
+	std::vector<TraceEvent> trace_events;
+
+	FrameQueries frame_queries[QUERY_FRAME_NUM];
+	uint64_t frame_id;
+	bool in_frame;
+	double frame_begin_time;
+	uint32_t frame_section_id;
+	size_t dropped_frame_num;
+
+	void add_sample(RollingSamples &samples, double ms);
+	void collect_gpu_times(FrameQueries &fq);
+
+	static FrameProfiler *cur_profiler;
+
+public:
+	FrameProfiler();
+	~FrameProfiler();
+	// release queries, needs the gl context
+	void clear();
+
+	inline void set_enabled(bool enable) { enabled = enable; }
+	inline bool is_enabled() const { return enabled; }
+	// keep every timing for write_chrome_trace()
+	inline void set_trace_enabled(bool enable) { trace_enabled = enable; }
+	// number of latest samples for statistics, default 300
+	inline void set_window_size(size_t size) { window_size = size ? size : 1; }
+
+	void begin_frame();
+	void end_frame();
+	// drop samples of statistics, e.g. after warm up
+	void reset_stats();
+
+	// microseconds since construction
+	inline double get_cpu_time() const
+	{
+		return std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - start_time).count();
+	}
+	uint32_t get_section_id(const char *name);
+	void add_cpu_time(uint32_t section_id, double begin, double end);
+	// return timer id, only valid between begin_frame() and end_frame()
+	size_t begin_gpu_timer(uint32_t section_id);
+	void end_gpu_timer(size_t timer_id);
+
+	inline size_t get_section_num() const { return sections.size(); }
+	inline const std::string &get_section_name(size_t s_id) const { return sections[s_id].name; }
+	// return false if section doesn't exist
+	bool get_cpu_stats(const char *name, Stats &stats) const;
+	bool get_gpu_stats(const char *name, Stats &stats) const;
+	inline size_t get_dropped_frame_num() const { return dropped_frame_num; }
+	inline uint64_t get_frame_num() const { return frame_id; }
+
+	// statistics of any samples in milliseconds
+	static void compute_stats(const std::vector<float> &samples, Stats &stats);
+
+	void print_stats(std::ostream &out) const;
+	// return 0 if success, -1 if fails
+	int write_chrome_trace(const char *filename) const;
+
+	// profiler of running GlfwApp for library code, may be null
+	inline static FrameProfiler *get_cur_profiler() { return cur_profiler; }
+	inline static void set_cur_profiler(FrameProfiler *prof) { cur_profiler = prof; }
+
+private: // no copy
+	FrameProfiler(const FrameProfiler &other) = delete;
+	FrameProfiler &operator=(const FrameProfiler &other) = delete;
+};
+
+#endif
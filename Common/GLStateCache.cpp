@@ -0,0 +1,287 @@
+#include <iomanip>
+
+#include "GLStateCache.h"
+
+const char* const GLStateCache::call_type_names[GLStateCache::call_type_num] = {
+	"program",
+	"vertex_array",
+	"buffer",
+	"texture",
+	"capability",
+	"blend_func",
+	"depth_func",
+	"cull_face",
+	"program_pipeline"
+};
+
+GLStateCache GLStateCache::default_cache;
+GLStateCache* GLStateCache::cur_cache = &GLStateCache::default_cache;
+
+void GLStateCache::set_cur_cache(GLStateCache* cache)
+{
+	cur_cache = cache ? cache : &default_cache;
+}
+
+void GLStateCache::Counters::clear()
+{
+	for (size_t c_id = 0; c_id < call_type_num; ++c_id)
+	{
+		issued[c_id] = 0;
+		elided[c_id] = 0;
+	}
+}
+
+void GLStateCache::Counters::add(const Counters& other)
+{
+	for (size_t c_id = 0; c_id < call_type_num; ++c_id)
+	{
+		issued[c_id] += other.issued[c_id];
+		elided[c_id] += other.elided[c_id];
+	}
+}
+
+size_t GLStateCache::Counters::get_issued() const
+{
+	size_t sum = 0;
+	for (size_t c_id = 0; c_id < call_type_num; ++c_id)
+		sum += issued[c_id];
+	return sum;
+}
+
+size_t GLStateCache::Counters::get_elided() const
+{
+	size_t sum = 0;
+	for (size_t c_id = 0; c_id < call_type_num; ++c_id)
+		sum += elided[c_id];
+	return sum;
+}
+
+GLStateCache::GLStateCache()
+{
+	invalidate();
+	reset_counters();
+}
+
+void GLStateCache::invalidate()
+{
+	program = unknown;
+	program_pipeline = unknown;
+	vertex_array = unknown;
+	for (size_t t_id = 0; t_id < buffer_target_num; ++t_id)
+		buffers[t_id] = unknown;
+	active_unit = unknown;
+	for (size_t u_id = 0; u_id < texture_unit_num; ++u_id)
+	{
+		for (size_t t_id = 0; t_id < texture_target_num; ++t_id)
+			textures[u_id][t_id] = unknown;
+	}
+	for (size_t c_id = 0; c_id < capability_num; ++c_id)
+		capabilities[c_id] = -1;
+	blend_src = unknown;
+	blend_dst = unknown;
+	depth_func_mode = unknown;
+	cull_face_mode = unknown;
+}
+
+int GLStateCache::get_buffer_target(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:
+		return ArrayBuffer;
+	case GL_ELEMENT_ARRAY_BUFFER:
+		return ElementArrayBuffer;
+	case GL_UNIFORM_BUFFER:
+		return UniformBuffer;
+	case GL_SHADER_STORAGE_BUFFER:
+		return ShaderStorageBuffer;
+	case GL_DRAW_INDIRECT_BUFFER:
+		return DrawIndirectBuffer;
+	case GL_DISPATCH_INDIRECT_BUFFER:
+		return DispatchIndirectBuffer;
+	case GL_COPY_READ_BUFFER:
+		return CopyReadBuffer;
+	case GL_COPY_WRITE_BUFFER:
+		return CopyWriteBuffer;
+	case GL_PIXEL_PACK_BUFFER:
+		return PixelPackBuffer;
+	case GL_PIXEL_UNPACK_BUFFER:
+		return PixelUnpackBuffer;
+	case GL_ATOMIC_COUNTER_BUFFER:
+		return AtomicCounterBuffer;
+	}
+	return -1;
+}
+
+int GLStateCache::get_texture_target(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_1D:
+		return Texture1D;
+	case GL_TEXTURE_2D:
+		return Texture2D;
+	case GL_TEXTURE_3D:
+		return Texture3D;
+	case GL_TEXTURE_2D_ARRAY:
+		return Texture2DArray;
+	case GL_TEXTURE_CUBE_MAP:
+		return TextureCubeMap;
+	case GL_TEXTURE_BUFFER:
+		return TextureBuffer;
+	}
+	return -1;
+}
+
+int GLStateCache::get_capability(GLenum cap)
+{
+	switch (cap)
+	{
+	case GL_BLEND:
+		return BlendCap;
+	case GL_DEPTH_TEST:
+		return DepthTestCap;
+	case GL_CULL_FACE:
+		return CullFaceCap;
+	case GL_PROGRAM_POINT_SIZE:
+		return ProgramPointSizeCap;
+	}
+	return -1;
+}
+
+void GLStateCache::set_capability(GLenum cap, bool enabled)
+{
+	int c_id = get_capability(cap);
+	if (c_id >= 0)
+	{
+		if (capabilities[c_id] == int(enabled))
+		{
+			++frame_counters.elided[CapabilityCall];
+			return;
+		}
+		capabilities[c_id] = int(enabled);
+	}
+	count_issued(CapabilityCall);
+	if (enabled)
+		glEnable(cap);
+	else
+		glDisable(cap);
+}
+
+bool GLStateCache::is_enabled(GLenum cap)
+{
+	int c_id = get_capability(cap);
+	if (c_id >= 0 && capabilities[c_id] >= 0)
+		return capabilities[c_id] != 0;
+	bool enabled = glIsEnabled(cap) == GL_TRUE;
+	if (c_id >= 0)
+		capabilities[c_id] = int(enabled);
+	return enabled;
+}
+
+void GLStateCache::get_blend_func(GLenum& src, GLenum& dst)
+{
+	if (blend_src == unknown || blend_dst == unknown)
+	{
+		GLint value = 0;
+		glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+		blend_src = GLenum(value);
+		glGetIntegerv(GL_BLEND_DST_RGB, &value);
+		blend_dst = GLenum(value);
+	}
+	src = blend_src;
+	dst = blend_dst;
+}
+
+void GLStateCache::delete_program(GLuint id)
+{
+	// program in use is deleted when it is replaced
+	if (program == id)
+		program = unknown;
+	glDeleteProgram(id);
+}
+
+void GLStateCache::delete_program_pipelines(GLsizei num, const GLuint* ids)
+{
+	for (GLsizei i = 0; i < num; ++i)
+	{
+		if (ids[i] && program_pipeline == ids[i])
+			program_pipeline = 0;
+	}
+	glDeleteProgramPipelines(num, ids);
+}
+
+void GLStateCache::delete_vertex_arrays(GLsizei num, const GLuint* ids)
+{
+	for (GLsizei i = 0; i < num; ++i)
+	{
+		if (ids[i] && vertex_array == ids[i])
+		{
+			vertex_array = 0;
+			buffers[ElementArrayBuffer] = 0;
+		}
+	}
+	glDeleteVertexArrays(num, ids);
+}
+
+void GLStateCache::delete_buffers(GLsizei num, const GLuint* ids)
+{
+	for (GLsizei i = 0; i < num; ++i)
+	{
+		for (size_t t_id = 0; t_id < buffer_target_num; ++t_id)
+		{
+			if (ids[i] && buffers[t_id] == ids[i])
+				buffers[t_id] = 0;
+		}
+	}
+	glDeleteBuffers(num, ids);
+}
+
+void GLStateCache::delete_textures(GLsizei num, const GLuint* ids)
+{
+	for (GLsizei i = 0; i < num; ++i)
+	{
+		for (size_t u_id = 0; u_id < texture_unit_num; ++u_id)
+		{
+			for (size_t t_id = 0; t_id < texture_target_num; ++t_id)
+			{
+				if (ids[i] && textures[u_id][t_id] == ids[i])
+					textures[u_id][t_id] = 0;
+			}
+		}
+	}
+	glDeleteTextures(num, ids);
+}
+
+void GLStateCache::new_frame()
+{
+	last_frame_counters = frame_counters;
+	total_counters.add(frame_counters);
+	frame_counters.clear();
+}
+
+void GLStateCache::reset_counters()
+{
+	frame_counters.clear();
+	last_frame_counters.clear();
+	total_counters.clear();
+}
+
+void GLStateCache::print_counters(std::ostream& out, const Counters& counters, size_t frame_num)
+{
+	if (frame_num == 0)
+		frame_num = 1;
+	std::ios::fmtflags flags = out.flags();
+	out << std::fixed << std::setprecision(1)
+		<< "  gl state calls per frame: issued " << double(counters.get_issued()) / frame_num
+		<< ", elided " << double(counters.get_elided()) / frame_num << "\n";
+	for (size_t c_id = 0; c_id < call_type_num; ++c_id)
+	{
+		if (counters.issued[c_id] == 0 && counters.elided[c_id] == 0)
+			continue;
+		out << "    " << std::left << std::setw(14) << call_type_names[c_id] << std::right
+			<< " issued " << std::setw(8) << double(counters.issued[c_id]) / frame_num
+			<< ", elided " << std::setw(8) << double(counters.elided[c_id]) / frame_num << "\n";
+	}
+	out.flags(flags);
+}
@@ -0,0 +1,249 @@
+#ifndef __GL_State_Cache_h__
+#define __GL_State_Cache_h__
+
+#include <cstddef>
+#include <ostream>
+
+#include <glad/glad.h>
+
+// Shadow of program, pipeline, vertex array, buffer and texture
+// bindings, and of blend, depth and cull states. Setting the current
+// value again skips the gl call:
+//   GLStateCache::get().bind_vertex_array(vao);
+// Objects must be deleted with delete_* so that a new object reusing
+// the name is bound again. After state is changed by raw gl calls
+// (e.g. by other libraries) call invalidate().
+// Calls of each frame are counted, see new_frame().
+class GLStateCache
+{
+public:
+	enum CallType
+	{
+		ProgramCall = 0,
+		VertexArrayCall = 1,
+		BufferCall = 2,
+		TextureCall = 3,
+		CapabilityCall = 4,
+		BlendFuncCall = 5,
+		DepthFuncCall = 6,
+		CullFaceCall = 7,
+		ProgramPipelineCall = 8,
+		call_type_num = 9
+	};
+	static const char* const call_type_names[call_type_num];
+
+	struct Counters
+	{
+		size_t issued[call_type_num];
+		size_t elided[call_type_num];
+
+		void clear();
+		void add(const Counters& other);
+		size_t get_issued() const;
+		size_t get_elided() const;
+	};
+
+	static const size_t texture_unit_num = 32;
+
+protected:
+	// binding is unknown after invalidate(), next call is issued
+	static const GLuint unknown = ~GLuint(0);
+
+	enum BufferTarget
+	{
+		ArrayBuffer = 0,
+		ElementArrayBuffer,
+		UniformBuffer,
+		ShaderStorageBuffer,
+		DrawIndirectBuffer,
+		DispatchIndirectBuffer,
+		CopyReadBuffer,
+		CopyWriteBuffer,
+		PixelPackBuffer,
+		PixelUnpackBuffer,
+		AtomicCounterBuffer,
+		buffer_target_num
+	};
+	enum TextureTarget
+	{
+		Texture1D = 0,
+		Texture2D,
+		Texture3D,
+		Texture2DArray,
+		TextureCubeMap,
+		TextureBuffer,
+		texture_target_num
+	};
+	enum Capability
+	{
+		BlendCap = 0,
+		DepthTestCap,
+		CullFaceCap,
+		ProgramPointSizeCap,
+		capability_num
+	};
+
+	GLuint program;
+	// used only while program is 0
+	GLuint program_pipeline;
+	GLuint vertex_array;
+	// element array binding is state of the vertex array
+	GLuint buffers[buffer_target_num];
+	// index of GL_TEXTURE0 + i
+	GLuint active_unit;
+	GLuint textures[texture_unit_num][texture_target_num];
+	// 0, 1 or -1 if unknown
+	int capabilities[capability_num];
+	GLenum blend_src, blend_dst;
+	GLenum depth_func_mode;
+	GLenum cull_face_mode;
+
+	Counters frame_counters, last_frame_counters, total_counters;
+
+	// -1 if not tracked, then call is always issued
+	static int get_buffer_target(GLenum target);
+	static int get_texture_target(GLenum target);
+	static int get_capability(GLenum cap);
+
+	// true if call is needed
+	inline bool update(CallType type, GLuint& cur, GLuint value)
+	{
+		if (cur == value)
+		{
+			++frame_counters.elided[type];
+			return false;
+		}
+		cur = value;
+		++frame_counters.issued[type];
+		return true;
+	}
+	inline void count_issued(CallType type) { ++frame_counters.issued[type]; }
+
+	void set_capability(GLenum cap, bool enabled);
+
+public:
+	GLStateCache();
+
+	// forget all state, e.g. after context is created
+	void invalidate();
+
+	inline void use_program(GLuint id)
+	{
+		if (update(ProgramCall, program, id))
+			glUseProgram(id);
+	}
+	// program in use overrides the pipeline, so it is unused
+	inline void bind_program_pipeline(GLuint id)
+	{
+		use_program(0);
+		if (update(ProgramPipelineCall, program_pipeline, id))
+			glBindProgramPipeline(id);
+	}
+	inline void bind_vertex_array(GLuint id)
+	{
+		if (update(VertexArrayCall, vertex_array, id))
+		{
+			glBindVertexArray(id);
+			buffers[ElementArrayBuffer] = unknown;
+		}
+	}
+	inline void bind_buffer(GLenum target, GLuint id)
+	{
+		int t_id = get_buffer_target(target);
+		if (t_id < 0)
+		{
+			count_issued(BufferCall);
+			glBindBuffer(target, id);
+		}
+		else if (update(BufferCall, buffers[t_id], id))
+			glBindBuffer(target, id);
+	}
+	// always issued, also sets generic binding of target
+	inline void bind_buffer_base(GLenum target, GLuint index, GLuint id)
+	{
+		count_issued(BufferCall);
+		glBindBufferBase(target, index, id);
+		int t_id = get_buffer_target(target);
+		if (t_id >= 0)
+			buffers[t_id] = id;
+	}
+	inline void active_texture(GLenum unit)
+	{
+		GLuint u_id = GLuint(unit - GL_TEXTURE0);
+		if (u_id >= texture_unit_num)
+		{
+			count_issued(TextureCall);
+			glActiveTexture(unit);
+			active_unit = unknown;
+		}
+		else if (update(TextureCall, active_unit, u_id))
+			glActiveTexture(unit);
+	}
+	inline void bind_texture(GLenum target, GLuint id)
+	{
+		int t_id = get_texture_target(target);
+		if (t_id < 0 || active_unit >= texture_unit_num)
+		{
+			count_issued(TextureCall);
+			glBindTexture(target, id);
+		}
+		else if (update(TextureCall, textures[active_unit][t_id], id))
+			glBindTexture(target, id);
+	}
+	inline void enable(GLenum cap) { set_capability(cap, true); }
+	inline void disable(GLenum cap) { set_capability(cap, false); }
+	// queries gl only if state is unknown
+	bool is_enabled(GLenum cap);
+	void get_blend_func(GLenum& src, GLenum& dst);
+	inline void blend_func(GLenum src, GLenum dst)
+	{
+		if (blend_src == src && blend_dst == dst)
+		{
+			++frame_counters.elided[BlendFuncCall];
+			return;
+		}
+		blend_src = src;
+		blend_dst = dst;
+		count_issued(BlendFuncCall);
+		glBlendFunc(src, dst);
+	}
+	inline void depth_func(GLenum func)
+	{
+		if (update(DepthFuncCall, depth_func_mode, func))
+			glDepthFunc(func);
+	}
+	inline void cull_face(GLenum mode)
+	{
+		if (update(CullFaceCall, cull_face_mode, mode))
+			glCullFace(mode);
+	}
+
+	// deleted names are unbound as gl does
+	void delete_program(GLuint id);
+	void delete_program_pipelines(GLsizei num, const GLuint* ids);
+	void delete_vertex_arrays(GLsizei num, const GLuint* ids);
+	void delete_buffers(GLsizei num, const GLuint* ids);
+	void delete_textures(GLsizei num, const GLuint* ids);
+
+	// end counting of current frame
+	void new_frame();
+	inline const Counters& get_frame_counters() const { return last_frame_counters; }
+	// frames since reset_counters()
+	inline const Counters& get_total_counters() const { return total_counters; }
+	void reset_counters();
+	static void print_counters(std::ostream& out, const Counters& counters, size_t frame_num = 1);
+
+	// cache of current context, set by GlfwApp
+	static GLStateCache& get() { return *cur_cache; }
+	static void set_cur_cache(GLStateCache* cache);
+
+private:
+	static GLStateCache default_cache;
+	static GLStateCache* cur_cache;
+
+	// no copy
+	GLStateCache(const GLStateCache& other) = delete;
+	GLStateCache& operator=(const GLStateCache& other) = delete;
+};
+
+#endif
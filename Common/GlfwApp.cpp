@@ -1,39 +1,138 @@
 #include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef GLFWAPP_USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "PngWriter.h"
+#include "OpenGLShaderUtilities.h"
 
 #include "GlfwApp.h"
 
 GlfwApp* GlfwApp::cur_app = nullptr;
 
+// defaults of new apps
+static bool default_headless = false;
+static bool default_render_thread = false;
+static size_t default_bench_warmup_num = 0;
+static size_t default_bench_frame_num = 0;
+static std::string default_bench_json_filename;
+
+void GlfwApp::set_default_headless(bool enable)
+{
+    default_headless = enable;
+}
+
+void GlfwApp::set_default_render_thread(bool enable)
+{
+    default_render_thread = enable;
+}
+
+void GlfwApp::set_default_benchmark(size_t warmup_num, size_t frame_num,
+    const char* json_filename)
+{
+    default_bench_warmup_num = warmup_num;
+    default_bench_frame_num = frame_num;
+    default_bench_json_filename = json_filename ? json_filename : "";
+}
+
+// glMaxShaderCompilerThreadsKHR, not loaded by glad
+typedef void (APIENTRYP PFNMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+
+// let driver compile shaders asynchronously on its own threads,
+// some drivers only do this after the thread count is set
+static void enable_parallel_shader_compile(void* max_threads_func)
+{
+    OpenGLShaderSupportCheck support_check;
+    if (!max_threads_func || !support_check.support_parallel_compile())
+        return;
+    // 0xFFFFFFFF for implementation dependent maximum
+    ((PFNMAXSHADERCOMPILERTHREADSPROC)max_threads_func)(0xFFFFFFFF);
+}
+
 static void glfw_error_callback(int id, const char* description)
 {
     GlfwApp::get_cur_app()->error(id, description);
 }
 
 static void glfw_resize_callback(GLFWwindow* win, int wd, int ht)
+{
+    int win_wd = 0, win_ht = 0;
+    glfwGetWindowSize(win, &win_wd, &win_ht);
+    GlfwApp::InputEvent ev = { GlfwApp::InputEvent::Resize, win_wd, win_ht, double(wd), double(ht) };
+    GlfwApp::get_cur_app()->post_input(ev);
+}
+
+static void glfw_refresh_callback(GLFWwindow* win)
 {
     (void)win;
-    GlfwApp::get_cur_app()->resize(wd, ht);
+    GlfwApp::InputEvent ev = { GlfwApp::InputEvent::Refresh, 0, 0, 0.0, 0.0 };
+    GlfwApp::get_cur_app()->post_input(ev);
 }
 
 static void glfw_mouse_move_callback(GLFWwindow* win, double xpos, double ypos)
 {
     (void)win;
-    GlfwApp::get_cur_app()->mouse_move(xpos, ypos);
+    GlfwApp::InputEvent ev = { GlfwApp::InputEvent::MouseMove, 0, 0, xpos, ypos };
+    GlfwApp::get_cur_app()->post_input(ev);
 }
 
 void glfw_mouse_scroll_callback(GLFWwindow* win, double xoffset, double yoffset)
 {
     (void)win;
-    GlfwApp::get_cur_app()->mouse_scroll(yoffset);
+    GlfwApp::InputEvent ev = { GlfwApp::InputEvent::MouseScroll, 0, 0, xoffset, yoffset };
+    GlfwApp::get_cur_app()->post_input(ev);
+}
+
+static void glfw_mouse_button_callback(GLFWwindow* win, int button, int action, int mods)
+{
+    (void)win;
+    (void)mods;
+    GlfwApp::InputEvent ev = { GlfwApp::InputEvent::MouseButton, button, action, 0.0, 0.0 };
+    GlfwApp::get_cur_app()->post_input(ev);
+}
+
+// keys are polled in process_keyboard_input() with key_is_pressed()
+static void glfw_key_callback(GLFWwindow* win, int key, int scancode, int action, int mods)
+{
+    (void)win;
+    (void)scancode;
+    (void)mods;
+    GlfwApp::InputEvent ev = { GlfwApp::InputEvent::Key, key, action, 0.0, 0.0 };
+    GlfwApp::get_cur_app()->post_input(ev);
 }
 
 
 GlfwApp::GlfwApp() :
     win_name("OpenGL application with glfw"),
     width(0), height(0),
-    window(nullptr)
+    win_width(0), win_height(0),
+    window(nullptr),
+    gl_major_version(3), gl_minor_version(3),
+    headless(default_headless),
+    fbo(0), fbo_color(0), fbo_depth(0),
+    egl_display(nullptr), egl_context(nullptr),
+    start_time(std::chrono::steady_clock::now()),
+    continuous_redraw(false), need_redraw(true),
+    idle_timeout(1.0),
+    use_render_thread(default_render_thread),
+    render_running(false), render_quit(false),
+    input_queue(4096),
+    main_thread_only(false),
+    bench_warmup_num(default_bench_warmup_num),
+    bench_frame_num(default_bench_frame_num),
+    bench_json_filename(default_bench_json_filename)
 {
-
+    std::fill(key_states, key_states + GLFW_KEY_LAST + 1, false);
+    std::fill(mouse_states, mouse_states + GLFW_MOUSE_BUTTON_LAST + 1, false);
+    std::fill(frame_clear_color, frame_clear_color + 4, (unsigned char)0);
 }
 
 GlfwApp::~GlfwApp()
@@ -43,27 +142,58 @@ GlfwApp::~GlfwApp()
 
 int GlfwApp::init_app()
 {
+    set_cur_app();
+    FrameProfiler::set_cur_profiler(&profiler);
+    // new context starts with default state
+    gl_state.invalidate();
+    gl_state.reset_counters();
+    GLStateCache::set_cur_cache(&gl_state);
+    start_time = std::chrono::steady_clock::now();
+
+#ifdef GLFWAPP_USE_EGL
+    if (headless && !init_egl())
+    {
+        if (init_fbo())
+            return -1;
+        return init();
+    }
+#endif
+
     if (!glfwInit())
     {
         std::cout << "Glfw can't initialize.\n";
         return -1;
     }
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gl_major_version);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, gl_minor_version);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
     
     window = glfwCreateWindow(
                 width, height,
                 win_name.c_str(), 
                 nullptr, nullptr
                 );
+    if (!window && (gl_major_version > 3 || gl_minor_version > 3))
+    {
+        std::cout << "Glfw can't create OpenGL " << gl_major_version
+                  << "." << gl_minor_version << " context, fall back to 3.3.\n";
+        gl_major_version = 3;
+        gl_minor_version = 3;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(
+                    width, height,
+                    win_name.c_str(),
+                    nullptr, nullptr
+                    );
+    }
     if (!window)
     {
         std::cout << "Glfw can't create window.\n";
         return -1;
     }
 
-    set_cur_app();
     glfwMakeContextCurrent(window);
 
     // error callback
@@ -74,21 +204,161 @@ int GlfwApp::init_app()
     glfwSetCursorPosCallback(window, glfw_mouse_move_callback);
     // mouse scroll callback
     glfwSetScrollCallback(window, glfw_mouse_scroll_callback);
+    // mouse button callback
+    glfwSetMouseButtonCallback(window, glfw_mouse_button_callback);
+    // key callback
+    glfwSetKeyCallback(window, glfw_key_callback);
+    // window damaged callback
+    glfwSetWindowRefreshCallback(window, glfw_refresh_callback);
 
     if (!gladLoadGL())
     {
         std::cout << "Glad can't load GL functions.\n";
         return -1;
     }
+    void* max_threads_func = (void*)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    if (!max_threads_func)
+        max_threads_func = (void*)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+    enable_parallel_shader_compile(max_threads_func);
+
+    if (headless && init_fbo())
+        return -1;
     
     // init data
     return init();
 }
 
+int GlfwApp::init_egl()
+{
+#ifdef GLFWAPP_USE_EGL
+    // surfaceless platform needs no display server
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display)
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cout << "EGL can't initialize, use hidden glfw window.\n";
+        return -1;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "EGL doesn't support OpenGL, use hidden glfw window.\n";
+        eglTerminate(display);
+        return -1;
+    }
+
+    EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, gl_major_version,
+        EGL_CONTEXT_MINOR_VERSION, gl_minor_version,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    // no config and no surface, rendering goes to fbo
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attribs);
+    if (context == EGL_NO_CONTEXT && (gl_major_version > 3 || gl_minor_version > 3))
+    {
+        std::cout << "EGL can't create OpenGL " << gl_major_version
+                  << "." << gl_minor_version << " context, fall back to 3.3.\n";
+        gl_major_version = 3;
+        gl_minor_version = 3;
+        context_attribs[1] = 3;
+        context_attribs[3] = 3;
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attribs);
+    }
+    if (context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cout << "EGL can't create surfaceless context, use hidden glfw window.\n";
+        if (context != EGL_NO_CONTEXT)
+            eglDestroyContext(display, context);
+        eglTerminate(display);
+        return -1;
+    }
+    egl_display = display;
+    egl_context = context;
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        std::cout << "Glad can't load GL functions.\n";
+        return -1;
+    }
+    void* max_threads_func = (void*)eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    if (!max_threads_func)
+        max_threads_func = (void*)eglGetProcAddress("glMaxShaderCompilerThreadsARB");
+    enable_parallel_shader_compile(max_threads_func);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+int GlfwApp::init_fbo()
+{
+    glGenRenderbuffers(1, &fbo_color);
+    glBindRenderbuffer(GL_RENDERBUFFER, fbo_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &fbo_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, fbo_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // stays bound, apps draw into it as default framebuffer
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, fbo_color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, fbo_depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Headless framebuffer is incomplete.\n";
+        return -1;
+    }
+    glViewport(0, 0, width, height);
+    return 0;
+}
+
 void GlfwApp::destroy_app()
 {
     destroy();
+    // shared shaders belong to this context, programs which
+    // outlive it must not hand them to the next one
+    OpenGLShaderCache::clear();
 
+    if (!trace_filename.empty())
+    {
+        profiler.print_stats(std::cout);
+        profiler.write_chrome_trace(trace_filename.c_str());
+    }
+    profiler.clear();
+    if (FrameProfiler::get_cur_profiler() == &profiler)
+        FrameProfiler::set_cur_profiler(nullptr);
+    if (&GLStateCache::get() == &gl_state)
+        GLStateCache::set_cur_cache(nullptr);
+
+    if (fbo)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &fbo_color);
+        glDeleteRenderbuffers(1, &fbo_depth);
+        fbo = 0;
+        fbo_color = 0;
+        fbo_depth = 0;
+    }
+#ifdef GLFWAPP_USE_EGL
+    if (egl_display)
+    {
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(egl_display, egl_context);
+        eglTerminate(egl_display);
+        egl_display = nullptr;
+        egl_context = nullptr;
+    }
+#endif
     if (window)
     {
         glfwDestroyWindow(window);
@@ -99,30 +369,444 @@ void GlfwApp::destroy_app()
 
 int GlfwApp::run(int wd, int ht)
 {
+    if (is_benchmark())
+    {
+        width = wd;
+        height = ht;
+        return run_benchmark();
+    }
+    if (headless)
+        return run_frames(1, nullptr, wd, ht);
+
     // init
+    event_thread_id = std::this_thread::get_id();
     width = wd;
     height = ht;
+    win_width = wd;
+    win_height = ht;
     init_app();
 
+    if (use_render_thread)
+    {
+        // gl context moves to render thread until it quits
+        glfwGetFramebufferSize(window, &width, &height);
+        glfwGetWindowSize(window, &win_width, &win_height);
+        glfwMakeContextCurrent(nullptr);
+        render_quit = false;
+        render_running = true;
+        render_thread = std::thread(&GlfwApp::render_loop, this);
+
+        // callbacks queue events to render thread
+        while (!glfwWindowShouldClose(window))
+        {
+            if (input_backlog.empty())
+            {
+                glfwWaitEvents();
+                continue;
+            }
+            // retry events the full queue didn't take
+            glfwWaitEventsTimeout(0.001);
+            flush_input_backlog();
+        }
+        input_backlog.clear();
+
+        render_quit = true;
+        invalidate();
+        render_thread.join();
+        render_running = false;
+        glfwMakeContextCurrent(window);
+
+        // exit
+        destroy_app();
+        return 0;
+    }
+
     // main loop
+    need_redraw = true;
     while (!glfwWindowShouldClose(window))
+    {
+        if (!continuous_redraw && !need_redraw)
+        {
+            // callbacks of new events set need_redraw
+            if (idle_timeout > 0.0)
+                glfwWaitEventsTimeout(idle_timeout);
+            else
+                glfwWaitEvents();
+            if (!need_redraw)
+                continue;
+        }
+        // paint() may invalidate again to request next frame
+        need_redraw = false;
+
+        profiler.begin_frame();
+        paint_frame();
+        swap_frame();
+        profiler.end_frame();
+    }
+
+    // exit
+    destroy_app();
+
+    return 0;
+}
+
+void GlfwApp::render_loop()
+{
+    glfwMakeContextCurrent(window);
+
+    need_redraw = true;
+    while (!render_quit)
+    {
+        if (!continuous_redraw && !need_redraw)
+        {
+            std::unique_lock<std::mutex> lock(redraw_mutex);
+            auto is_woken = [this]() { return need_redraw || render_quit; };
+            if (idle_timeout > 0.0)
+                redraw_cond.wait_for(lock, std::chrono::duration<double>(idle_timeout), is_woken);
+            else
+                redraw_cond.wait(lock, is_woken);
+            if (!need_redraw)
+                continue;
+        }
+        need_redraw = false;
+
+        profiler.begin_frame();
+        paint_frame();
+        swap_frame();
+        profiler.end_frame();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+int GlfwApp::run_frames(size_t frame_num, const char* png_filename, int wd, int ht)
+{
+    // init
+    width = wd;
+    height = ht;
+    if (init_app())
+    {
+        destroy_app();
+        return -1;
+    }
+
+    int res = 0;
+    for (size_t f_id = 0; f_id < frame_num; ++f_id)
+    {
+        if (!headless && glfwWindowShouldClose(window))
+            break;
+
+        profiler.begin_frame();
+        paint_frame();
+        // back buffer is undefined after swap
+        if (png_filename && f_id + 1 == frame_num)
+            res = save_frame(png_filename);
+        swap_frame();
+        profiler.end_frame();
+    }
+
+    // exit
+    destroy_app();
+
+    return res;
+}
+
+int GlfwApp::run_benchmark()
+{
+    if (init_app())
+    {
+        destroy_app();
+        return -1;
+    }
+    // frames are not limited by display refresh
+    if (!headless)
+        glfwSwapInterval(0);
+
+    for (size_t f_id = 0; f_id < bench_warmup_num; ++f_id)
+    {
+        if (!headless && glfwWindowShouldClose(window))
+            break;
+        profiler.begin_frame();
+        paint_frame();
+        swap_frame();
+        profiler.end_frame();
+    }
+    profiler.set_window_size(bench_frame_num);
+    profiler.reset_stats();
+    gl_state.new_frame();
+    gl_state.reset_counters();
+
+    // each frame starts and ends with empty gpu queue
+    std::vector<float> frame_times;
+    frame_times.reserve(bench_frame_num);
+    glFinish();
+    for (size_t f_id = 0; f_id < bench_frame_num; ++f_id)
+    {
+        if (!headless && glfwWindowShouldClose(window))
+            break;
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        profiler.begin_frame();
+        paint_frame();
+        swap_frame();
+        glFinish();
+        profiler.end_frame();
+        std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+        frame_times.push_back(float(std::chrono::duration<double, std::milli>(end_time - start_time).count()));
+    }
+
+    FrameProfiler::Stats stats;
+    FrameProfiler::compute_stats(frame_times, stats);
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(3)
+              << "Benchmark " << win_name << ": " << stats.count << " frames\n"
+              << "  frame time (ms) min " << stats.min << ", median " << stats.p50
+              << ", p95 " << stats.p95 << ", p99 " << stats.p99
+              << ", mean " << stats.mean << "\n";
+    std::cout.flags(flags);
+    profiler.print_stats(std::cout);
+    // calls per frame averaged over measured frames,
+    // new_frame() adds the last one to the totals
+    gl_state.new_frame();
+    GLStateCache::print_counters(std::cout, gl_state.get_total_counters(), stats.count);
+
+    int res = 0;
+    if (!bench_json_filename.empty())
+        res = write_benchmark_json(stats);
+
+    destroy_app();
+    return res;
+}
+
+int GlfwApp::write_benchmark_json(const FrameProfiler::Stats& frame_stats)
+{
+    std::ofstream file(bench_json_filename.c_str());
+    if (!file)
+    {
+        std::cout << "Can't open benchmark file " << bench_json_filename << ".\n";
+        return -1;
+    }
+
+    file << std::fixed << std::setprecision(4)
+         << "{\n  \"name\": \"" << win_name << "\",\n"
+         << "  \"width\": " << width << ",\n"
+         << "  \"height\": " << height << ",\n"
+         << "  \"warmup_frames\": " << bench_warmup_num << ",\n"
+         << "  \"frames\": " << frame_stats.count << ",\n"
+         << "  \"frame_ms\": {\"min\": " << frame_stats.min
+         << ", \"median\": " << frame_stats.p50
+         << ", \"p95\": " << frame_stats.p95
+         << ", \"p99\": " << frame_stats.p99
+         << ", \"mean\": " << frame_stats.mean
+         << ", \"max\": " << frame_stats.max << "},\n";
+    // per frame
+    const GLStateCache::Counters& gl_calls = gl_state.get_total_counters();
+    const double frame_num = double(frame_stats.count ? frame_stats.count : 1);
+    file << "  \"gl_state_calls\": {\"issued\": " << gl_calls.get_issued() / frame_num
+         << ", \"elided\": " << gl_calls.get_elided() / frame_num << "},\n"
+         << "  \"sections\": [";
+    // median of profiled sections
+    for (size_t s_id = 0; s_id < profiler.get_section_num(); ++s_id)
+    {
+        const char* name = profiler.get_section_name(s_id).c_str();
+        FrameProfiler::Stats cpu_stats, gpu_stats;
+        profiler.get_cpu_stats(name, cpu_stats);
+        profiler.get_gpu_stats(name, gpu_stats);
+        file << (s_id ? ",\n" : "\n")
+             << "    {\"name\": \"" << name << "\""
+             << ", \"cpu_median_ms\": " << cpu_stats.p50
+             << ", \"cpu_p95_ms\": " << cpu_stats.p95;
+        if (gpu_stats.count)
+            file << ", \"gpu_median_ms\": " << gpu_stats.p50
+                 << ", \"gpu_p95_ms\": " << gpu_stats.p95;
+        file << "}";
+    }
+    file << "\n  ]\n}\n";
+    return file.good() ? 0 : -1;
+}
+
+void GlfwApp::paint_frame()
+{
+    gl_state.new_frame();
+    if (render_running)
+    {
+        InputEvent ev;
+        while (input_queue.pop(ev))
+            dispatch_input(ev);
+
+        FrameProfiler::CpuScope scope(&profiler, "process_keyboard_input");
+        process_keyboard_input();
+    }
+    else if (!headless)
     {
         glfwGetFramebufferSize(window, &width, &height);
+        glfwGetWindowSize(window, &win_width, &win_height);
         glfwPollEvents();
-        
+
+        FrameProfiler::CpuScope scope(&profiler, "process_keyboard_input");
         process_keyboard_input();
+    }
 
-        paint();
+    FrameProfiler::Scope scope(&profiler, "paint");
+    paint();
+}
 
+void GlfwApp::swap_frame()
+{
+    FrameProfiler::CpuScope scope(&profiler, "swap_buffers");
+    if (!headless)
         glfwSwapBuffers(window);
-    }
+    else
+        glFlush();
+}
 
-    // exit
-    destroy_app();
+int GlfwApp::save_frame(const char* png_filename)
+{
+    if (read_frame())
+        return -1;
+    // opengl rows start from bottom
+    return write_png(png_filename, width, height, 4, &frame_pixels[0], true);
+}
+
+int GlfwApp::read_frame()
+{
+    if (width <= 0 || height <= 0)
+        return -1;
+
+    frame_pixels.resize(size_t(width) * size_t(height) * 4);
+    glReadBuffer(fbo ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &frame_pixels[0]);
 
+    GLfloat clear_color[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+    for (size_t c_id = 0; c_id < 4; ++c_id)
+    {
+        float c = clear_color[c_id] < 0.0f ? 0.0f : (clear_color[c_id] > 1.0f ? 1.0f : clear_color[c_id]);
+        frame_clear_color[c_id] = (unsigned char)(c * 255.0f + 0.5f);
+    }
     return 0;
 }
 
+size_t GlfwApp::get_drawn_pixel_num() const
+{
+    // rgb only, allow rounding of clear color
+    size_t drawn_num = 0;
+    for (size_t p_id = 0; p_id < frame_pixels.size(); p_id += 4)
+    {
+        for (size_t c_id = 0; c_id < 3; ++c_id)
+        {
+            if (std::abs(int(frame_pixels[p_id + c_id]) - int(frame_clear_color[c_id])) > 1)
+            {
+                ++drawn_num;
+                break;
+            }
+        }
+    }
+    return drawn_num;
+}
+
+double GlfwApp::get_time() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void GlfwApp::invalidate()
+{
+    need_redraw = true;
+    if (render_running)
+    {
+        // render thread can't miss the flag between check and wait
+        {
+            std::lock_guard<std::mutex> lock(redraw_mutex);
+        }
+        redraw_cond.notify_one();
+    }
+    // wake up glfwWaitEvents of main thread, which checks
+    // need_redraw anyway before it waits again
+    else if (window && !headless && std::this_thread::get_id() != event_thread_id)
+        glfwPostEmptyEvent();
+}
+
+void GlfwApp::post_input(const InputEvent& ev)
+{
+    if (!render_running)
+    {
+        // on main thread, glfwWaitEvents returns after this callback
+        dispatch_input(ev);
+        need_redraw = true;
+        return;
+    }
+    flush_input_backlog();
+    if (input_backlog.empty() && input_queue.push(ev))
+    {
+        invalidate();
+        return;
+    }
+
+    // render thread is behind by whole queue, events wait in order,
+    // consecutive moves and resizes only need the last one
+    if (!input_backlog.empty() && input_backlog.back().type == ev.type)
+    {
+        InputEvent& last = input_backlog.back();
+        if (ev.type == InputEvent::MouseMove || ev.type == InputEvent::Resize)
+        {
+            last = ev;
+            return;
+        }
+        if (ev.type == InputEvent::MouseScroll)
+        {
+            last.x += ev.x;
+            last.y += ev.y;
+            return;
+        }
+    }
+    input_backlog.push_back(ev);
+    invalidate();
+}
+
+void GlfwApp::flush_input_backlog()
+{
+    bool is_pushed = false;
+    while (!input_backlog.empty() && input_queue.push(input_backlog.front()))
+    {
+        input_backlog.pop_front();
+        is_pushed = true;
+    }
+    if (is_pushed)
+        invalidate();
+}
+
+void GlfwApp::dispatch_input(const InputEvent& ev)
+{
+    switch (ev.type)
+    {
+    case InputEvent::Resize:
+        width = int(ev.x);
+        height = int(ev.y);
+        win_width = ev.id;
+        win_height = ev.action;
+        resize(width, height);
+        break;
+    case InputEvent::MouseMove:
+        mouse_move(ev.x, ev.y);
+        break;
+    case InputEvent::MouseScroll:
+        mouse_scroll(ev.y);
+        break;
+    case InputEvent::MouseButton:
+        if (ev.id >= 0 && ev.id <= GLFW_MOUSE_BUTTON_LAST)
+            mouse_states[ev.id] = ev.action != GLFW_RELEASE;
+        mouse_button(ev.id, ev.action);
+        break;
+    case InputEvent::Key:
+        if (ev.id >= 0 && ev.id <= GLFW_KEY_LAST)
+            key_states[ev.id] = ev.action != GLFW_RELEASE;
+        break;
+    default:
+        break;
+    }
+}
+
 int GlfwApp::resize(int wd, int ht)
 {
     glViewport(0, 0, wd, ht);
@@ -144,6 +828,11 @@ void GlfwApp::mouse_scroll(double offset)
 
 }
 
+void GlfwApp::mouse_button(int button, int action)
+{
+
+}
+
 void GlfwApp::process_keyboard_input()
 {
     if (key_is_pressed(GLFW_KEY_ESCAPE))
@@ -3,28 +3,205 @@
 
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
+#include "SpscQueue.h"
+
 class GlfwApp
 {
+public:
+	// input of glfw callbacks, passed from main thread to render thread
+	struct InputEvent
+	{
+		enum Type
+		{
+			Resize = 0,
+			Refresh = 1,
+			MouseMove = 2,
+			MouseScroll = 3,
+			MouseButton = 4,
+			Key = 5
+		};
+		Type type;
+		// button or key and action, window size of Resize
+		int id, action;
+		// framebuffer size, cursor position or scroll offset
+		double x, y;
+	};
+
 protected:
 	std::string win_name;
+	// framebuffer size in pixels
 	int width, height;
+	// window size in screen coordinates like cursor positions,
+	// smaller than framebuffer on HiDPI displays
+	int win_width, win_height;
 	GLFWwindow* window;
+	// requested opengl core profile version
+	int gl_major_version, gl_minor_version;
+
+	// render into fbo without visible window, with EGL surfaceless
+	// context if built with GLFWAPP_USE_EGL, else hidden glfw window
+	bool headless;
+	GLuint fbo, fbo_color, fbo_depth;
+	void* egl_display;
+	void* egl_context;
+	// glfw isn't initialized for EGL context, so time is kept here
+	std::chrono::steady_clock::time_point start_time;
+	// last frame read by read_frame(), rgba rows from bottom
+	std::vector<unsigned char> frame_pixels;
+	unsigned char frame_clear_color[4];
+
+	// without continuous redraw, run() sleeps in glfwWaitEventsTimeout
+	// until input, resize or invalidate() marks the window dirty
+	bool continuous_redraw;
+	std::atomic<bool> need_redraw;
+	// thread of run() waiting for glfw events
+	std::thread::id event_thread_id;
+	// longest wait for events in seconds, <= 0 waits without timeout
+	double idle_timeout;
+
+	// with render thread, main thread only waits for glfw events and
+	// render thread owns gl context, runs callbacks, paint and swap
+	bool use_render_thread;
+	std::thread render_thread;
+	std::atomic<bool> render_running, render_quit;
+	SpscQueue<InputEvent> input_queue;
+	// events that didn't fit in input_queue, kept in order on main
+	// thread instead of dropped, e.g. a key release
+	std::deque<InputEvent> input_backlog;
+	// app calls glfw functions that are main thread only in paint,
+	// e.g. imgui glfw backend, so render thread is never used
+	bool main_thread_only;
+	// render thread sleeps here without continuous redraw
+	std::mutex redraw_mutex;
+	std::condition_variable redraw_cond;
+	// glfwGetKey and glfwGetMouseButton are main thread only
+	bool key_states[GLFW_KEY_LAST + 1];
+	bool mouse_states[GLFW_MOUSE_BUTTON_LAST + 1];
+
+	// times process_keyboard_input, paint and swap of each frame
+	FrameProfiler profiler;
+	// chrome trace written at exit if not empty
+	std::string trace_filename;
+	// bindings of this context, calls counted per frame
+	GLStateCache gl_state;
+
+	// benchmark run if bench_frame_num > 0
+	size_t bench_warmup_num, bench_frame_num;
+	std::string bench_json_filename;
 
 	int init_app();
 	void destroy_app();
+	void paint_frame();
+	void swap_frame();
+	void render_loop();
+	void dispatch_input(const InputEvent& ev);
+	void flush_input_backlog();
+	int run_benchmark();
+	int write_benchmark_json(const FrameProfiler::Stats& frame_stats);
+	int init_egl();
+	int init_fbo();
 
 public:
 	GlfwApp();
 	~GlfwApp();
 
 	inline void set_win_size(int wd, int ht) { width = wd; height = ht; }
+	// cursor position of mouse_move() in framebuffer pixels
+	inline void cursor_to_pixels(double& xpos, double& ypos) const
+	{
+		if (win_width > 0 && win_height > 0)
+		{
+			xpos *= double(width) / double(win_width);
+			ypos *= double(height) / double(win_height);
+		}
+	}
 	inline void set_win_name(const char* name) { win_name = name; }
+	// default 3.3, falls back to 3.3 if the version is not available
+	inline void set_gl_version(int major, int minor)
+	{ gl_major_version = major; gl_minor_version = minor; }
+
+	// no window, frames are only kept in fbo
+	inline void set_headless(bool enable) { headless = enable; }
+	inline bool is_headless() const { return headless; }
+
+	// redraw every frame for animation, by default frames are
+	// only painted on input, resize and invalidate()
+	inline void set_continuous_redraw(bool enable) { continuous_redraw = enable; }
+	inline bool is_continuous_redraw() const { return continuous_redraw; }
+	inline void set_idle_timeout(double seconds) { idle_timeout = seconds; }
+	// request repaint, can be called from any thread
+	void invalidate();
+
+	// paint in render thread so that slow frames don't delay event
+	// processing and window moves don't stall rendering, handlers
+	// (resize, mouse_move, ...) then run on render thread as well
+	inline void set_render_thread(bool enable) { use_render_thread = enable && !main_thread_only; }
+	inline bool is_render_thread() const { return use_render_thread; }
+	// set in constructor of apps that can't paint in render thread,
+	// overrides set_render_thread() and set_default_render_thread()
+	inline void set_main_thread_only(bool enable)
+	{
+		main_thread_only = enable;
+		if (enable)
+			use_render_thread = false;
+	}
+	// called by glfw callbacks on main thread, queued to render thread
+	void post_input(const InputEvent& ev);
 
+	// until window is closed, one frame if headless
 	int run(int wd = 800, int ht = 800);
+	// paint frame_num frames, last frame is saved if png_filename is given
+	int run_frames(size_t frame_num, const char* png_filename = nullptr,
+		int wd = 800, int ht = 800);
+	// read back current framebuffer, return 0 if success
+	int save_frame(const char* png_filename);
+	int read_frame();
+	inline const std::vector<unsigned char>& get_frame_pixels() const { return frame_pixels; }
+	// pixels of the last read frame that differ from clear color
+	size_t get_drawn_pixel_num() const;
+	// seconds since app initialized, instead of glfwGetTime()
+	double get_time() const;
+
+	// run() renders warmup_num frames, then times frame_num frames
+	// with vsync off and glFinish after each frame, report goes to
+	// stdout and to json_filename if given
+	inline void set_benchmark(size_t warmup_num, size_t frame_num,
+		const char* json_filename = nullptr)
+	{
+		bench_warmup_num = warmup_num;
+		bench_frame_num = frame_num;
+		bench_json_filename = json_filename ? json_filename : "";
+	}
+	inline bool is_benchmark() const { return bench_frame_num > 0; }
+
+	// settings of apps constructed afterwards, for selecting
+	// run mode of examples from command line
+	static void set_default_headless(bool enable);
+	static void set_default_render_thread(bool enable);
+	static void set_default_benchmark(size_t warmup_num, size_t frame_num,
+		const char* json_filename = nullptr);
+
+	inline FrameProfiler& get_profiler() { return profiler; }
+	inline GLStateCache& get_gl_state() { return gl_state; }
+	// record chrome trace, written with statistics at exit
+	inline void set_trace_file(const char* filename)
+	{
+		trace_filename = filename ? filename : "";
+		profiler.set_trace_enabled(!trace_filename.empty());
+	}
 
 public:
 	// function written by user
@@ -35,6 +212,7 @@ public:
 	virtual void error(int id, const char* description);
 	virtual void mouse_move(double xpos, double ypos);
 	virtual void mouse_scroll(double offset);
+	virtual void mouse_button(int button, int action);
 	virtual void process_keyboard_input();
 
 	// utilities
@@ -42,8 +220,29 @@ public:
 	// GLFW_KEY_S
 	// GLFW_KEY_A
 	// GLFW_KEY_D
-	inline bool key_is_pressed(int key) { return glfwGetKey(window, key) == GLFW_PRESS; }
-	inline void close_window() { glfwSetWindowShouldClose(window, true); }
+	inline bool key_is_pressed(int key)
+	{
+		if (use_render_thread)
+			return key >= 0 && key <= GLFW_KEY_LAST && key_states[key];
+		return window && glfwGetKey(window, key) == GLFW_PRESS;
+	}
+	// GLFW_MOUSE_BUTTON_LEFT
+	// GLFW_MOUSE_BUTTON_RIGHT
+	inline bool mouse_is_pressed(int button)
+	{
+		if (use_render_thread)
+			return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && mouse_states[button];
+		return window && glfwGetMouseButton(window, button) == GLFW_PRESS;
+	}
+	// wake up main thread waiting for events
+	inline void close_window()
+	{
+		if (window)
+		{
+			glfwSetWindowShouldClose(window, true);
+			glfwPostEmptyEvent();
+		}
+	}
 
 private:	
 	// current application instance
@@ -0,0 +1,137 @@
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() :
+    data(nullptr), size(0),
+    file_handle(INVALID_HANDLE_VALUE),
+    map_handle(nullptr)
+{
+
+}
+
+int MappedFile::open(const char* filename)
+{
+    close();
+
+    file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "MappedFile: Can't open file " << filename << ".\n";
+        return -1;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+    {
+        close();
+        return -1;
+    }
+    size = size_t(file_size.QuadPart);
+
+    map_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!map_handle)
+    {
+        std::cout << "MappedFile: Can't map file " << filename << ".\n";
+        close();
+        return -1;
+    }
+
+    data = (const char*)MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        std::cout << "MappedFile: Can't map file " << filename << ".\n";
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+void MappedFile::close()
+{
+    if (data)
+    {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+    if (map_handle)
+    {
+        CloseHandle(map_handle);
+        map_handle = nullptr;
+    }
+    if (file_handle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file_handle);
+        file_handle = INVALID_HANDLE_VALUE;
+    }
+    size = 0;
+}
+
+#else
+
+MappedFile::MappedFile() :
+    data(nullptr), size(0), file_desc(-1)
+{
+
+}
+
+int MappedFile::open(const char* filename)
+{
+    close();
+
+    file_desc = ::open(filename, O_RDONLY);
+    if (file_desc < 0)
+    {
+        std::cout << "MappedFile: Can't open file " << filename << ".\n";
+        return -1;
+    }
+
+    struct stat file_stat;
+    if (fstat(file_desc, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        close();
+        return -1;
+    }
+    size = size_t(file_stat.st_size);
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_desc, 0);
+    if (addr == MAP_FAILED)
+    {
+        std::cout << "MappedFile: Can't map file " << filename << ".\n";
+        close();
+        return -1;
+    }
+    data = (const char*)addr;
+    return 0;
+}
+
+void MappedFile::close()
+{
+    if (data)
+    {
+        munmap((void*)data, size);
+        data = nullptr;
+    }
+    if (file_desc >= 0)
+    {
+        ::close(file_desc);
+        file_desc = -1;
+    }
+    size = 0;
+}
+
+#endif
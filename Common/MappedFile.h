@@ -0,0 +1,36 @@
+#ifndef __Mapped_File_h__
+#define __Mapped_File_h__
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+protected:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    void* file_handle;
+    void* map_handle;
+#else
+    int file_desc;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile() { close(); }
+
+    // return 0 if success, -1 if fails
+    int open(const char* filename);
+    void close();
+
+    inline bool is_open() const { return data != nullptr; }
+    inline const char* get_data() const { return data; }
+    inline size_t get_size() const { return size; }
+
+private: // no copy
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+};
+
+#endif
@@ -1,5 +1,10 @@
 #include <fstream>
 #include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
 
 #include "OpenGLShaderUtilities.h"
 
@@ -7,27 +12,48 @@ OpenGLShaderSupportCheck::OpenGLShaderSupportCheck() :
     major_version(0), minor_version(0),
     geometry_shader_supported(false),
     tessellation_shader_supported(false),
-    compute_shader_supported(false)
+    compute_shader_supported(false),
+    parallel_compile_supported(false),
+    separate_shader_objects_supported(false)
 {
     glGetIntegerv(GL_MAJOR_VERSION, &major_version);
     glGetIntegerv(GL_MINOR_VERSION, &minor_version);
 
-    // Geometry shader needs version > 3.2
-    if (major_version > 3 && minor_version > 2)
+    // Geometry shader needs version >= 3.2
+    if (major_version > 3 || (major_version == 3 && minor_version >= 2))
         geometry_shader_supported = true;
-    // Tessellation shader needs version > 4.0
-    if (major_version > 4 && minor_version > 0)
+    // Tessellation shader needs version >= 4.0
+    if (major_version >= 4)
         tessellation_shader_supported = true;
-    // Compute shader needs version > 4.3
-    if (major_version > 4 && minor_version > 3)
+    // Compute shader needs version >= 4.3
+    if (major_version > 4 || (major_version == 4 && minor_version >= 3))
         compute_shader_supported = true;
+    parallel_compile_supported = has_extension("GL_KHR_parallel_shader_compile") ||
+                                 has_extension("GL_ARB_parallel_shader_compile");
+    // functions are loaded by glad only for version >= 4.1
+    separate_shader_objects_supported = glGenProgramPipelines &&
+        (major_version > 4 || (major_version == 4 && minor_version >= 1) ||
+         has_extension("GL_ARB_separate_shader_objects"));
+}
+
+bool OpenGLShaderSupportCheck::has_extension(const char* name)
+{
+    GLint ext_num = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &ext_num);
+    for (GLint e_id = 0; e_id < ext_num; ++e_id)
+    {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, GLuint(e_id));
+        if (ext && !strcmp(ext, name))
+            return true;
+    }
+    return false;
 }
 
 // ===================== OpenGL Shader Clas =====================
 const char* OpenGLShader::type_names[] =
 {
-    "Fragment",
     "Vertex",
+    "Fragment",
     "Geometry",
     "Tessellation Control",
     "Tessellation Evaluation",
@@ -95,6 +121,25 @@ bool OpenGLShader::compile(const char* code)
 
     glShaderSource(shader_id, 1, &code, nullptr);
     glCompileShader(shader_id);
+    return finish_compile();
+}
+
+bool OpenGLShader::submit_code(const char* code, ShaderType type)
+{
+    if (!create(type))
+        return false;
+    if (!code)
+    {
+        std::cout << "OpenGLShader: code is empty.\n";
+        return false;
+    }
+    glShaderSource(shader_id, 1, &code, nullptr);
+    glCompileShader(shader_id);
+    return true;
+}
+
+bool OpenGLShader::finish_compile()
+{
     // get compilation status
     GLint comp_res = 0;
     glGetShaderiv(shader_id, GL_COMPILE_STATUS, &comp_res);
@@ -114,7 +159,7 @@ bool OpenGLShader::compile(const char* code)
             return false;
         }
     }
-    return true;
+    return compiled_already;
 }
 
 bool OpenGLShader::compile_code(const char* code, ShaderType type)
@@ -131,15 +176,39 @@ bool OpenGLShader::compile_code(const char* code, ShaderType type)
             << "\nProblematic shader code:\n"
             << code << "\n";
     }
-    std::cout << "OpenGLShader: code is empty.\n";
-    return false;
+    return compiled_already;
 }
 
-bool OpenGLShader::compile_file(const char* filename, ShaderType type)
+bool OpenGLShader::compile_file(const char* filename, ShaderType type, const Defines* defines)
 {
     if (!create(type))
         return false;
     
+    std::string code;
+    std::vector<std::string> included_files;
+    if (!preprocess_file(filename, defines, code, &included_files))
+        return false;
+    compile(code.c_str());
+    if (!compiled_already)
+    {
+        std::cout << "OpenGLShader: "
+            << get_type_name() << " shader compilation error:\n"
+            << log
+            << "\nShader file path:\n"
+            << filename;
+        // source string numbers of error messages
+        for (size_t f_id = 1; f_id < included_files.size(); ++f_id)
+            std::cout << "\n" << f_id << ": " << included_files[f_id];
+        std::cout << "\nProblematic shader code:\n"
+            << code << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool OpenGLShader::read_file(const char* filename, std::string& code)
+{
     if (!filename || strlen(filename) == 0)
     {
         std::cout << "OpenGLShader: Filename is empty.\n";
@@ -157,30 +226,110 @@ bool OpenGLShader::compile_file(const char* filename, ShaderType type)
     size_t file_size = file.tellg();
     file.seekg(0, std::ios::beg);
     // read in code
-    std::vector<char> code_buffer(file_size+1);
-    file.read(&code_buffer[0], file_size);
-    file.close();
-    code_buffer[file_size] = '\0';
-    compile(&code_buffer[0]);
-    if (!compiled_already)
+    code.resize(file_size);
+    if (file_size)
+        file.read(&code[0], file_size);
+    return true;
+}
+
+// append file and its includes to code
+static bool append_shader_file(
+    const std::string& filename,
+    std::string& code,
+    std::vector<std::string>& included_files,
+    size_t depth
+    )
+{
+    if (depth > 32)
     {
-        std::cout << "OpenGLShader: "
-            << get_type_name() << " shader compilation error:\n"
-            << log
-            << "\nShader file path:\n"
-            << filename
-            << "\nProblematic shader code:\n"
-            << &code_buffer[0] << "\n";
+        std::cout << "OpenGLShader: #include is nested too deeply in " << filename << ".\n";
+        return false;
+    }
+    std::string src;
+    if (!OpenGLShader::read_file(filename.c_str(), src))
         return false;
+    const size_t file_id = included_files.size();
+    included_files.push_back(filename);
+    const size_t dir_len = filename.find_last_of("/\\") + 1; // 0 if no directory
+
+    size_t line_start = 0, line_no = 1;
+    while (line_start < src.size())
+    {
+        size_t line_end = src.find('\n', line_start);
+        if (line_end == std::string::npos)
+            line_end = src.size();
+        size_t dir_start = src.find_first_not_of(" \t", line_start);
+        if (dir_start < line_end && src.compare(dir_start, 8, "#include") == 0)
+        {
+            size_t name_start = src.find('"', dir_start + 8);
+            size_t name_end = name_start < line_end ? src.find('"', name_start + 1) : std::string::npos;
+            if (name_end >= line_end)
+            {
+                std::cout << "OpenGLShader: " << filename << "(" << line_no
+                          << "): #include needs \"filename\".\n";
+                return false;
+            }
+            std::string inc_filename = filename.substr(0, dir_len) +
+                src.substr(name_start + 1, name_end - name_start - 1);
+            if (std::find(included_files.begin(), included_files.end(), inc_filename)
+                == included_files.end())
+            {
+                code += "#line 1 " + std::to_string(included_files.size()) + "\n";
+                if (!append_shader_file(inc_filename, code, included_files, depth + 1))
+                    return false;
+                code += "\n";
+            }
+            code += "#line " + std::to_string(line_no + 1) + " " + std::to_string(file_id) + "\n";
+        }
+        else
+        {
+            code.append(src, line_start, line_end - line_start);
+            code += '\n';
+        }
+        line_start = line_end + 1;
+        ++line_no;
     }
+    return true;
+}
+
+bool OpenGLShader::preprocess_file(
+    const char* filename,
+    const Defines* defines,
+    std::string& code,
+    std::vector<std::string>* included_files
+    )
+{
+    std::vector<std::string> files;
+    code.clear();
+    if (!filename || !append_shader_file(filename, code, files, 0))
+        return false;
+    if (included_files)
+        included_files->swap(files);
+    if (!defines || defines->empty())
+        return true;
 
+    // #version must come first
+    size_t insert_pos = 0, line_no = 1;
+    size_t ver_pos = code.find("#version");
+    if (ver_pos != std::string::npos)
+    {
+        insert_pos = code.find('\n', ver_pos);
+        insert_pos = insert_pos == std::string::npos ? code.size() : insert_pos + 1;
+        line_no += std::count(code.begin(), code.begin() + insert_pos, '\n');
+    }
+    std::string define_code;
+    for (size_t d_id = 0; d_id < defines->size(); ++d_id)
+        define_code += "#define " + (*defines)[d_id].first + " " + (*defines)[d_id].second + "\n";
+    define_code += "#line " + std::to_string(line_no) + " 0\n";
+    code.insert(insert_pos, define_code);
     return true;
 }
 
 
 // ======================== OpenGL Shader Program ========================
 OpenGLShaderProgram::OpenGLShaderProgram():
-    program_id(0), linked_already(false), log("")
+    program_id(0), linked_already(false), separable(false), log(""),
+    building(false), poll_completion(false), build_binary_key(0)
 {
     shader_vert.init();
     shader_frag.init();
@@ -194,7 +343,7 @@ OpenGLShaderProgram::~OpenGLShaderProgram()
 {
     if (program_id)
     {
-        glDeleteProgram(program_id);
+        GLStateCache::get().delete_program(program_id);
         program_id = 0;
     }
     del_all_shaders();
@@ -205,11 +354,83 @@ bool OpenGLShaderProgram::create(
     const char* shd_frag_filename
     )
 {
-    bool res_create = create();
-    bool res_shader1 = add_shader_from_file(ShaderType::Vertex, shd_vert_filename);
-    bool res_shader2 = add_shader_from_file(ShaderType::Fragment, shd_frag_filename);
-    bool res_link = link();
-    return res_create && res_shader1 && res_shader2 && res_link;
+    const ShaderType types[2] = { ShaderType::Vertex, ShaderType::Fragment };
+    const char* filenames[2] = { shd_vert_filename, shd_frag_filename };
+    return create_from_files(types, filenames, 2);
+}
+
+bool OpenGLShaderProgram::create_from_files(
+    const ShaderType* types,
+    const char* const* filenames,
+    size_t num,
+    const OpenGLShader::Defines* defines
+    )
+{
+    if (binary_cache_dir.empty())
+    {
+        // compile errors report file path
+        bool res = create();
+        for (size_t s_id = 0; s_id < num; ++s_id)
+            res = add_shader_from_file(types[s_id], filenames[s_id], defines) && res;
+        return link() && res;
+    }
+
+    // binary is looked up by preprocessed code
+    std::vector<std::string> codes(num);
+    std::vector<const char*> code_ptrs(num);
+    for (size_t s_id = 0; s_id < num; ++s_id)
+    {
+        if (!OpenGLShader::preprocess_file(filenames[s_id], defines, codes[s_id]))
+            return false;
+        code_ptrs[s_id] = codes[s_id].c_str();
+    }
+    return create_from_code(types, num ? &code_ptrs[0] : nullptr, num, filenames);
+}
+
+bool OpenGLShaderProgram::create_from_code(
+    const ShaderType* types,
+    const char* const* codes,
+    size_t num
+    )
+{
+    return create_from_code(types, codes, num, nullptr);
+}
+
+bool OpenGLShaderProgram::create_from_code(
+    const ShaderType* types,
+    const char* const* codes,
+    size_t num,
+    const char* const* filenames
+    )
+{
+    if (!create())
+        return false;
+
+    std::string bin_filename;
+    uint64_t bin_key = 0;
+    if (!binary_cache_dir.empty() && support_program_binary())
+    {
+        bin_key = get_binary_key(types, codes, num);
+        bin_filename = get_binary_filename(bin_key);
+        if (load_binary(bin_filename, bin_key))
+            return true;
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    bool res = true;
+    for (size_t s_id = 0; s_id < num; ++s_id)
+    {
+        if (!add_shader_from_code(types[s_id], codes[s_id]))
+        {
+            if (filenames)
+                std::cout << "Shader file path:\n" << filenames[s_id] << "\n";
+            res = false;
+        }
+    }
+    res = link() && res;
+    if (res && !bin_filename.empty())
+        save_binary(bin_filename, bin_key);
+    return res;
 }
 
 bool OpenGLShaderProgram::add_shader(OpenGLShader &shader)
@@ -230,6 +451,15 @@ bool OpenGLShaderProgram::add_shader(OpenGLShader &shader)
 
 bool OpenGLShaderProgram::add_shader_from_code(ShaderType type, const char* code)
 {
+    if (OpenGLShaderCache::is_enabled())
+    {
+        OpenGLShader* shader = OpenGLShaderCache::acquire(type, code);
+        if (!shader)
+            return false;
+        shader_ptr[type].set(shader, true);
+        return true;
+    }
+
     OpenGLShader* shader = new OpenGLShader;
     if (!shader->compile_code(code, type))
     {
@@ -247,11 +477,31 @@ bool OpenGLShaderProgram::add_shader_from_code(ShaderType type, const char* code
 
 bool OpenGLShaderProgram::add_shader_from_file(
     ShaderType type,
-    const char* filename
+    const char* filename,
+    const OpenGLShader::Defines* defines
     )
 {
+    if (OpenGLShaderCache::is_enabled())
+    {
+        std::string code;
+        std::vector<std::string> included_files;
+        if (!OpenGLShader::preprocess_file(filename, defines, code, &included_files))
+            return false;
+        OpenGLShader* shader = OpenGLShaderCache::acquire(type, code.c_str());
+        if (!shader)
+        {
+            std::cout << "Shader file path:\n" << filename;
+            for (size_t f_id = 1; f_id < included_files.size(); ++f_id)
+                std::cout << "\n" << f_id << ": " << included_files[f_id];
+            std::cout << "\n";
+            return false;
+        }
+        shader_ptr[type].set(shader, true);
+        return true;
+    }
+
     OpenGLShader* shader = new OpenGLShader;
-    if (!shader->compile_file(filename, type))
+    if (!shader->compile_file(filename, type, defines))
     {
         log = shader->get_log();
         delete shader;
@@ -283,12 +533,28 @@ bool OpenGLShaderProgram::link()
     if (shader_comp.is_valid())
         glAttachShader(program_id, shader_comp.get_id());
 
+    set_separable_parameter();
     glLinkProgram(program_id);
+    return finish_link();
+}
+
+bool OpenGLShaderProgram::finish_link()
+{
     GLint link_res;
     glGetProgramiv(program_id, GL_LINK_STATUS, &link_res);
     linked_already = (link_res != 0);
     if (!linked_already)
     {
+        uniforms.clear();
+        // compile errors of asynchronously submitted shaders
+        for (size_t s_id = 0; s_id < OpenGLShader::type_num; ++s_id)
+        {
+            OpenGLShader* shader = shader_ptr[s_id].shader;
+            if (shader && shader->get_id() && !shader->is_compiled() &&
+                !shader->finish_compile())
+                std::cout << "OpenGLShader: " << shader->get_type_name()
+                          << " compilation error.\n" << shader->get_log() << "\n";
+        }
         GLint info_log_len;
         glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &info_log_len);
         if (info_log_len > 0)
@@ -304,6 +570,687 @@ bool OpenGLShaderProgram::link()
         return false;
     }
 
-    del_all_shaders(); // clear shader if success
+    // program keeps its code, shared shaders are only detached
+    GLint attached_num = 0;
+    glGetProgramiv(program_id, GL_ATTACHED_SHADERS, &attached_num);
+    if (attached_num > 0)
+    {
+        std::vector<GLuint> attached(attached_num);
+        glGetAttachedShaders(program_id, attached_num, nullptr, &attached[0]);
+        for (GLint a_id = 0; a_id < attached_num; ++a_id)
+            glDetachShader(program_id, attached[a_id]);
+    }
+    del_uncached_shaders(); // clear shader if success
+    cache_uniforms();
+    return bind_shared_blocks();
+}
+
+void OpenGLShaderProgram::cache_uniforms()
+{
+    uniforms.clear();
+
+    GLint uniform_num = 0, max_name_len = 0;
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORMS, &uniform_num);
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_len);
+    std::vector<char> name_buf(size_t(max_name_len) + 1);
+    for (GLint u_id = 0; u_id < uniform_num; ++u_id)
+    {
+        GLsizei name_len = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_id, GLuint(u_id), max_name_len + 1,
+                           &name_len, &size, &type, &name_buf[0]);
+        name_buf[name_len] = '\0';
+        // members of uniform blocks have no location
+        GLint loc = glGetUniformLocation(program_id, &name_buf[0]);
+        if (loc == -1)
+            continue;
+
+        UniformInfo info;
+        info.name.assign(&name_buf[0], name_len);
+        info.location = loc;
+        info.type = type;
+        info.size = size;
+        uniforms.push_back(info);
+
+        // array is reported as "a[0]", elements may not have
+        // contiguous locations
+        if (name_len > 3 && info.name.compare(name_len - 3, 3, "[0]") == 0)
+        {
+            std::string base_name = info.name.substr(0, name_len - 3);
+            info.name = base_name;
+            uniforms.push_back(info);
+            for (GLint e_id = 1; e_id < size; ++e_id)
+            {
+                info.name = base_name + "[" + std::to_string(e_id) + "]";
+                info.location = glGetUniformLocation(program_id, info.name.c_str());
+                info.size = size - e_id;
+                if (info.location != -1)
+                    uniforms.push_back(info);
+            }
+        }
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+}
+
+std::vector<UniformBlockLayout> OpenGLShaderProgram::shared_blocks;
+
+void OpenGLShaderProgram::add_shared_uniform_block(const UniformBlockLayout& layout)
+{
+    for (size_t b_id = 0; b_id < shared_blocks.size(); ++b_id)
+    {
+        if (strcmp(shared_blocks[b_id].name, layout.name) == 0)
+        {
+            shared_blocks[b_id] = layout;
+            return;
+        }
+    }
+    shared_blocks.push_back(layout);
+}
+
+bool OpenGLShaderProgram::bind_shared_blocks()
+{
+    bool res = true;
+    for (size_t b_id = 0; b_id < shared_blocks.size(); ++b_id)
+    {
+        if (has_uniform_block(shared_blocks[b_id].name))
+            res = bind_uniform_block(shared_blocks[b_id]) && res;
+    }
+    return res;
+}
+
+bool OpenGLShaderProgram::bind_uniform_block(const UniformBlockLayout& layout)
+{
+    GLuint block_id = program_id ? glGetUniformBlockIndex(program_id, layout.name) : GL_INVALID_INDEX;
+    if (block_id == GL_INVALID_INDEX)
+    {
+        std::cout << "OpenGLShaderProgram: No uniform block " << layout.name << ".\n";
+        return false;
+    }
+    glUniformBlockBinding(program_id, block_id, layout.binding);
+
+    bool res = true;
+    GLint block_size = 0;
+    glGetActiveUniformBlockiv(program_id, block_id, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+    if (size_t(block_size) > layout.size)
+    {
+        std::cout << "OpenGLShaderProgram: Uniform block " << layout.name << " has "
+                  << block_size << " bytes, CPU struct has " << layout.size << ".\n";
+        res = false;
+    }
+    for (size_t m_id = 0; m_id < layout.member_num; ++m_id)
+    {
+        const UniformBlockMember& member = layout.members[m_id];
+        GLuint index = GL_INVALID_INDEX;
+        glGetUniformIndices(program_id, 1, &member.name, &index);
+        if (index == GL_INVALID_INDEX) // optimized out
+            continue;
+        GLint offset = -1, type = 0, block_index = -1;
+        glGetActiveUniformsiv(program_id, 1, &index, GL_UNIFORM_OFFSET, &offset);
+        glGetActiveUniformsiv(program_id, 1, &index, GL_UNIFORM_TYPE, &type);
+        glGetActiveUniformsiv(program_id, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block_index);
+        if (block_index != GLint(block_id) || GLenum(type) != member.type ||
+            offset != GLint(member.offset))
+        {
+            std::cout << "OpenGLShaderProgram: Member " << member.name << " of uniform block "
+                      << layout.name << " is at offset " << offset << " with type 0x"
+                      << std::hex << type << ", CPU struct has offset " << std::dec
+                      << member.offset << " with type 0x" << std::hex << member.type
+                      << std::dec << ".\n";
+            res = false;
+        }
+    }
+    return res;
+}
+
+bool OpenGLShaderProgram::create_async_from_files(
+    const ShaderType* types,
+    const char* const* filenames,
+    size_t num,
+    const OpenGLShader::Defines* defines
+    )
+{
+    std::vector<std::string> codes(num);
+    std::vector<const char*> code_ptrs(num);
+    for (size_t s_id = 0; s_id < num; ++s_id)
+    {
+        if (!OpenGLShader::preprocess_file(filenames[s_id], defines, codes[s_id]))
+            return false;
+        code_ptrs[s_id] = codes[s_id].c_str();
+    }
+    return create_async_from_code(types, num ? &code_ptrs[0] : nullptr, num);
+}
+
+bool OpenGLShaderProgram::create_async_from_code(
+    const ShaderType* types,
+    const char* const* codes,
+    size_t num
+    )
+{
+    if (!create())
+        return false;
+
+    build_binary_filename.clear();
+    if (!binary_cache_dir.empty() && support_program_binary())
+    {
+        uint64_t bin_key = get_binary_key(types, codes, num);
+        std::string bin_filename = get_binary_filename(bin_key);
+        if (load_binary(bin_filename, bin_key))
+            return true;
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        build_binary_filename = bin_filename;
+        build_binary_key = bin_key;
+    }
+
+    for (size_t s_id = 0; s_id < num; ++s_id)
+    {
+        OpenGLShader* shader = nullptr;
+        const bool cached = OpenGLShaderCache::is_enabled();
+        if (cached)
+            shader = OpenGLShaderCache::acquire(types[s_id], codes[s_id], true);
+        else
+        {
+            shader = new OpenGLShader;
+            if (!shader->submit_code(codes[s_id], types[s_id]))
+            {
+                delete shader;
+                shader = nullptr;
+            }
+        }
+        if (!shader)
+        {
+            del_all_shaders();
+            return false;
+        }
+        shader_ptr[types[s_id]].set(shader, cached);
+        // compile status is unknown until poll_build()
+        glAttachShader(program_id, shader->get_id());
+    }
+    set_separable_parameter();
+    glLinkProgram(program_id);
+
+    OpenGLShaderSupportCheck support_check;
+    poll_completion = support_check.support_parallel_compile();
+    linked_already = false;
+    building = true;
+    return true;
+}
+
+bool OpenGLShaderProgram::poll_build()
+{
+    if (!building)
+        return true;
+    if (poll_completion)
+    {
+        GLint completed = 0;
+        glGetProgramiv(program_id, GL_COMPLETION_STATUS_KHR, &completed);
+        if (!completed)
+            return false;
+    }
+
+    building = false;
+    if (finish_link() && !build_binary_filename.empty())
+        save_binary(build_binary_filename, build_binary_key);
+    build_binary_filename.clear();
+    return true;
+}
+
+// ======================== Program binary cache ========================
+std::string OpenGLShaderProgram::binary_cache_dir;
+
+namespace
+{
+    // header of cached program binary file, followed by size bytes
+    struct ProgramBinaryHeader
+    {
+        char magic[4];
+        GLuint version;
+        GLuint format;
+        GLuint size;
+        // key of sources the file is named by
+        uint64_t key;
+        // FNV-1a of binary
+        uint64_t checksum;
+    };
+    const char program_binary_magic[4] = { 'G', 'L', 'P', 'B' };
+    const GLuint program_binary_version = 2;
+
+    // 64-bit FNV-1a
+    inline void hash_bytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t b_id = 0; b_id < size; ++b_id)
+        {
+            hash ^= bytes[b_id];
+            hash *= 1099511628211ULL;
+        }
+    }
+    // with terminating 0 so that concatenations differ
+    inline void hash_string(uint64_t& hash, const char* str)
+    {
+        if (!str)
+            str = "";
+        hash_bytes(hash, str, strlen(str) + 1);
+    }
+}
+
+bool OpenGLShaderProgram::support_program_binary()
+{
+    if (!glProgramBinary || !glGetProgramBinary || !glProgramParameteri)
+        return false;
+    GLint format_num = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_num);
+    return format_num > 0;
+}
+
+uint64_t OpenGLShaderProgram::get_binary_key(
+    const ShaderType* types,
+    const char* const* codes,
+    size_t num
+    ) const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t s_id = 0; s_id < num; ++s_id)
+    {
+        int type = types[s_id];
+        hash_bytes(hash, &type, sizeof(type));
+        hash_string(hash, codes[s_id]);
+    }
+    // names of programs that aren't separable are kept
+    if (separable)
+        hash_string(hash, "separable");
+    // binary is only valid for the same driver
+    const GLenum driver_strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+    for (size_t d_id = 0; d_id < sizeof(driver_strings) / sizeof(driver_strings[0]); ++d_id)
+        hash_string(hash, (const char*)glGetString(driver_strings[d_id]));
+    return hash;
+}
+
+std::string OpenGLShaderProgram::get_binary_filename(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.glpb", (unsigned long long)key);
+    std::string filename = binary_cache_dir;
+    if (!filename.empty() && filename.back() != '/' && filename.back() != '\\')
+        filename += '/';
+    return filename + name;
+}
+
+bool OpenGLShaderProgram::load_binary(const std::string& filename, uint64_t key)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    // binary of other version is silently replaced
+    ProgramBinaryHeader header;
+    if (!file.read((char*)&header, sizeof(header)) ||
+        memcmp(header.magic, program_binary_magic, sizeof(header.magic)) ||
+        header.version != program_binary_version)
+        return false;
+    // size is checked against file before allocating
+    file.seekg(0, std::ios::end);
+    const std::streamoff file_size = file.tellg();
+    if (header.size == 0 || header.key != key ||
+        file_size != std::streamoff(sizeof(header) + uint64_t(header.size)))
+    {
+        std::cout << "OpenGLShaderProgram: Binary " << filename
+                  << " is truncated or invalid, compile from source.\n";
+        return false;
+    }
+    std::vector<char> data(header.size);
+    file.seekg(sizeof(header), std::ios::beg);
+    if (!file.read(&data[0], header.size))
+        return false;
+    uint64_t checksum = 14695981039346656037ULL;
+    hash_bytes(checksum, &data[0], data.size());
+    if (checksum != header.checksum)
+    {
+        std::cout << "OpenGLShaderProgram: Binary " << filename
+                  << " is corrupt, compile from source.\n";
+        return false;
+    }
+
+    set_separable_parameter();
+    glProgramBinary(program_id, header.format, &data[0], GLsizei(header.size));
+    GLint link_res = 0;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &link_res);
+    if (!link_res)
+    {
+        // e.g. driver updated without version change
+        std::cout << "OpenGLShaderProgram: Binary " << filename
+                  << " is rejected, compile from source.\n";
+        return false;
+    }
+    linked_already = true;
+    log = "";
+    del_all_shaders();
+    cache_uniforms();
+    // binding isn't kept in binary
+    bind_shared_blocks();
+    return true;
+}
+
+bool OpenGLShaderProgram::save_binary(const std::string& filename, uint64_t key)
+{
+    GLint size = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+        return false;
+    std::vector<char> data(size);
+    ProgramBinaryHeader header;
+    memcpy(header.magic, program_binary_magic, sizeof(header.magic));
+    header.version = program_binary_version;
+    GLsizei len = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program_id, size, &len, &format, &data[0]);
+    if (len <= 0)
+        return false;
+    header.format = format;
+    header.size = GLuint(len);
+    header.key = key;
+    header.checksum = 14695981039346656037ULL;
+    hash_bytes(header.checksum, &data[0], size_t(len));
+
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cout << "OpenGLShaderProgram: Can't write binary " << filename << ".\n";
+        return false;
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write(&data[0], len);
+    return file.good();
+}
+
+const OpenGLShaderProgram::UniformInfo* OpenGLShaderProgram::find_uniform(const char* name) const
+{
+    // binary search without constructing std::string
+    size_t lower = 0, upper = uniforms.size();
+    while (lower < upper)
+    {
+        size_t mid = (lower + upper) / 2;
+        int cmp = strcmp(uniforms[mid].name.c_str(), name);
+        if (cmp == 0)
+            return &uniforms[mid];
+        if (cmp < 0)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+    return nullptr;
+}
+
+
+// ======================== Uniform buffer ========================
+const UniformBlockMember FrameData::members[4] = {
+    { "projection", GL_FLOAT_MAT4, offsetof(FrameData, projection) },
+    { "view", GL_FLOAT_MAT4, offsetof(FrameData, view) },
+    { "viewport", GL_FLOAT_VEC4, offsetof(FrameData, viewport) },
+    { "time", GL_FLOAT, offsetof(FrameData, time) }
+};
+
+const UniformBlockLayout FrameData::layout = {
+    "FrameData", 0, sizeof(FrameData), FrameData::members, 4
+};
+
+bool OpenGLUniformBuffer::create(const UniformBlockLayout& layout)
+{
+    destroy();
+    glGenBuffers(1, &buffer_id);
+    if (!buffer_id)
+    {
+        std::cout << "OpenGLUniformBuffer: Cannot create buffer.\n";
+        return false;
+    }
+    binding = layout.binding;
+    size = layout.size;
+    GLStateCache::get().bind_buffer(GL_UNIFORM_BUFFER, buffer_id);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    bind();
+    OpenGLShaderProgram::add_shared_uniform_block(layout);
+    return true;
+}
+
+void OpenGLUniformBuffer::destroy()
+{
+    if (buffer_id)
+    {
+        GLStateCache::get().delete_buffers(1, &buffer_id);
+        buffer_id = 0;
+    }
+}
+
+void OpenGLUniformBuffer::update(const void* data)
+{
+    if (!buffer_id)
+        return;
+    GLStateCache::get().bind_buffer(GL_UNIFORM_BUFFER, buffer_id);
+    glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    bind();
+}
+
+
+// ======================== Program pipeline ========================
+bool OpenGLProgramPipeline::create()
+{
+    if (pipeline_id)
+        return true;
+    glGenProgramPipelines(1, &pipeline_id);
+    if (!pipeline_id)
+    {
+        std::cout << "OpenGLProgramPipeline: Cannot create program pipeline.\n";
+        return false;
+    }
+    return true;
+}
+
+void OpenGLProgramPipeline::destroy()
+{
+    if (pipeline_id)
+    {
+        GLStateCache::get().delete_program_pipelines(1, &pipeline_id);
+        pipeline_id = 0;
+    }
+}
+
+GLbitfield OpenGLProgramPipeline::get_stage_bit(ShaderType type)
+{
+    static const GLbitfield stage_bits[OpenGLShader::type_num] =
+    {
+        GL_VERTEX_SHADER_BIT,
+        GL_FRAGMENT_SHADER_BIT,
+        GL_GEOMETRY_SHADER_BIT,
+        GL_TESS_CONTROL_SHADER_BIT,
+        GL_TESS_EVALUATION_SHADER_BIT,
+        GL_COMPUTE_SHADER_BIT
+    };
+    if (type < 0 || type >= OpenGLShader::type_num)
+        return 0;
+    return stage_bits[type];
+}
+
+bool OpenGLProgramPipeline::set_stage(ShaderType type, const OpenGLShaderProgram* program)
+{
+    GLbitfield stage_bit = get_stage_bit(type);
+    if (!pipeline_id || !stage_bit)
+        return false;
+    if (program && (!program->is_linked() || !program->is_separable()))
+    {
+        std::cout << "OpenGLProgramPipeline: " << OpenGLShader::type_names[type]
+                  << " stage needs linked separable program.\n";
+        return false;
+    }
+    glUseProgramStages(pipeline_id, stage_bit, program ? program->get_id() : 0);
     return true;
 }
+
+bool OpenGLProgramPipeline::validate()
+{
+    if (!pipeline_id)
+        return false;
+    glValidateProgramPipeline(pipeline_id);
+    GLint valid = 0, info_log_len = 0;
+    glGetProgramPipelineiv(pipeline_id, GL_VALIDATE_STATUS, &valid);
+    glGetProgramPipelineiv(pipeline_id, GL_INFO_LOG_LENGTH, &info_log_len);
+    log = "";
+    if (info_log_len > 0)
+    {
+        std::vector<char> log_buf(info_log_len + 1);
+        glGetProgramPipelineInfoLog(pipeline_id, info_log_len, nullptr, &log_buf[0]);
+        log_buf[info_log_len] = '\0';
+        log = &log_buf[0];
+    }
+    return valid != 0;
+}
+
+void OpenGLShaderVariants::clear()
+{
+    for (auto it = programs.begin(); it != programs.end(); ++it)
+        delete it->second;
+    programs.clear();
+}
+
+int OpenGLShaderVariants::init(
+    const OpenGLShader::ShaderType* stage_types,
+    const char* const* stage_filenames,
+    size_t num,
+    const char* const* names,
+    size_t define_num
+    )
+{
+    clear();
+    if (define_num > max_define_num)
+    {
+        std::cout << "OpenGLShaderVariants: At most " << max_define_num << " defines.\n";
+        return -1;
+    }
+    types.assign(stage_types, stage_types + num);
+    filenames.assign(stage_filenames, stage_filenames + num);
+    define_names.assign(names, names + define_num);
+    return 0;
+}
+
+OpenGLShaderProgram* OpenGLShaderVariants::get(Key key)
+{
+    auto it = programs.find(key);
+    if (it != programs.end())
+        return it->second;
+
+    OpenGLShader::Defines defines;
+    for (size_t d_id = 0; d_id < define_names.size(); ++d_id)
+    {
+        if (key & (Key(1) << d_id))
+            defines.push_back(std::make_pair(define_names[d_id], std::string("1")));
+    }
+    std::vector<const char*> filename_ptrs(filenames.size());
+    for (size_t f_id = 0; f_id < filenames.size(); ++f_id)
+        filename_ptrs[f_id] = filenames[f_id].c_str();
+
+    OpenGLShaderProgram* program = new OpenGLShaderProgram;
+    if (filenames.empty() ||
+        !program->create_from_files(&types[0], &filename_ptrs[0], filenames.size(), &defines))
+    {
+        std::cout << "OpenGLShaderVariants: Can't build variant " << key << ".\n";
+        delete program;
+        program = nullptr;
+    }
+    programs[key] = program;
+    return program;
+}
+
+
+// ======================== Shader cache ========================
+std::unordered_map<const OpenGLShader*, OpenGLShaderCache::Entry> OpenGLShaderCache::entries;
+std::unordered_multimap<uint64_t, OpenGLShader*> OpenGLShaderCache::shaders;
+bool OpenGLShaderCache::enabled = true;
+size_t OpenGLShaderCache::hit_num = 0;
+size_t OpenGLShaderCache::miss_num = 0;
+uint32_t OpenGLShaderCache::generation = 0;
+
+uint64_t OpenGLShaderCache::get_key(OpenGLShader::ShaderType type, const char* code)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    int32_t type_id = int32_t(type);
+    hash_bytes(hash, &type_id, sizeof(type_id));
+    hash_string(hash, code);
+    return hash;
+}
+
+OpenGLShader* OpenGLShaderCache::acquire(
+    OpenGLShader::ShaderType type,
+    const char* code,
+    bool submit_only
+    )
+{
+    if (!code)
+    {
+        std::cout << "OpenGLShader: code is empty.\n";
+        return nullptr;
+    }
+
+    const uint64_t key = get_key(type, code);
+    auto range = shaders.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        OpenGLShader* shader = it->second;
+        Entry& entry = entries[shader];
+        if (shader->get_type() != type || entry.code != code)
+            continue;
+        // submitted by async build and not checked yet
+        if (!submit_only && !shader->is_compiled() && !shader->finish_compile())
+        {
+            std::cout << "OpenGLShader: " << shader->get_type_name()
+                      << " compilation error.\n" << shader->get_log() << "\n";
+            return nullptr;
+        }
+        ++entry.ref_num;
+        ++hit_num;
+        return shader;
+    }
+
+    OpenGLShader* shader = new OpenGLShader;
+    if (submit_only ? !shader->submit_code(code, type) : !shader->compile_code(code, type))
+    {
+        delete shader;
+        return nullptr;
+    }
+    ++miss_num;
+    Entry& entry = entries[shader];
+    entry.key = key;
+    entry.code = code;
+    entry.ref_num = 1;
+    shaders.insert(std::make_pair(key, shader));
+    return shader;
+}
+
+void OpenGLShaderCache::release(OpenGLShader* shader, uint32_t shader_generation)
+{
+    // deleted by clear(), pointer may be reused by a new shader
+    if (shader_generation != generation)
+        return;
+    auto it = entries.find(shader);
+    if (it == entries.end() || --it->second.ref_num > 0)
+        return;
+    auto range = shaders.equal_range(it->second.key);
+    for (auto s_it = range.first; s_it != range.second; ++s_it)
+    {
+        if (s_it->second == shader)
+        {
+            shaders.erase(s_it);
+            break;
+        }
+    }
+    entries.erase(it);
+    delete shader;
+}
+
+void OpenGLShaderCache::clear()
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+        delete it->first;
+    entries.clear();
+    shaders.clear();
+    ++generation;
+}
@@ -2,12 +2,26 @@
 #define __OpenGL_Shader_Utilities_h__
 
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
 #include <iostream>
 
 #include <GLAD/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLStateCache.h"
+
+// GL_KHR_parallel_shader_compile (same values for ARB version)
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 class OpenGLShaderProgram;
 
 class OpenGLShaderSupportCheck
@@ -19,6 +33,10 @@ protected:
     bool geometry_shader_supported;
     bool tessellation_shader_supported;
     bool compute_shader_supported;
+    // GL_COMPLETION_STATUS_KHR can be polled
+    bool parallel_compile_supported;
+    // program pipelines, version >= 4.1 or GL_ARB_separate_shader_objects
+    bool separate_shader_objects_supported;
 
 public:
     OpenGLShaderSupportCheck();
@@ -29,11 +47,16 @@ public:
     inline bool support_geometry_shader() const { return geometry_shader_supported; }
     inline bool support_tessellation_shader() const { return tessellation_shader_supported; }
     inline bool support_compute_shader() const { return compute_shader_supported; }
+    inline bool support_parallel_compile() const { return parallel_compile_supported; }
+    inline bool support_separate_shader_objects() const { return separate_shader_objects_supported; }
+    // name listed by glGetStringi(GL_EXTENSIONS, i)
+    static bool has_extension(const char* name);
 };
 
 class OpenGLShader
 {
     friend class OpenGLShaderProgram;
+    friend class OpenGLProgramPipeline;
 public:
     enum ShaderType
     {
@@ -45,6 +68,8 @@ public:
         TessellationEvaluation = 4,
         Compute = 5
     };
+    // (name, value) pairs, "#define name value" after #version
+    typedef std::vector<std::pair<std::string, std::string>> Defines;
 
 protected:
     static const size_t type_num;
@@ -93,9 +118,26 @@ public:
     inline bool OpenGLShader::compile_code(const std::string& code, ShaderType type)
     { return compile_code(code.c_str(), type); }
 
-    bool compile_file(const char *filename, ShaderType type);
-    inline bool compile_file(const std::string& filename, ShaderType type)
-    { return compile_file(filename.c_str(), type); }
+    // file is preprocessed, see preprocess_file()
+    bool compile_file(const char *filename, ShaderType type,
+        const Defines* defines = nullptr);
+    inline bool compile_file(const std::string& filename, ShaderType type,
+        const Defines* defines = nullptr)
+    { return compile_file(filename.c_str(), type, defines); }
+
+    // whole file into code, false if it can't be read
+    static bool read_file(const char* filename, std::string& code);
+    // Resolve #include "name" relative to the including file, each file
+    // is included once. Defines are inserted after #version. #line
+    // directives keep line numbers, source string number of a file is
+    // its index in included_files (0 for filename).
+    static bool preprocess_file(const char* filename, const Defines* defines,
+        std::string& code, std::vector<std::string>* included_files = nullptr);
+
+    // start compiling without waiting for result,
+    // finish_compile() then blocks until it is done
+    bool submit_code(const char* code, ShaderType type);
+    bool finish_compile();
 
 protected: // compile and set log (if fails)
     bool compile(const char* code);
@@ -106,30 +148,181 @@ private: // no copy
 };
 
 
+// Compiled shaders shared by all programs, a stage used by many
+// programs (e.g. same vertex shader) is compiled once. Shaders are
+// looked up by type and hash of preprocessed code, which contains
+// the defines. Programs keep a reference until they are destroyed
+// or rebuilt, shader is deleted when the last one is released.
+// Shaders belong to the gl context, GlfwApp clears the cache before
+// its context is destroyed.
+class OpenGLShaderCache
+{
+protected:
+    struct Entry
+    {
+        uint64_t key;
+        std::string code;
+        size_t ref_num;
+    };
+    static std::unordered_map<const OpenGLShader*, Entry> entries;
+    static std::unordered_multimap<uint64_t, OpenGLShader*> shaders;
+    static bool enabled;
+    static size_t hit_num, miss_num;
+    // increased by clear(), references of earlier ones are stale
+    static uint32_t generation;
+
+    static uint64_t get_key(OpenGLShader::ShaderType type, const char* code);
+
+public:
+    // by default enabled, programs then attach shared shaders
+    static inline void set_enabled(bool enable) { enabled = enable; }
+    static inline bool is_enabled() { return enabled; }
+
+    // Shader compiled from code with a new reference, nullptr if it
+    // fails. With submit_only compile status isn't checked, see
+    // OpenGLShader::submit_code().
+    static OpenGLShader* acquire(OpenGLShader::ShaderType type,
+        const char* code, bool submit_only = false);
+    // reference acquired in generation, ignored if cache was cleared since
+    static void release(OpenGLShader* shader, uint32_t shader_generation);
+    // delete all shaders while their context is current, programs
+    // still referencing them drop the references when destroyed
+    static void clear();
+    static inline uint32_t get_generation() { return generation; }
+
+    static inline size_t get_shader_num() { return entries.size(); }
+    static inline size_t get_hit_num() { return hit_num; }
+    static inline size_t get_miss_num() { return miss_num; }
+};
+
+
+// member of std140 uniform block, offset in the CPU side struct
+struct UniformBlockMember
+{
+    const char* name;
+    // e.g. GL_FLOAT_MAT4
+    GLenum type;
+    size_t offset;
+};
+
+// CPU side struct of uniform block and its binding point
+struct UniformBlockLayout
+{
+    const char* name;
+    GLuint binding;
+    size_t size;
+    const UniformBlockMember* members;
+    size_t member_num;
+};
+
+
 class OpenGLShaderProgram
 {
+public:
+    // active uniform found by link()
+    struct UniformInfo
+    {
+        std::string name;
+        GLint location;
+        GLenum type;
+        // number of array elements from this one
+        GLint size;
+    };
+
+    // uniform location resolved once, e.g. in init()
+    //   Uniform<glm::mat4> proj_mat_loc = shader.get_uniform<glm::mat4>("proj_mat");
+    // and set every frame without name lookup
+    //   shader.set_uniform(proj_mat_loc, proj_mat);
+    template <typename T>
+    class Uniform
+    {
+    protected:
+        GLint location;
+
+    public:
+        typedef T ValueType;
+
+        Uniform() : location(-1) {}
+        explicit Uniform(GLint loc) : location(loc) {}
+
+        inline GLint get_location() const { return location; }
+        inline bool is_valid() const { return location != -1; }
+    };
+
 protected:
     GLuint program_id;
     bool linked_already;
+    bool separable;
     std::string log;
 
+    // sorted by name, array "a[0]" is also listed as "a", "a[1]", ...
+    std::vector<UniformInfo> uniforms;
+    void cache_uniforms();
+
+    // blocks bound by every program linked afterwards
+    static std::vector<UniformBlockLayout> shared_blocks;
+    bool bind_shared_blocks();
+
+    // state of create_async_from_code()
+    bool building;
+    bool poll_completion;
+    std::string build_binary_filename;
+    uint64_t build_binary_key;
+    bool finish_link();
+    // before link, gl 3.3 has no glProgramParameteri
+    inline void set_separable_parameter()
+    {
+        if (glProgramParameteri)
+            glProgramParameteri(program_id, GL_PROGRAM_SEPARABLE, separable ? GL_TRUE : GL_FALSE);
+    }
+
+    // program binaries are cached in this directory if not empty
+    static std::string binary_cache_dir;
+    // hash of shader types, codes, separable flag and driver strings
+    uint64_t get_binary_key(const OpenGLShader::ShaderType* types,
+        const char* const* codes, size_t num) const;
+    // file named by key
+    static std::string get_binary_filename(uint64_t key);
+    // false if missing, truncated, written for another key or rejected
+    // by driver, then compile from source
+    bool load_binary(const std::string& filename, uint64_t key);
+    bool save_binary(const std::string& filename, uint64_t key);
+
+    // filenames of codes for compile errors, may be null
+    bool create_from_code(const OpenGLShader::ShaderType* types, const char* const* codes,
+        size_t num, const char* const* filenames);
+
     // shaders
     struct ShaderPointer
     {
         OpenGLShader *shader;
         // whether the shader is allocated on heap
         bool is_internal;
-        inline void init() { shader = nullptr; is_internal = false; }
+        // whether the shader is referenced in OpenGLShaderCache
+        bool is_cached;
+        uint32_t cache_generation;
+        inline void init() { shader = nullptr; is_internal = false; is_cached = false; cache_generation = 0; }
         inline void clear()
         {
             if (shader)
             {
-                if (is_internal)
+                if (is_cached)
+                    OpenGLShaderCache::release(shader, cache_generation);
+                else if (is_internal)
                     delete shader;
                 shader = nullptr;
                 is_internal = false;
+                is_cached = false;
             }
         }
+        inline void set(OpenGLShader* sh, bool cached)
+        {
+            clear();
+            shader = sh;
+            is_internal = !cached;
+            is_cached = cached;
+            cache_generation = OpenGLShaderCache::get_generation();
+        }
         inline bool is_valid()
         {
             return shader && shader->get_id() &&
@@ -175,18 +368,47 @@ public:
     // Initialize vertex and fragment shaders from files
     bool create(const char* shd_vert_filename,
                 const char* shd_frag_filename);
+    // compile and link shaders of given types, load program binary
+    // instead if it is cached for the same codes and driver
+    bool create_from_files(const ShaderType* types,
+        const char* const* filenames, size_t num,
+        const OpenGLShader::Defines* defines = nullptr);
+    bool create_from_code(const ShaderType* types,
+        const char* const* codes, size_t num);
+
+    // e.g. "../../ShaderCache", directory must exist, empty disables
+    static inline void set_binary_cache_dir(const char* dir)
+    { binary_cache_dir = dir ? dir : ""; }
+    static inline const std::string& get_binary_cache_dir() { return binary_cache_dir; }
+    // glProgramBinary available with at least one binary format
+    static bool support_program_binary();
 
     inline GLuint get_id() const { return program_id; }
     inline bool is_linked() const { return linked_already; };
+
+    // Set before build, stages of a separable program are combined
+    // with other programs in OpenGLProgramPipeline instead of being
+    // linked together, see OpenGLShaderSupportCheck.
+    inline void set_separable(bool enable) { separable = enable; }
+    inline bool is_separable() const { return separable; }
+    // single stage separable program
+    inline bool create_separable(ShaderType type, const char* filename,
+        const OpenGLShader::Defines* defines = nullptr)
+    {
+        separable = true;
+        return create_from_files(&type, &filename, 1, defines);
+    }
     inline const std::string &get_log() const { return log; }
 
     bool add_shader(OpenGLShader &shader);
     bool add_shader_from_code(ShaderType type, const char* code);
     inline bool add_shader_from_code(ShaderType type, const std::string &code)
     { return add_shader_from_code(type, code.c_str()); }
-    bool add_shader_from_file(ShaderType type, const char *filename);
-    inline bool add_shader_from_file(ShaderType type, const std::string &filename)
-    { return add_shader_from_file(type, filename.c_str()); }
+    bool add_shader_from_file(ShaderType type, const char *filename,
+        const OpenGLShader::Defines* defines = nullptr);
+    inline bool add_shader_from_file(ShaderType type, const std::string &filename,
+        const OpenGLShader::Defines* defines = nullptr)
+    { return add_shader_from_file(type, filename.c_str(), defines); }
     
     inline void del_shader(ShaderType type)
     {
@@ -202,19 +424,44 @@ public:
         shader_eva.clear();
         shader_comp.clear();
     }
+    // shaders of other programs are kept for reuse
+    inline void del_uncached_shaders()
+    {
+        for (size_t s_id = 0; s_id < OpenGLShader::type_num; ++s_id)
+        {
+            if (!shader_ptr[s_id].is_cached)
+                shader_ptr[s_id].clear();
+        }
+    }
     
     bool link();
 
+    // Asynchronous build, e.g. for many programs:
+    //   for each program: create_async_from_files(...)
+    //   each frame: draw loading screen until every poll_build() is true
+    // All shaders and the link are submitted without status queries.
+    // With GL_KHR_parallel_shader_compile the driver builds on its own
+    // threads and poll_build() doesn't block, else it waits at first poll.
+    // Binary cache is used as in create_from_code().
+    bool create_async_from_files(const ShaderType* types,
+        const char* const* filenames, size_t num,
+        const OpenGLShader::Defines* defines = nullptr);
+    bool create_async_from_code(const ShaderType* types,
+        const char* const* codes, size_t num);
+    // true when build is finished, check is_linked() for result
+    bool poll_build();
+    inline bool is_building() const { return building; }
+
     inline bool use()
     {
         if (program_id && linked_already)
         {
-            glUseProgram(program_id);
+            GLStateCache::get().use_program(program_id);
             return true;
         }
         return false;
     }
-    inline void unuse() { glUseProgram(0); }
+    inline void unuse() { GLStateCache::get().use_program(0); }
 
     // Attribute array pointer
     inline void bind_attr_loc(const char* name, GLint location)
@@ -392,15 +639,47 @@ public:
     }
     
     // Uniform variables
+    // active uniforms of linked program, nullptr if name not found
+    const UniformInfo* find_uniform(const char* name) const;
+    inline const std::vector<UniformInfo>& get_uniforms() const { return uniforms; }
+
+    // Set binding point of block and check offsets and types of its
+    // members against layout, false if block is missing or differs.
+    bool bind_uniform_block(const UniformBlockLayout& layout);
+    inline bool has_uniform_block(const char* name) const
+    { return program_id && glGetUniformBlockIndex(program_id, name) != GL_INVALID_INDEX; }
+    // programs linked afterwards bind the block if they use it,
+    // replaces layout of the same name
+    static void add_shared_uniform_block(const UniformBlockLayout& layout);
+
+    // looked up in cache filled by link(), no gl query
     inline int uniform_loc(const char* name) const
     {
-        if (program_id && linked_already)
-            return glGetUniformLocation(program_id, name);
-        return -1;
+        const UniformInfo* info = find_uniform(name);
+        return info ? info->location : -1;
     }
     inline int uniform_loc(const std::string &name) const
     {
-        uniform_loc(name.c_str());
+        return uniform_loc(name.c_str());
+    }
+
+    // invalid handle if name is not an active uniform
+    template <typename T>
+    inline Uniform<T> get_uniform(const char* name) const
+    {
+        return Uniform<T>(uniform_loc(name));
+    }
+    template <typename T>
+    inline void set_uniform(const Uniform<T>& uniform, const typename Uniform<T>::ValueType& value)
+    {
+        if (uniform.is_valid())
+            set_uniform(uniform.get_location(), value);
+    }
+    template <typename T>
+    inline void set_uniforms(const Uniform<T>& uniform, const typename Uniform<T>::ValueType* values, GLsizei count)
+    {
+        if (uniform.is_valid())
+            set_uniforms(uniform.get_location(), values, count);
     }
 
     inline void set_uniform(GLint location, GLfloat value)
@@ -835,4 +1114,152 @@ private: // no copy
     OpenGLShaderProgram& operator=(const OpenGLShaderProgram& other) = delete;
 };
 
+
+// Stages of separable programs combined at draw time, e.g. vertex
+// programs per vertex format with fragment programs per material
+// need one link per program instead of one per combination:
+//   vert.create_separable(OpenGLShader::Vertex, "mesh.vert");
+//   frag.create_separable(OpenGLShader::Fragment, "material.frag");
+//   pipeline.create();
+//   pipeline.set_stage(OpenGLShader::Vertex, &vert);
+//   pipeline.set_stage(OpenGLShader::Fragment, &frag);
+//   pipeline.bind();
+// Uniforms are set with glProgramUniform* or, after
+// set_active_program(), with set_uniform() of the program.
+class OpenGLProgramPipeline
+{
+protected:
+    GLuint pipeline_id;
+    std::string log;
+
+public:
+    typedef OpenGLShader::ShaderType ShaderType;
+
+    OpenGLProgramPipeline() : pipeline_id(0) {}
+    ~OpenGLProgramPipeline() { destroy(); }
+
+    bool create();
+    void destroy();
+
+    // e.g. GL_VERTEX_SHADER_BIT of Vertex
+    static GLbitfield get_stage_bit(ShaderType type);
+    // stage of type is taken from program, nullptr clears it
+    bool set_stage(ShaderType type, const OpenGLShaderProgram* program);
+    // checks stage interfaces, result is in get_log()
+    bool validate();
+
+    // unuses current program
+    inline void bind() const { GLStateCache::get().bind_program_pipeline(pipeline_id); }
+    // target of glUniform*, i.e. set_uniform() of program
+    inline void set_active_program(const OpenGLShaderProgram& program)
+    {
+        glActiveShaderProgram(pipeline_id, program.get_id());
+    }
+
+    inline GLuint get_id() const { return pipeline_id; }
+    inline const std::string& get_log() const { return log; }
+
+private: // no copy
+    OpenGLProgramPipeline(const OpenGLProgramPipeline& other) = delete;
+    OpenGLProgramPipeline& operator=(const OpenGLProgramPipeline& other) = delete;
+};
+
+
+// Buffer of a uniform block, e.g. frame constants uploaded once per
+// frame and read by every program declaring the block:
+//   init():  frame_ubo.create(FrameData::layout); then create programs
+//   paint(): frame_ubo.update(frame_data);
+// create() registers layout as shared block of OpenGLShaderProgram.
+class OpenGLUniformBuffer
+{
+protected:
+    GLuint buffer_id;
+    GLuint binding;
+    size_t size;
+
+public:
+    OpenGLUniformBuffer() : buffer_id(0), binding(0), size(0) {}
+    ~OpenGLUniformBuffer() { destroy(); }
+
+    bool create(const UniformBlockLayout& layout);
+    void destroy();
+
+    // upload whole block, buffer is orphaned so that draws of the
+    // last frame don't stall, and bound to its binding point
+    void update(const void* data);
+    template <typename T>
+    inline void update(const T& data) { update(static_cast<const void*>(&data)); }
+    inline void bind() const { GLStateCache::get().bind_buffer_base(GL_UNIFORM_BUFFER, binding, buffer_id); }
+
+    inline GLuint get_id() const { return buffer_id; }
+    inline GLuint get_binding() const { return binding; }
+    inline size_t get_size() const { return size; }
+
+private: // no copy
+    OpenGLUniformBuffer(const OpenGLUniformBuffer& other) = delete;
+    OpenGLUniformBuffer& operator=(const OpenGLUniformBuffer& other) = delete;
+};
+
+// Per frame constants, block FrameData of Shaders/frame_data.glsl.
+// Members follow std140: mat4 and vec4 are 16 bytes aligned.
+struct FrameData
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    // x, y, width, height
+    glm::vec4 viewport;
+    // seconds
+    float time;
+    float padding[3];
+
+    static const UniformBlockMember members[4];
+    static const UniformBlockLayout layout;
+};
+static_assert(sizeof(FrameData) == 160, "FrameData doesn't match std140 layout");
+
+// Permutations of a program specialised with preprocessor defines.
+// Bit i of variant key defines define_names[i] as 1 in every stage:
+//   const char* names[] = { "HAS_DIFFUSE_MAP", "HAS_NORMAL_MAP" };
+//   variants.init("mesh.vert", "mesh.frag", names, 2);
+//   OpenGLShaderProgram* prog = variants.get(HasNormalMap);
+// Variants are built when first requested and kept until clear().
+class OpenGLShaderVariants
+{
+public:
+    typedef uint32_t Key;
+    static const size_t max_define_num = 32;
+
+protected:
+    std::vector<OpenGLShader::ShaderType> types;
+    std::vector<std::string> filenames;
+    std::vector<std::string> define_names;
+    // nullptr if build failed, not rebuilt
+    std::unordered_map<Key, OpenGLShaderProgram*> programs;
+
+public:
+    OpenGLShaderVariants() {}
+    ~OpenGLShaderVariants() { clear(); }
+    void clear();
+
+    int init(const OpenGLShader::ShaderType* types,
+        const char* const* filenames, size_t num,
+        const char* const* define_names, size_t define_num);
+    inline int init(const char* vert_filename, const char* frag_filename,
+        const char* const* define_names, size_t define_num)
+    {
+        const OpenGLShader::ShaderType stage_types[2] = { OpenGLShader::Vertex, OpenGLShader::Fragment };
+        const char* stage_filenames[2] = { vert_filename, frag_filename };
+        return init(stage_types, stage_filenames, 2, define_names, define_num);
+    }
+
+    // build variant on first request, nullptr if it fails
+    OpenGLShaderProgram* get(Key key);
+    inline size_t get_variant_num() const { return programs.size(); }
+    inline size_t get_define_num() const { return define_names.size(); }
+
+private: // no copy
+    OpenGLShaderVariants(const OpenGLShaderVariants& other) = delete;
+    OpenGLShaderVariants& operator=(const OpenGLShaderVariants& other) = delete;
+};
+
 #endif
\ No newline at end of file
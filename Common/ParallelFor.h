@@ -0,0 +1,37 @@
+#ifndef __Parallel_For_h__
+#define __Parallel_For_h__
+
+#include <thread>
+#include <vector>
+
+inline size_t get_default_thread_num()
+{
+    size_t thread_num = std::thread::hardware_concurrency();
+    return thread_num ? thread_num : 1;
+}
+
+// Split [0, num) into thread_num contiguous ranges and call
+// func(thread_id, begin, end) for each range on its own thread.
+// The calling thread runs the first range.
+template <typename Func>
+void parallel_for(size_t num, size_t thread_num, Func func)
+{
+    if (thread_num == 0)
+        thread_num = get_default_thread_num();
+    if (thread_num > num)
+        thread_num = num ? num : 1;
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_num - 1);
+    for (size_t th_id = 1; th_id < thread_num; ++th_id)
+    {
+        size_t begin = num * th_id / thread_num;
+        size_t end = num * (th_id + 1) / thread_num;
+        threads.emplace_back(func, th_id, begin, end);
+    }
+    func(size_t(0), size_t(0), num / thread_num);
+    for (size_t th_id = 0; th_id < threads.size(); ++th_id)
+        threads[th_id].join();
+}
+
+#endif
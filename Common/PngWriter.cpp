@@ -0,0 +1,125 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "PngWriter.h"
+
+namespace
+{
+    uint32_t crc_table[256];
+    bool crc_table_ready = false;
+
+    void init_crc_table()
+    {
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            crc_table[n] = c;
+        }
+        crc_table_ready = true;
+    }
+
+    uint32_t update_crc(uint32_t crc, const unsigned char* buf, size_t len)
+    {
+        for (size_t i = 0; i < len; ++i)
+            crc = crc_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+        return crc;
+    }
+
+    inline void push_u32(std::vector<unsigned char>& buf, uint32_t v)
+    {
+        buf.push_back((unsigned char)(v >> 24));
+        buf.push_back((unsigned char)(v >> 16));
+        buf.push_back((unsigned char)(v >> 8));
+        buf.push_back((unsigned char)v);
+    }
+
+    // length, type, data, crc of type and data
+    void write_chunk(std::ofstream& file, const char* type,
+        const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> chunk;
+        chunk.reserve(data.size() + 12);
+        push_u32(chunk, uint32_t(data.size()));
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        uint32_t crc = update_crc(0xFFFFFFFFU, &chunk[4], data.size() + 4) ^ 0xFFFFFFFFU;
+        push_u32(chunk, crc);
+        file.write((const char*)&chunk[0], std::streamsize(chunk.size()));
+    }
+}
+
+int write_png(const char* filename,
+    int width, int height, int channel_num,
+    const unsigned char* data, bool flip_y)
+{
+    static const unsigned char color_types[5] = { 0, 0, 4, 2, 6 };
+    if (!data || width <= 0 || height <= 0 || channel_num < 1 || channel_num > 4)
+        return -1;
+    if (!crc_table_ready)
+        init_crc_table();
+
+    // filter type 0 byte before each row
+    const size_t row_size = size_t(width) * size_t(channel_num);
+    std::vector<unsigned char> raw;
+    raw.reserve((row_size + 1) * size_t(height));
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char* row = data + row_size * size_t(flip_y ? height - 1 - y : y);
+        raw.push_back(0);
+        raw.insert(raw.end(), row, row + row_size);
+    }
+
+    // zlib stream of stored blocks
+    std::vector<unsigned char> idat;
+    idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    size_t pos = 0;
+    do
+    {
+        size_t len = raw.size() - pos;
+        if (len > 65535)
+            len = 65535;
+        idat.push_back(pos + len == raw.size() ? 1 : 0);
+        idat.push_back((unsigned char)len);
+        idat.push_back((unsigned char)(len >> 8));
+        idat.push_back((unsigned char)~len);
+        idat.push_back((unsigned char)(~len >> 8));
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    push_u32(idat, (b << 16) | a);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Can't open png file " << filename << ".\n";
+        return -1;
+    }
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write((const char*)signature, 8);
+
+    std::vector<unsigned char> ihdr;
+    push_u32(ihdr, uint32_t(width));
+    push_u32(ihdr, uint32_t(height));
+    ihdr.push_back(8); // bit depth
+    ihdr.push_back(color_types[channel_num]);
+    ihdr.push_back(0); // deflate
+    ihdr.push_back(0); // adaptive filtering
+    ihdr.push_back(0); // no interlace
+    write_chunk(file, "IHDR", ihdr);
+    write_chunk(file, "IDAT", idat);
+    write_chunk(file, "IEND", std::vector<unsigned char>());
+
+    return file.good() ? 0 : -1;
+}
@@ -0,0 +1,15 @@
+#ifndef __Png_Writer_h__
+#define __Png_Writer_h__
+
+#include <cstddef>
+
+// Write 8 bit gray, gray alpha, RGB or RGBA image as PNG.
+// Pixel data is stored uncompressed (deflate stored blocks),
+// no zlib needed. Rows are top to bottom unless flip_y is set,
+// which matches glReadPixels output.
+// return 0 if success, -1 if fails
+int write_png(const char* filename,
+    int width, int height, int channel_num,
+    const unsigned char* data, bool flip_y = false);
+
+#endif
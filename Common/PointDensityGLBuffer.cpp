@@ -0,0 +1,220 @@
+#include <math.h>
+#include <algorithm>
+
+#include "ParallelFor.h"
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
+
+#include "PointDensityGLBuffer.h"
+
+PointDensityGLBuffer::PointDensityGLBuffer() :
+	thread_num(0), res_x(0), res_y(0), max_count(0.0f),
+	vao(0), density_tex(0), color_map_tex(0)
+{
+
+}
+
+PointDensityGLBuffer::~PointDensityGLBuffer() { clear(); }
+
+void PointDensityGLBuffer::clear()
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	if (vao)
+	{
+		gl_state.delete_vertex_arrays(1, &vao);
+		vao = 0;
+	}
+	if (density_tex)
+	{
+		gl_state.delete_textures(1, &density_tex);
+		density_tex = 0;
+	}
+	if (color_map_tex)
+	{
+		gl_state.delete_textures(1, &color_map_tex);
+		color_map_tex = 0;
+	}
+	res_x = 0;
+	res_y = 0;
+	max_count = 0.0f;
+	density.clear();
+	th_hists.clear();
+}
+
+int PointDensityGLBuffer::init(int rx, int ry)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	clear();
+
+	glGenVertexArrays(1, &vao);
+
+	// black, blue, red, yellow, white
+	const float keys[5][3] = {
+		{ 0.0f, 0.0f, 0.0f },
+		{ 0.1f, 0.1f, 0.8f },
+		{ 0.9f, 0.1f, 0.2f },
+		{ 1.0f, 0.9f, 0.1f },
+		{ 1.0f, 1.0f, 1.0f }
+	};
+	unsigned char color_map_data[256][3];
+	for (size_t i = 0; i < 256; ++i)
+	{
+		float t = float(i) / 255.0f * 4.0f;
+		size_t k = size_t(t);
+		if (k > 3)
+			k = 3;
+		t -= float(k);
+		for (size_t c = 0; c < 3; ++c)
+			color_map_data[i][c] = (unsigned char)(
+				255.0f * (keys[k][c] * (1.0f - t) + keys[k + 1][c] * t) + 0.5f);
+	}
+	glGenTextures(1, &color_map_tex);
+	gl_state.bind_texture(GL_TEXTURE_1D, color_map_tex);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, 256, 0, GL_RGB, GL_UNSIGNED_BYTE, color_map_data);
+	gl_state.bind_texture(GL_TEXTURE_1D, 0);
+
+	glGenTextures(1, &density_tex);
+	gl_state.bind_texture(GL_TEXTURE_2D, density_tex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl_state.bind_texture(GL_TEXTURE_2D, 0);
+
+	return resize(rx, ry);
+}
+
+int PointDensityGLBuffer::resize(int rx, int ry)
+{
+	if (!density_tex || rx <= 0 || ry <= 0)
+		return -1;
+	if (rx == res_x && ry == res_y)
+		return 0;
+
+	res_x = rx;
+	res_y = ry;
+	density.assign(size_t(res_x) * size_t(res_y), 0.0f);
+	max_count = 0.0f;
+	GLStateCache::get().bind_texture(GL_TEXTURE_2D, density_tex);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, res_x, res_y, 0, GL_RED, GL_FLOAT, &density[0]);
+	GLStateCache::get().bind_texture(GL_TEXTURE_2D, 0);
+	return 0;
+}
+
+int PointDensityGLBuffer::update(
+	const glm::vec2 *pts, size_t pt_num,
+	double xl, double xu, double yl, double yu)
+{
+	std::vector<std::pair<size_t, size_t> > ranges;
+	ranges.push_back(std::make_pair(size_t(0), pt_num));
+	bin_points(pts, ranges, xl, xu, yl, yu);
+	return 0;
+}
+
+void PointDensityGLBuffer::bin_points(
+	const glm::vec2 *pts,
+	const std::vector<std::pair<size_t, size_t> > &ranges,
+	double xl, double xu, double yl, double yu)
+{
+	if (density.empty() || xu <= xl || yu <= yl)
+		return;
+	FrameProfiler::Scope scope(FrameProfiler::get_cur_profiler(), "density_upload");
+
+	// offsets of ranges in the concatenated point list
+	std::vector<size_t> offsets(ranges.size() + 1);
+	offsets[0] = 0;
+	for (size_t r_id = 0; r_id < ranges.size(); ++r_id)
+		offsets[r_id + 1] = offsets[r_id] + ranges[r_id].second;
+	const size_t pt_num = offsets.back();
+
+	// a thread per pixel count of points keeps merging cheap
+	const size_t cell_num = density.size();
+	size_t th_num = thread_num ? thread_num : get_default_thread_num();
+	if (th_num > pt_num / cell_num)
+		th_num = pt_num / cell_num;
+	if (th_num == 0)
+		th_num = 1;
+	th_hists.assign(th_num * cell_num, 0);
+
+	const double sx = double(res_x) / (xu - xl);
+	const double sy = double(res_y) / (yu - yl);
+	parallel_for(pt_num, th_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		if (begin >= end)
+			return;
+		uint32_t *hist = &th_hists[th_id * cell_num];
+		size_t r_id = size_t(std::upper_bound(offsets.begin(), offsets.end(), begin)
+			- offsets.begin()) - 1;
+		size_t p_id = ranges[r_id].first + (begin - offsets[r_id]);
+		size_t r_end = offsets[r_id + 1];
+		for (size_t i = begin; i < end; ++i, ++p_id)
+		{
+			while (i >= r_end)
+			{
+				++r_id;
+				p_id = ranges[r_id].first;
+				r_end = offsets[r_id + 1];
+			}
+			const glm::vec2 &p = pts[p_id];
+			double x = (double(p.x) - xl) * sx;
+			double y = (double(p.y) - yl) * sy;
+			if (x < 0.0 || y < 0.0 || x >= double(res_x) || y >= double(res_y))
+				continue;
+			++hist[size_t(y) * size_t(res_x) + size_t(x)];
+		}
+	});
+
+	// merge thread histograms
+	std::vector<float> th_max_counts(
+		thread_num ? thread_num : get_default_thread_num(), 0.0f);
+	parallel_for(cell_num, th_max_counts.size(),
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		float th_max = 0.0f;
+		for (size_t c_id = begin; c_id < end; ++c_id)
+		{
+			uint32_t count = 0;
+			for (size_t h_id = 0; h_id < th_num; ++h_id)
+				count += th_hists[h_id * cell_num + c_id];
+			density[c_id] = float(count);
+			if (th_max < density[c_id])
+				th_max = density[c_id];
+		}
+		th_max_counts[th_id] = th_max;
+	});
+	max_count = 0.0f;
+	for (size_t th_id = 0; th_id < th_max_counts.size(); ++th_id)
+		max_count = std::max(max_count, th_max_counts[th_id]);
+
+	GLStateCache::get().bind_texture(GL_TEXTURE_2D, density_tex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, res_x, res_y, GL_RED, GL_FLOAT, &density[0]);
+	GLStateCache::get().bind_texture(GL_TEXTURE_2D, 0);
+}
+
+void PointDensityGLBuffer::draw(OpenGLShaderProgram& shader)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	if (!vao || density.empty())
+		return;
+
+	gl_state.active_texture(GL_TEXTURE0);
+	gl_state.bind_texture(GL_TEXTURE_2D, density_tex);
+	gl_state.active_texture(GL_TEXTURE1);
+	gl_state.bind_texture(GL_TEXTURE_1D, color_map_tex);
+	shader.set_uniform("density_map", GLint(0));
+	shader.set_uniform("color_map", GLint(1));
+	// log scale so that sparse regions stay visible
+	shader.set_uniform("log_max_count", GLfloat(log(1.0 + double(max_count))));
+
+	// bindings are kept, next frame skips them
+	gl_state.bind_vertex_array(vao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
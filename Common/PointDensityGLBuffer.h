@@ -0,0 +1,75 @@
+#ifndef __Point_Density_GL_Buffer_h__
+#define __Point_Density_GL_Buffer_h__
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "OpenGLShaderUtilities.h"
+
+// Heatmap of point counts per screen pixel, for point sets
+// much denser than the framebuffer. Points are binned on cpu
+// in parallel into an R32F texture, which is drawn as a full
+// screen quad through a 1D colour map (point_density shaders).
+// Cost of drawing only depends on the resolution.
+class PointDensityGLBuffer
+{
+protected:
+	size_t thread_num;
+
+	int res_x, res_y;
+	// point counts, row 0 at yl
+	std::vector<GLfloat> density;
+	float max_count;
+	// per thread histograms
+	std::vector<uint32_t> th_hists;
+
+	// empty vao, quad corners come from gl_VertexID
+	GLuint vao;
+	GLuint density_tex, color_map_tex;
+
+	// ranges of (first, num)
+	void bin_points(const glm::vec2 *pts,
+		const std::vector<std::pair<size_t, size_t> > &ranges,
+		double xl, double xu, double yl, double yu);
+
+public:
+	PointDensityGLBuffer();
+	~PointDensityGLBuffer();
+	void clear();
+
+	// 0 means hardware concurrency
+	inline void set_thread_num(size_t num) { thread_num = num; }
+
+	// resolution should match the viewport in pixels
+	int init(int res_x, int res_y);
+	int resize(int res_x, int res_y);
+	inline int get_res_x() const { return res_x; }
+	inline int get_res_y() const { return res_y; }
+	inline float get_max_count() const { return max_count; }
+	inline const std::vector<GLfloat> &get_density() const { return density; }
+
+	// count points inside rect and upload texture
+	int update(const glm::vec2 *pts, size_t pt_num,
+		double xl, double xu, double yl, double yu);
+	// only points [first, first + num) of each range,
+	// Range has members first and num (e.g. PointQuadtree::Range)
+	template <typename Range>
+	int update_ranges(const glm::vec2 *pts, const Range *ranges, size_t range_num,
+		double xl, double xu, double yl, double yu)
+	{
+		std::vector<std::pair<size_t, size_t> > pt_ranges(range_num);
+		for (size_t r_id = 0; r_id < range_num; ++r_id)
+			pt_ranges[r_id] = std::make_pair(size_t(ranges[r_id].first), size_t(ranges[r_id].num));
+		bin_points(pts, pt_ranges, xl, xu, yl, yu);
+		return 0;
+	}
+
+	// shader should be in use, uses texture unit 0 and 1
+	void draw(OpenGLShaderProgram &shader);
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef __Spsc_Queue_h__
+#define __Spsc_Queue_h__
+
+#include <atomic>
+#include <vector>
+
+// Bounded lock-free queue for one producer thread and one consumer
+// thread. push() is only called by the producer, pop() only by the
+// consumer. Capacity is rounded up to power of 2.
+template <typename T>
+class SpscQueue
+{
+protected:
+    std::vector<T> items;
+    size_t mask;
+    // head and tail only grow, index of item is count & mask
+    // next item to pop, written by consumer
+    alignas(64) std::atomic<size_t> head;
+    // next slot to push, written by producer
+    alignas(64) std::atomic<size_t> tail;
+
+public:
+    explicit SpscQueue(size_t capacity = 1024) : head(0), tail(0)
+    {
+        size_t cap = 1;
+        while (cap < capacity)
+            cap <<= 1;
+        items.resize(cap);
+        mask = cap - 1;
+    }
+
+    // return false if queue is full
+    bool push(const T& item)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == items.size())
+            return false;
+        items[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // return false if queue is empty
+    bool pop(T& item)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate if the other thread is running
+    inline bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    inline size_t size() const
+    {
+        // head first, tail read later is never smaller
+        const size_t h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+    inline size_t capacity() const { return items.size(); }
+
+private:
+    // no copy
+    SpscQueue(const SpscQueue& other) = delete;
+    SpscQueue& operator=(const SpscQueue& other) = delete;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include <iostream>
+
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
+#include "StreamGLBuffer.h"
+
+StreamGLBuffer::StreamGLBuffer() :
+	target(GL_ARRAY_BUFFER), buf_id(0),
+	region_size(0), region_num(0), cur_region(0),
+	is_persistent(false), mapped_data(nullptr)
+{
+	for (size_t r_id = 0; r_id < max_region_num; ++r_id)
+		fences[r_id] = nullptr;
+}
+
+void StreamGLBuffer::clear()
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	for (size_t r_id = 0; r_id < max_region_num; ++r_id)
+	{
+		if (fences[r_id])
+		{
+			glDeleteSync(fences[r_id]);
+			fences[r_id] = nullptr;
+		}
+	}
+	if (buf_id)
+	{
+		if (mapped_data)
+		{
+			gl_state.bind_buffer(target, buf_id);
+			glUnmapBuffer(target);
+			gl_state.bind_buffer(target, 0);
+			mapped_data = nullptr;
+		}
+		gl_state.delete_buffers(1, &buf_id);
+		buf_id = 0;
+	}
+	region_size = 0;
+	region_num = 0;
+	cur_region = 0;
+	is_persistent = false;
+}
+
+int StreamGLBuffer::init(GLenum _target, size_t _region_size,
+	size_t _region_num, bool force_orphaning)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	clear();
+	if (_region_size == 0 || _region_num == 0 || _region_num > max_region_num)
+	{
+		std::cout << "StreamGLBuffer: Invalid region size or number.\n";
+		return -1;
+	}
+
+	target = _target;
+	region_size = _region_size;
+	GLint major_version = 0, minor_version = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+	glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+	is_persistent = !force_orphaning &&
+		(major_version > 4 || (major_version == 4 && minor_version >= 4));
+
+	glGenBuffers(1, &buf_id);
+	gl_state.bind_buffer(target, buf_id);
+	if (is_persistent)
+	{
+		region_num = _region_num;
+		const GLbitfield flags = GL_MAP_WRITE_BIT
+							   | GL_MAP_PERSISTENT_BIT
+							   | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, region_size * region_num, nullptr, flags);
+		mapped_data = (char *)glMapBufferRange(target, 0,
+			region_size * region_num, flags);
+		if (!mapped_data)
+		{
+			std::cout << "StreamGLBuffer: Can't map buffer persistently.\n";
+			gl_state.bind_buffer(target, 0);
+			clear();
+			return -1;
+		}
+	}
+	else
+	{
+		region_num = 1;
+		glBufferData(target, region_size, nullptr, GL_STREAM_DRAW);
+	}
+	gl_state.bind_buffer(target, 0);
+	// first map_region() starts at region 0
+	cur_region = region_num - 1;
+	return 0;
+}
+
+void *StreamGLBuffer::map_region()
+{
+	if (!buf_id)
+		return nullptr;
+	// includes waiting for the gpu to release the region
+	FrameProfiler::Scope scope(FrameProfiler::get_cur_profiler(), "stream_map");
+
+	cur_region = (cur_region + 1) % region_num;
+	if (is_persistent)
+	{
+		GLsync &fence = fences[cur_region];
+		if (fence)
+		{
+			// flush once, the fence may not be submitted yet
+			GLbitfield wait_flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			for (;;)
+			{
+				GLenum res = glClientWaitSync(fence, wait_flags, 1000000000);
+				if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED ||
+					res == GL_WAIT_FAILED)
+					break;
+				wait_flags = 0;
+			}
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+		return mapped_data + region_size * cur_region;
+	}
+
+	// orphan old storage so the driver does not wait for the gpu
+	GLStateCache::get().bind_buffer(target, buf_id);
+	glBufferData(target, region_size, nullptr, GL_STREAM_DRAW);
+	void *data = glMapBufferRange(target, 0, region_size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	GLStateCache::get().bind_buffer(target, 0);
+	return data;
+}
+
+size_t StreamGLBuffer::unmap_region()
+{
+	if (!buf_id)
+		return 0;
+	if (is_persistent)
+		return region_size * cur_region;
+
+	FrameProfiler::Scope scope(FrameProfiler::get_cur_profiler(), "stream_unmap");
+	GLStateCache::get().bind_buffer(target, buf_id);
+	glUnmapBuffer(target);
+	GLStateCache::get().bind_buffer(target, 0);
+	return 0;
+}
+
+void StreamGLBuffer::fence_region()
+{
+	if (!is_persistent)
+		return;
+	GLsync &fence = fences[cur_region];
+	if (fence)
+		glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,62 @@
+#ifndef __Stream_GL_Buffer_h__
+#define __Stream_GL_Buffer_h__
+
+#include <glad/glad.h>
+
+// Ring of buffer regions rewritten every frame.
+// On OpenGL 4.4 the buffer is allocated with glBufferStorage and
+// mapped once (persistent, coherent). Each region is guarded by a
+// fence so the cpu never writes a region the gpu is still reading.
+// On older context it falls back to orphaning a single region with
+// glBufferData, letting the driver rename the storage.
+// Usage per frame:
+//   void *data = buf.map_region();  // write region_size bytes
+//   size_t offset = buf.unmap_region();
+//   draw with data at offset
+//   buf.fence_region();
+class StreamGLBuffer
+{
+public:
+	static const size_t max_region_num = 4;
+
+protected:
+	GLenum target;
+	GLuint buf_id;
+	size_t region_size;
+	size_t region_num;
+	size_t cur_region;
+	bool is_persistent;
+	// whole buffer if persistent
+	char *mapped_data;
+	GLsync fences[max_region_num];
+
+public:
+	StreamGLBuffer();
+	~StreamGLBuffer() { clear(); }
+	void clear();
+
+	// region_num is 3 for triple buffering,
+	// force_orphaning is for testing the fallback path
+	int init(GLenum _target, size_t _region_size,
+		size_t _region_num = 3, bool force_orphaning = false);
+
+	inline GLuint get_id() const { return buf_id; }
+	inline size_t get_region_size() const { return region_size; }
+	inline size_t get_region_num() const { return region_num; }
+	inline bool is_persistent_mapped() const { return is_persistent; }
+	// index of region returned by the last map_region()
+	inline size_t get_cur_region() const { return cur_region; }
+
+	// advance to next region, wait until gpu has finished reading it
+	void *map_region();
+	// return byte offset of the written region in buffer
+	size_t unmap_region();
+	// call after the draw commands reading current region
+	void fence_region();
+
+private: // no copy
+	StreamGLBuffer(const StreamGLBuffer &other) = delete;
+	StreamGLBuffer &operator=(const StreamGLBuffer &other) = delete;
+};
+
+#endif
@@ -1,137 +0,0 @@
-#ifndef __Circle_Mesh_Data__
-#define __Circle_Mesh_Data__
-
-// Generated by CircleMesh.py
-
-static const unsigned int circle_node_num = 61;
-
-static const float circle_nodes[] = {
-    0.000000f, 0.000000f, // node 0
-    1.000000f, 0.000000f, // node 1
-    0.994522f, 0.104528f, // node 2
-    0.978148f, 0.207912f, // node 3
-    0.951057f, 0.309017f, // node 4
-    0.913545f, 0.406737f, // node 5
-    0.866025f, 0.500000f, // node 6
-    0.809017f, 0.587785f, // node 7
-    0.743145f, 0.669131f, // node 8
-    0.669131f, 0.743145f, // node 9
-    0.587785f, 0.809017f, // node 10
-    0.500000f, 0.866025f, // node 11
-    0.406737f, 0.913545f, // node 12
-    0.309017f, 0.951057f, // node 13
-    0.207912f, 0.978148f, // node 14
-    0.104528f, 0.994522f, // node 15
-    0.000000f, 1.000000f, // node 16
-    -0.104528f, 0.994522f, // node 17
-    -0.207912f, 0.978148f, // node 18
-    -0.309017f, 0.951057f, // node 19
-    -0.406737f, 0.913545f, // node 20
-    -0.500000f, 0.866025f, // node 21
-    -0.587785f, 0.809017f, // node 22
-    -0.669131f, 0.743145f, // node 23
-    -0.743145f, 0.669131f, // node 24
-    -0.809017f, 0.587785f, // node 25
-    -0.866025f, 0.500000f, // node 26
-    -0.913545f, 0.406737f, // node 27
-    -0.951057f, 0.309017f, // node 28
-    -0.978148f, 0.207912f, // node 29
-    -0.994522f, 0.104528f, // node 30
-    -1.000000f, 0.000000f, // node 31
-    -0.994522f, -0.104528f, // node 32
-    -0.978148f, -0.207912f, // node 33
-    -0.951057f, -0.309017f, // node 34
-    -0.913545f, -0.406737f, // node 35
-    -0.866025f, -0.500000f, // node 36
-    -0.809017f, -0.587785f, // node 37
-    -0.743145f, -0.669131f, // node 38
-    -0.669131f, -0.743145f, // node 39
-    -0.587785f, -0.809017f, // node 40
-    -0.500000f, -0.866025f, // node 41
-    -0.406737f, -0.913545f, // node 42
-    -0.309017f, -0.951057f, // node 43
-    -0.207912f, -0.978148f, // node 44
-    -0.104528f, -0.994522f, // node 45
-    -0.000000f, -1.000000f, // node 46
-    0.104528f, -0.994522f, // node 47
-    0.207912f, -0.978148f, // node 48
-    0.309017f, -0.951057f, // node 49
-    0.406737f, -0.913545f, // node 50
-    0.500000f, -0.866025f, // node 51
-    0.587785f, -0.809017f, // node 52
-    0.669131f, -0.743145f, // node 53
-    0.743145f, -0.669131f, // node 54
-    0.809017f, -0.587785f, // node 55
-    0.866025f, -0.500000f, // node 56
-    0.913545f, -0.406737f, // node 57
-    0.951057f, -0.309017f, // node 58
-    0.978148f, -0.207912f, // node 59
-    0.994522f, -0.104528f // node 60
-};
-
-static const unsigned int circle_elem_num = 60;
-
-static const unsigned int circle_elems[] = {
-    0, 1, 2, // elem 0
-    0, 2, 3, // elem 1
-    0, 3, 4, // elem 2
-    0, 4, 5, // elem 3
-    0, 5, 6, // elem 4
-    0, 6, 7, // elem 5
-    0, 7, 8, // elem 6
-    0, 8, 9, // elem 7
-    0, 9, 10, // elem 8
-    0, 10, 11, // elem 9
-    0, 11, 12, // elem 10
-    0, 12, 13, // elem 11
-    0, 13, 14, // elem 12
-    0, 14, 15, // elem 13
-    0, 15, 16, // elem 14
-    0, 16, 17, // elem 15
-    0, 17, 18, // elem 16
-    0, 18, 19, // elem 17
-    0, 19, 20, // elem 18
-    0, 20, 21, // elem 19
-    0, 21, 22, // elem 20
-    0, 22, 23, // elem 21
-    0, 23, 24, // elem 22
-    0, 24, 25, // elem 23
-    0, 25, 26, // elem 24
-    0, 26, 27, // elem 25
-    0, 27, 28, // elem 26
-    0, 28, 29, // elem 27
-    0, 29, 30, // elem 28
-    0, 30, 31, // elem 29
-    0, 31, 32, // elem 30
-    0, 32, 33, // elem 31
-    0, 33, 34, // elem 32
-    0, 34, 35, // elem 33
-    0, 35, 36, // elem 34
-    0, 36, 37, // elem 35
-    0, 37, 38, // elem 36
-    0, 38, 39, // elem 37
-    0, 39, 40, // elem 38
-    0, 40, 41, // elem 39
-    0, 41, 42, // elem 40
-    0, 42, 43, // elem 41
-    0, 43, 44, // elem 42
-    0, 44, 45, // elem 43
-    0, 45, 46, // elem 44
-    0, 46, 47, // elem 45
-    0, 47, 48, // elem 46
-    0, 48, 49, // elem 47
-    0, 49, 50, // elem 48
-    0, 50, 51, // elem 49
-    0, 51, 52, // elem 50
-    0, 52, 53, // elem 51
-    0, 53, 54, // elem 52
-    0, 54, 55, // elem 53
-    0, 55, 56, // elem 54
-    0, 56, 57, // elem 55
-    0, 57, 58, // elem 56
-    0, 58, 59, // elem 57
-    0, 59, 60, // elem 58
-    0, 60, 1 // elem 59
-};
-
-#endif
\ No newline at end of file
@@ -15,16 +15,16 @@ DisplayTtf::DisplayTtf() :
 
 int DisplayTtf::init()
 {
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state.enable(GL_CULL_FACE);
+    gl_state.enable(GL_BLEND);
+    gl_state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // model data
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    gl_state.bind_vertex_array(vao);
 
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER,
         sizeof(GLfloat) * 6 * 4,
         nullptr,
@@ -33,15 +33,23 @@ int DisplayTtf::init()
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    gl_state.bind_vertex_array(0);
+
+    // pixel coordinates, set once
+    FrameData frame_data;
+    frame_data.projection = glm::ortho(0.0f, float(width), 0.0f, float(height));
+    frame_data.view = glm::mat4(1.0f);
+    frame_data.viewport = glm::vec4(0.0f, 0.0f, float(width), float(height));
+    frame_data.time = 0.0f;
+    frame_ubo.create(FrameData::layout);
+    frame_ubo.update(frame_data);
 
     // shader
     shader.create("../../Shaders/display_ttf.vert",
                   "../../Shaders/display_ttf.frag");
     shader.use();
-    glm::mat4 proj_mat = glm::ortho(0.0f, float(width), 0.0f, float(height));
-    shader.set_uniform("projection", proj_mat);
     shader.set_uniform("text", 0);
+    text_color_loc = shader.get_uniform<glm::vec3>("textColor");
 
     FT_Library ft;
     if (FT_Init_FreeType(&ft))
@@ -72,7 +80,7 @@ int DisplayTtf::init()
         }
 
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        gl_state.bind_texture(GL_TEXTURE_2D, texture);
         glTexImage2D(
             GL_TEXTURE_2D,
             0,
@@ -98,7 +106,7 @@ int DisplayTtf::init()
         };
         characters.insert(std::pair<char, Character>(c, character));
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl_state.bind_texture(GL_TEXTURE_2D, 0);
 
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
@@ -116,10 +124,10 @@ void DisplayTtf::render_text(
     glm::vec3 &color
     )
 {
-    shader.set_uniform("textColor", color);
+    shader.set_uniform(text_color_loc, color);
 
-    glBindVertexArray(vao);
-    glActiveTexture(GL_TEXTURE0);
+    gl_state.bind_vertex_array(vao);
+    gl_state.active_texture(GL_TEXTURE0);
     
     size_t text_len = strlen(text);
     float cx_pos, cy_pos, cwd, cht;
@@ -141,10 +149,10 @@ void DisplayTtf::render_text(
             { cx_pos + cwd, cy_pos,       1.0f, 1.0f },
             { cx_pos + cwd, cy_pos + cht, 1.0f, 0.0f }
         };
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
 
-        glBindTexture(GL_TEXTURE_2D, ch.tex_id);
+        gl_state.bind_texture(GL_TEXTURE_2D, ch.tex_id);
 
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
@@ -155,9 +163,6 @@ void DisplayTtf::render_text(
         // divide amount of 1/64th pixels by 64 to get amount of pixels
         x_pos += (ch.advance >> 6) * scale;
     }
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 int DisplayTtf::paint()
@@ -175,12 +180,13 @@ void DisplayTtf::destroy()
 {
     if (vbo)
     {
-        glDeleteBuffers(1, &vbo);
+        gl_state.delete_buffers(1, &vbo);
         vbo = 0;
     }
     if (vao)
     {
-        glDeleteVertexArrays(1, &vao);
+        gl_state.delete_vertex_arrays(1, &vao);
         vao = 0;
     }
+    frame_ubo.destroy();
 }
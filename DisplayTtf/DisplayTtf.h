@@ -19,6 +19,8 @@ protected:
 	std::map<GLchar, Character> characters;
 	
 	OpenGLShaderProgram shader;
+	OpenGLShaderProgram::Uniform<glm::vec3> text_color_loc;
+	OpenGLUniformBuffer frame_ubo;
 
 	GLuint vao, vbo;
 	
@@ -21,6 +21,9 @@ int ImGUIApp::init()
     show_demo_window = true;
     show_another_window = true;
     clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+
+    // imgui needs frames after input to finish widget animations
+    set_continuous_redraw(true);
     
 	return 0;
 }
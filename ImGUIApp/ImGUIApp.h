@@ -15,6 +15,10 @@ protected:
 	ImVec4 clear_color;
 
 public:
+	// imgui glfw backend queries cursor and window on new frame
+	// and its callbacks write io, both on main thread
+	ImGUIApp() { set_main_thread_only(true); }
+
 	int init() override;
 	int paint() override;
 	void destroy() override;
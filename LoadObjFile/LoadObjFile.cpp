@@ -16,19 +16,27 @@ LoadObjFile::LoadObjFile() :
     last_frame_dtime(0.0f),
     is_first_mouse(true)
 {
-
+    // camera moves while keys are held
+    set_continuous_redraw(true);
 }
 
 int LoadObjFile::init()
 {
     stbi_set_flip_vertically_on_load(true);
 
-    glEnable(GL_DEPTH_TEST);
+    gl_state.enable(GL_DEPTH_TEST);
     glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
 
-    shader.create("../../Shaders/load_obj_file.vert",
-                  "../../Shaders/load_obj_file.frag");
+    frame_ubo.create(FrameData::layout);
+    shader_variants.init("../../Shaders/load_obj_file.vert",
+                         "../../Shaders/load_obj_file.frag",
+                         MeshGLBuffer::variant_define_names, 2);
+    model_mat_locs.assign(size_t(1) << shader_variants.get_define_num(),
+                          OpenGLShaderProgram::Uniform<glm::mat4>());
+    model_mat_programs.assign(model_mat_locs.size(), 0);
 
+    // later runs map meshes cached in working directory
+    model.set_cache_dir(".");
     model.load_model("../../Assets/backpack/backpack.obj");
     model.print_info();
 
@@ -39,27 +47,35 @@ int LoadObjFile::paint()
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    shader.use();
-
-    glm::mat4 proj_mat = glm::perspective(45.0f, (float)width / (float)height, 0.01f, 1000.0f);
-    shader.set_uniform("projection", proj_mat);
-    
-    glm::mat4 view_mat = camera.get_view_mat();
-    shader.set_uniform("view", view_mat);
+    frame_data.projection = glm::perspective(45.0f, (float)width / (float)height, 0.01f, 1000.0f);
+    frame_data.view = camera.get_view_mat();
+    frame_data.viewport = glm::vec4(0.0f, 0.0f, float(width), float(height));
+    frame_data.time = float(get_time());
+    frame_ubo.update(frame_data);
 
     glm::mat4 model_mat = glm::mat4(1.0f);
     //model_mat = glm::translate(model_mat, glm::vec3(0.0f, 0.0f, 0.0f));
     //model_mat = glm::scale(model_mat, glm::vec3(1.0f, 1.0f, 1.0f));
-    shader.set_uniform("model", model_mat);
 
-    model.draw(shader);
+    model.draw(shader_variants, [&](OpenGLShaderProgram& shader, OpenGLShaderVariants::Key key)
+        {
+            if (model_mat_programs[key] != shader.get_id())
+            {
+                model_mat_locs[key] = shader.get_uniform<glm::mat4>("model");
+                model_mat_programs[key] = shader.get_id();
+            }
+            shader.set_uniform(model_mat_locs[key], model_mat);
+        });
 
     return 0;
 }
 
 void LoadObjFile::destroy()
 {
-
+    shader_variants.clear();
+    model_mat_locs.clear();
+    model_mat_programs.clear();
+    frame_ubo.destroy();
 }
 
 int LoadObjFile::resize(int wd, int ht)
@@ -88,7 +104,7 @@ void LoadObjFile::mouse_move(double xpos, double ypos)
 
 void LoadObjFile::process_keyboard_input()
 {
-    float cur_frame_time = glfwGetTime();
+    float cur_frame_time = float(get_time());
     float dtime = cur_frame_time - last_frame_dtime;
     last_frame_dtime = cur_frame_time;
 
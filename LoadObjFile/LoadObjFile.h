@@ -13,7 +13,15 @@ class LoadObjFile : public GlfwApp
 {
 protected:
 	Camera_YawPitch camera;
-	OpenGLShaderProgram shader;
+	// permutations for textures of meshes
+	OpenGLShaderVariants shader_variants;
+	// "model" of each variant key, resolved when the variant
+	// is first drawn, program id tells if it was rebuilt
+	std::vector<OpenGLShaderProgram::Uniform<glm::mat4> > model_mat_locs;
+	std::vector<GLuint> model_mat_programs;
+	// camera matrices shared by all variants
+	FrameData frame_data;
+	OpenGLUniformBuffer frame_ubo;
 	ObjModel model;
 	float last_frame_dtime;
 	float last_xpos, last_ypos;
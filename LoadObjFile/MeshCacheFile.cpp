@@ -0,0 +1,303 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "MeshCacheFile.h"
+
+static const char mesh_cache_magic[4] = { 'M', 'S', 'H', 'C' };
+static const uint32_t mesh_cache_version = 2;
+// align blobs for direct use as buffer data
+static const uint64_t mesh_cache_align = 16;
+
+static inline uint64_t align_offset(uint64_t offset)
+{
+    return (offset + mesh_cache_align - 1) / mesh_cache_align * mesh_cache_align;
+}
+
+// num items at offset are in file, without overflow of corrupt counts
+static inline bool is_in_file(uint64_t offset, uint64_t num, uint64_t item_size, uint64_t file_size)
+{
+    return offset <= file_size && num <= (file_size - offset) / item_size;
+}
+
+int MeshCacheFile::open(const char *filename)
+{
+    close();
+
+    if (file.open(filename))
+        return -1;
+
+    const uint64_t file_size = file.get_size();
+    const MeshCacheHeader *hd = (const MeshCacheHeader *)file.get_data();
+    if (file_size < sizeof(MeshCacheHeader) ||
+        memcmp(hd->magic, mesh_cache_magic, sizeof(mesh_cache_magic)) ||
+        hd->version != mesh_cache_version ||
+        hd->vertex_size != sizeof(Vertex))
+    {
+        std::cout << "MeshCacheFile: " << filename << " has invalid header.\n";
+        close();
+        return -1;
+    }
+
+    if (!is_in_file(hd->mesh_offset, hd->mesh_num, sizeof(MeshCacheMesh), file_size) ||
+        !is_in_file(hd->material_offset, hd->material_num, sizeof(MeshCacheMaterial), file_size) ||
+        !is_in_file(hd->texture_offset, hd->texture_num, sizeof(MeshCacheTexture), file_size) ||
+        !is_in_file(hd->dependency_offset, hd->dependency_num, sizeof(MeshCacheDependency), file_size))
+    {
+        std::cout << "MeshCacheFile: " << filename << " is truncated.\n";
+        close();
+        return -1;
+    }
+    const MeshCacheMesh *mhs = (const MeshCacheMesh *)(file.get_data() + hd->mesh_offset);
+    const MeshCacheMaterial *mts = (const MeshCacheMaterial *)(file.get_data() + hd->material_offset);
+    for (uint32_t mh_id = 0; mh_id < hd->mesh_num; ++mh_id)
+    {
+        const MeshCacheMesh &mh = mhs[mh_id];
+        if (!is_in_file(mh.vertex_offset, mh.vertex_num, sizeof(Vertex), file_size) ||
+            !is_in_file(mh.index_offset, mh.index_num, sizeof(GLuint), file_size) ||
+            mh.material_id >= hd->material_num)
+        {
+            std::cout << "MeshCacheFile: " << filename << " is truncated.\n";
+            close();
+            return -1;
+        }
+    }
+    for (uint32_t mt_id = 0; mt_id < hd->material_num; ++mt_id)
+    {
+        if (uint64_t(mts[mt_id].first_texture) + mts[mt_id].texture_num > hd->texture_num)
+        {
+            std::cout << "MeshCacheFile: " << filename << " has invalid material.\n";
+            close();
+            return -1;
+        }
+    }
+
+    header = hd;
+    meshes = mhs;
+    materials = mts;
+    textures = (const MeshCacheTexture *)(file.get_data() + hd->texture_offset);
+    dependencies = (const MeshCacheDependency *)(file.get_data() + hd->dependency_offset);
+    return 0;
+}
+
+void MeshCacheFile::close()
+{
+    header = nullptr;
+    meshes = nullptr;
+    materials = nullptr;
+    textures = nullptr;
+    dependencies = nullptr;
+    file.close();
+}
+
+int MeshCacheFile::get_file_stat(const char *filename, uint64_t &mtime, uint64_t &size)
+{
+#ifdef _WIN32
+    struct _stat64 file_stat;
+    if (_stat64(filename, &file_stat) != 0)
+        return -1;
+#else
+    struct stat file_stat;
+    if (stat(filename, &file_stat) != 0)
+        return -1;
+#endif
+    mtime = uint64_t(file_stat.st_mtime);
+    size = uint64_t(file_stat.st_size);
+    return 0;
+}
+
+uint64_t MeshCacheFile::hash_file(const char *filename)
+{
+    MappedFile source;
+    if (source.open(filename))
+        return 0;
+    uint64_t hash = 14695981039346656037ULL;
+    const unsigned char *bytes = (const unsigned char *)source.get_data();
+    for (size_t b_id = 0; b_id < source.get_size(); ++b_id)
+        hash = (hash ^ bytes[b_id]) * 1099511628211ULL;
+    return hash;
+}
+
+bool MeshCacheFile::is_file_unchanged(
+    const char *filename,
+    uint64_t mtime,
+    uint64_t size,
+    uint64_t hash
+    )
+{
+    uint64_t cur_mtime, cur_size;
+    if (get_file_stat(filename, cur_mtime, cur_size) || cur_size != size)
+        return false;
+    if (cur_mtime == mtime)
+        return true;
+    return hash_file(filename) == hash;
+}
+
+bool MeshCacheFile::is_up_to_date(const char *source_filename) const
+{
+    if (!header)
+        return false;
+    if (!is_file_unchanged(source_filename, header->source_mtime,
+        header->source_size, header->source_hash))
+        return false;
+
+    for (uint32_t d_id = 0; d_id < header->dependency_num; ++d_id)
+    {
+        const MeshCacheDependency &dep = dependencies[d_id];
+        // filename may fill the array if the file is corrupt
+        std::string dep_filename(dep.filename, strnlen(dep.filename, sizeof(dep.filename)));
+        if (!dep.exists)
+        {
+            uint64_t mtime, size;
+            if (get_file_stat(dep_filename.c_str(), mtime, size) == 0)
+                return false;
+        }
+        else if (!is_file_unchanged(dep_filename.c_str(), dep.mtime, dep.size, dep.hash))
+            return false;
+    }
+    return true;
+}
+
+int MeshCacheFile::write(
+    const char *filename,
+    const char *source_filename,
+    MeshGLBuffer *meshes,
+    size_t mesh_num,
+    const std::vector<std::string> &dependency_filenames
+    )
+{
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, mesh_cache_magic, sizeof(mesh_cache_magic));
+    header.version = mesh_cache_version;
+    header.vertex_size = sizeof(Vertex);
+    if (get_file_stat(source_filename, header.source_mtime, header.source_size))
+    {
+        std::cout << "MeshCacheFile: Can't find source " << source_filename << ".\n";
+        return -1;
+    }
+    header.source_hash = hash_file(source_filename);
+
+    std::vector<MeshCacheDependency> dependency_table(dependency_filenames.size());
+    for (size_t d_id = 0; d_id < dependency_filenames.size(); ++d_id)
+    {
+        const std::string &dep_filename = dependency_filenames[d_id];
+        MeshCacheDependency &dep = dependency_table[d_id];
+        memset(&dep, 0, sizeof(dep));
+        if (dep_filename.size() >= sizeof(dep.filename))
+        {
+            std::cout << "MeshCacheFile: Dependency name " << dep_filename << " is too long.\n";
+            return -1;
+        }
+        memcpy(dep.filename, dep_filename.c_str(), dep_filename.size());
+        if (get_file_stat(dep_filename.c_str(), dep.mtime, dep.size) == 0)
+        {
+            dep.exists = 1;
+            dep.hash = hash_file(dep_filename.c_str());
+        }
+    }
+
+    // meshes with the same textures share material
+    std::vector<MeshCacheMesh> mesh_table(mesh_num);
+    std::vector<MeshCacheMaterial> material_table;
+    std::vector<MeshCacheTexture> texture_table;
+    std::vector<const std::vector<Texture> *> material_textures;
+    for (size_t mh_id = 0; mh_id < mesh_num; ++mh_id)
+    {
+        std::vector<Texture> &mh_textures = meshes[mh_id].get_textures();
+        size_t mt_id = 0;
+        for (; mt_id < material_textures.size(); ++mt_id)
+        {
+            const std::vector<Texture> &mt_textures = *material_textures[mt_id];
+            bool same = mt_textures.size() == mh_textures.size();
+            for (size_t t_id = 0; same && t_id < mh_textures.size(); ++t_id)
+                same = mt_textures[t_id].filename == mh_textures[t_id].filename &&
+                       mt_textures[t_id].type == mh_textures[t_id].type;
+            if (same)
+                break;
+        }
+        if (mt_id == material_textures.size())
+        {
+            MeshCacheMaterial material;
+            material.first_texture = uint32_t(texture_table.size());
+            material.texture_num = uint32_t(mh_textures.size());
+            for (size_t t_id = 0; t_id < mh_textures.size(); ++t_id)
+            {
+                const Texture &texture = mh_textures[t_id];
+                MeshCacheTexture cache_texture;
+                memset(&cache_texture, 0, sizeof(cache_texture));
+                if (texture.filename.size() >= sizeof(cache_texture.filename) ||
+                    texture.type.size() >= sizeof(cache_texture.type))
+                {
+                    std::cout << "MeshCacheFile: Texture name " << texture.filename << " is too long.\n";
+                    return -1;
+                }
+                memcpy(cache_texture.filename, texture.filename.c_str(), texture.filename.size());
+                memcpy(cache_texture.type, texture.type.c_str(), texture.type.size());
+                texture_table.push_back(cache_texture);
+            }
+            material_table.push_back(material);
+            material_textures.push_back(&mh_textures);
+        }
+        mesh_table[mh_id].material_id = uint32_t(mt_id);
+        mesh_table[mh_id].padding = 0;
+    }
+
+    header.mesh_num = uint32_t(mesh_table.size());
+    header.material_num = uint32_t(material_table.size());
+    header.texture_num = uint32_t(texture_table.size());
+    header.dependency_num = uint32_t(dependency_table.size());
+    header.mesh_offset = align_offset(sizeof(MeshCacheHeader));
+    header.material_offset = align_offset(header.mesh_offset + mesh_table.size() * sizeof(MeshCacheMesh));
+    header.texture_offset = align_offset(header.material_offset + material_table.size() * sizeof(MeshCacheMaterial));
+    header.dependency_offset = align_offset(header.texture_offset + texture_table.size() * sizeof(MeshCacheTexture));
+    uint64_t offset = align_offset(header.dependency_offset + dependency_table.size() * sizeof(MeshCacheDependency));
+    for (size_t mh_id = 0; mh_id < mesh_num; ++mh_id)
+    {
+        MeshCacheMesh &mh = mesh_table[mh_id];
+        mh.vertex_num = meshes[mh_id].get_vertices().size();
+        mh.index_num = meshes[mh_id].get_indices().size();
+        mh.vertex_offset = offset;
+        mh.index_offset = align_offset(mh.vertex_offset + mh.vertex_num * sizeof(Vertex));
+        offset = align_offset(mh.index_offset + mh.index_num * sizeof(GLuint));
+    }
+
+    std::fstream file(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "MeshCacheFile: Can't open file " << filename << ".\n";
+        return -1;
+    }
+    // pad to offset of next part
+    const char padding[mesh_cache_align] = { 0 };
+    uint64_t pos = 0;
+    auto write_part = [&](uint64_t part_offset, const void *data, uint64_t size)
+    {
+        file.write(padding, part_offset - pos);
+        if (size)
+            file.write((const char *)data, size);
+        pos = part_offset + size;
+    };
+    write_part(0, &header, sizeof(header));
+    write_part(header.mesh_offset, mesh_table.data(), mesh_table.size() * sizeof(MeshCacheMesh));
+    write_part(header.material_offset, material_table.data(), material_table.size() * sizeof(MeshCacheMaterial));
+    write_part(header.texture_offset, texture_table.data(), texture_table.size() * sizeof(MeshCacheTexture));
+    write_part(header.dependency_offset, dependency_table.data(), dependency_table.size() * sizeof(MeshCacheDependency));
+    for (size_t mh_id = 0; mh_id < mesh_num; ++mh_id)
+    {
+        const MeshCacheMesh &mh = mesh_table[mh_id];
+        write_part(mh.vertex_offset, meshes[mh_id].get_vertices().data(), mh.vertex_num * sizeof(Vertex));
+        write_part(mh.index_offset, meshes[mh_id].get_indices().data(), mh.index_num * sizeof(GLuint));
+    }
+    file.close();
+    if (!file)
+    {
+        std::cout << "MeshCacheFile: Can't write file " << filename << ".\n";
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+#ifndef __Mesh_Cache_File_h__
+#define __Mesh_Cache_File_h__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MeshGLBuffer.h"
+
+// Binary mesh cache file:
+//   MeshCacheHeader
+//   MeshCacheMesh[mesh_num]
+//   MeshCacheMaterial[material_num]
+//   MeshCacheTexture[texture_num]
+//   MeshCacheDependency[dependency_num]
+//   vertex (Vertex) and index (GLuint) blob of each mesh, aligned
+//   so that they can be passed to glBufferData as mapped
+struct MeshCacheHeader
+{
+    char magic[4]; // "MSHC"
+    uint32_t version;
+    uint32_t vertex_size; // sizeof(Vertex) when written
+    uint32_t mesh_num;
+    uint32_t material_num;
+    uint32_t texture_num;
+    uint32_t dependency_num;
+    uint32_t padding;
+    // source model, cache is stale if they change
+    uint64_t source_mtime;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint64_t mesh_offset;
+    uint64_t material_offset;
+    uint64_t texture_offset;
+    uint64_t dependency_offset;
+};
+
+struct MeshCacheMesh
+{
+    uint64_t vertex_offset;
+    uint64_t vertex_num;
+    uint64_t index_offset;
+    uint64_t index_num;
+    uint32_t material_id;
+    uint32_t padding;
+};
+
+// range of texture table, meshes with the same textures share it
+struct MeshCacheMaterial
+{
+    uint32_t first_texture;
+    uint32_t texture_num;
+};
+
+// filename relative to directory of source model, type is the
+// sampler name prefix, e.g. "texture_diffuse"
+struct MeshCacheTexture
+{
+    char filename[256];
+    char type[32];
+};
+
+// other file read on import, e.g. mtl file of obj model,
+// cache is stale if it changes, appears or disappears
+struct MeshCacheDependency
+{
+    char filename[256];
+    uint64_t mtime;
+    uint64_t size;
+    uint64_t hash;
+    uint32_t exists;
+    uint32_t padding;
+};
+
+class MeshCacheFile
+{
+protected:
+    MappedFile file;
+    const MeshCacheHeader *header;
+    const MeshCacheMesh *meshes;
+    const MeshCacheMaterial *materials;
+    const MeshCacheTexture *textures;
+    const MeshCacheDependency *dependencies;
+
+    // same size and mtime are trusted, otherwise contents are
+    // hashed, e.g. after the file is copied
+    static bool is_file_unchanged(const char *filename,
+        uint64_t mtime, uint64_t size, uint64_t hash);
+
+public:
+    MeshCacheFile() : header(nullptr), meshes(nullptr),
+        materials(nullptr), textures(nullptr), dependencies(nullptr) {}
+    ~MeshCacheFile() { close(); }
+
+    // map file and validate header and tables, return 0 if success
+    int open(const char *filename);
+    void close();
+
+    inline bool is_open() const { return header != nullptr; }
+    inline const MeshCacheHeader &get_header() const { return *header; }
+    inline size_t get_mesh_num() const { return header->mesh_num; }
+    inline const MeshCacheMesh &get_mesh(size_t mh_id) const { return meshes[mh_id]; }
+    // pointers into the mapped file
+    inline const Vertex *get_vertices(size_t mh_id) const
+    {
+        return (const Vertex *)(file.get_data() + meshes[mh_id].vertex_offset);
+    }
+    inline const GLuint *get_indices(size_t mh_id) const
+    {
+        return (const GLuint *)(file.get_data() + meshes[mh_id].index_offset);
+    }
+    inline const MeshCacheMaterial &get_material(size_t mt_id) const { return materials[mt_id]; }
+    inline const MeshCacheTexture &get_texture(size_t t_id) const { return textures[t_id]; }
+
+    inline size_t get_dependency_num() const { return header->dependency_num; }
+    inline const MeshCacheDependency &get_dependency(size_t d_id) const { return dependencies[d_id]; }
+
+    // whether cache was written from source_filename
+    // and dependencies as they are now
+    bool is_up_to_date(const char *source_filename) const;
+
+    // meshes need vertices and indices in memory, dependency files
+    // may be missing, return 0 if success, -1 if fails
+    static int write(const char *filename, const char *source_filename,
+        MeshGLBuffer *meshes, size_t mesh_num,
+        const std::vector<std::string> &dependency_filenames);
+
+    // modification time in seconds and size, return 0 if success
+    static int get_file_stat(const char *filename, uint64_t &mtime, uint64_t &size);
+    // FNV-1a of file contents, 0 if it can't be read
+    static uint64_t hash_file(const char *filename);
+};
+
+#endif
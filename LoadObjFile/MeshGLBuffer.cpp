@@ -1,30 +1,95 @@
+#include <utility>
+
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
 #include "MeshGLBuffer.h"
 
+const char* const MeshGLBuffer::variant_define_names[2] = {
+    "HAS_DIFFUSE_MAP",
+    "HAS_NORMAL_MAP"
+};
+
 MeshGLBuffer::~MeshGLBuffer()
 {
     clear();
 }
 
+MeshGLBuffer::MeshGLBuffer(MeshGLBuffer&& other) noexcept :
+    vertices(std::move(other.vertices)),
+    indices(std::move(other.indices)),
+    textures(std::move(other.textures)),
+    vao(other.vao), vbo(other.vbo), ebo(other.ebo),
+    vertex_num(other.vertex_num), index_num(other.index_num),
+    sampler_names(std::move(other.sampler_names)),
+    sampler_locs(std::move(other.sampler_locs)),
+    sampler_program(other.sampler_program)
+{
+    other.vao = 0;
+    other.vbo = 0;
+    other.ebo = 0;
+    other.vertex_num = 0;
+    other.index_num = 0;
+    other.sampler_program = 0;
+}
+
+MeshGLBuffer& MeshGLBuffer::operator=(MeshGLBuffer&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+    clear();
+    vertices = std::move(other.vertices);
+    indices = std::move(other.indices);
+    textures = std::move(other.textures);
+    vao = other.vao;
+    vbo = other.vbo;
+    ebo = other.ebo;
+    vertex_num = other.vertex_num;
+    index_num = other.index_num;
+    sampler_names = std::move(other.sampler_names);
+    sampler_locs = std::move(other.sampler_locs);
+    sampler_program = other.sampler_program;
+    other.vao = 0;
+    other.vbo = 0;
+    other.ebo = 0;
+    other.vertex_num = 0;
+    other.index_num = 0;
+    other.sampler_program = 0;
+    return *this;
+}
+
 void MeshGLBuffer::setup_gl_buffer()
 {
+    setup_gl_buffer(vertices.data(), vertices.size(), indices.data(), indices.size());
+}
+
+void MeshGLBuffer::setup_gl_buffer(
+    const Vertex* vertex_data,
+    size_t vert_num,
+    const GLuint* index_data,
+    size_t idx_num
+    )
+{
+    FrameProfiler::Scope scope(FrameProfiler::get_cur_profiler(), "mesh_upload");
+    GLStateCache& gl_state = GLStateCache::get();
+
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    gl_state.bind_vertex_array(vao);
 
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(
         GL_ARRAY_BUFFER,
-        vertices.size() * sizeof(Vertex),
-        &vertices[0],
+        vert_num * sizeof(Vertex),
+        vertex_data,
         GL_STATIC_DRAW
         );
 
     glGenBuffers(1, &ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    gl_state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(
         GL_ELEMENT_ARRAY_BUFFER,
-        indices.size() * sizeof(GLuint),
-        &indices[0],
+        idx_num * sizeof(GLuint),
+        index_data,
         GL_STATIC_DRAW
         );
 
@@ -37,28 +102,34 @@ void MeshGLBuffer::setup_gl_buffer()
     // texture coord
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tex_coord));
-    // tangent
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
-    // bitangent
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
-
-    glBindVertexArray(0);
+    // tangent and bitangent are only read by normal map variants
+    if (get_variant_key() & NormalMapBit)
+    {
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+    }
+
+    gl_state.bind_vertex_array(0);
+
+    vertex_num = vert_num;
+    index_num = GLsizei(idx_num);
+    set_sampler_names();
 }
 
-void MeshGLBuffer::draw(OpenGLShaderProgram& shader)
+void MeshGLBuffer::set_sampler_names()
 {
-    // bind textures
     GLuint diffuseNr = 1;
     GLuint specularNr = 1;
     GLuint normalNr = 1;
     GLuint heightNr = 1;
     std::string number;
-    for (GLuint s_id = 0; s_id < textures.size(); ++s_id)
+    sampler_names.resize(textures.size());
+    for (size_t s_id = 0; s_id < textures.size(); ++s_id)
     {
         // retrieve texture number
-        std::string name = textures[s_id].type;
+        const std::string &name = textures[s_id].type;
         if (name == "texture_diffuse")
             number = std::to_string(diffuseNr++);
         else if (name == "texture_specular")
@@ -67,37 +138,81 @@ void MeshGLBuffer::draw(OpenGLShaderProgram& shader)
             number = std::to_string(normalNr++);
         else if (name == "texture_height")
             number = std::to_string(heightNr++);
+        sampler_names[s_id] = name + number;
+    }
+    sampler_program = 0;
+}
+
+OpenGLShaderVariants::Key MeshGLBuffer::get_variant_key() const
+{
+    OpenGLShaderVariants::Key key = 0;
+    for (size_t t_id = 0; t_id < textures.size(); ++t_id)
+    {
+        if (textures[t_id].type == "texture_diffuse")
+            key |= DiffuseMapBit;
+        else if (textures[t_id].type == "texture_normal")
+            key |= NormalMapBit;
+    }
+    return key;
+}
 
-        glActiveTexture(GL_TEXTURE0 + s_id);
-        glBindTexture(GL_TEXTURE_2D, textures[s_id].id);
-        shader.set_uniform((name + number).c_str(), s_id);
+void MeshGLBuffer::draw(OpenGLShaderProgram& shader)
+{
+    GLStateCache& gl_state = GLStateCache::get();
+
+    if (sampler_program != shader.get_id())
+    {
+        sampler_locs.resize(sampler_names.size());
+        for (size_t s_id = 0; s_id < sampler_names.size(); ++s_id)
+            sampler_locs[s_id] = shader.uniform_loc(sampler_names[s_id].c_str());
+        sampler_program = shader.get_id();
     }
 
-    // draw mesh
-    glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    // bind textures of samplers the program uses, e.g.
+    // specular maps are skipped by every variant
+    GLuint unit = 0;
+    for (size_t s_id = 0; s_id < sampler_locs.size(); ++s_id)
+    {
+        if (sampler_locs[s_id] == -1)
+            continue;
+        gl_state.active_texture(GL_TEXTURE0 + unit);
+        gl_state.bind_texture(GL_TEXTURE_2D, textures[s_id].id);
+        // samplers are set with glUniform1i
+        shader.set_uniform(sampler_locs[s_id], GLint(unit));
+        ++unit;
+    }
+
+    // draw mesh, vao stays bound for next mesh
+    gl_state.bind_vertex_array(vao);
+    glDrawElements(GL_TRIANGLES, index_num, GL_UNSIGNED_INT, 0);
 }
 
 void MeshGLBuffer::clear()
 {
+    GLStateCache& gl_state = GLStateCache::get();
+
     vertices.clear();
     indices.clear();
     textures.clear();
+    sampler_names.clear();
+    sampler_locs.clear();
+    sampler_program = 0;
+    vertex_num = 0;
+    index_num = 0;
 
     if (ebo)
     {
-        glDeleteBuffers(1, &ebo);
+        gl_state.delete_buffers(1, &ebo);
         ebo = 0;
     }
     if (vbo)
     {
-        glDeleteBuffers(1, &vbo);
+        gl_state.delete_buffers(1, &vbo);
         vbo = 0;
     }
     if (vao)
     {
-        glDeleteVertexArrays(1, &vao);
+        gl_state.delete_vertex_arrays(1, &vao);
         vao = 0;
     }
 }
@@ -29,25 +29,62 @@ struct Texture
 
 class MeshGLBuffer
 {
+public:
+    // bits of shader variant key, see variant_define_names
+    enum VariantBit
+    {
+        DiffuseMapBit = 1,
+        NormalMapBit = 2
+    };
+    static const char* const variant_define_names[2];
+
 protected:
     std::vector<Vertex> vertices;
     std::vector<GLuint> indices;
     std::vector<Texture> textures;
     
     GLuint vao, vbo, ebo;
+    // sizes of gl buffers, vectors may be empty when
+    // buffers are set up from other data
+    size_t vertex_num;
+    GLsizei index_num;
+
+    // sampler uniform of each texture, e.g. "texture_diffuse1",
+    // locations are resolved again when drawn with other program
+    std::vector<std::string> sampler_names;
+    std::vector<GLint> sampler_locs;
+    GLuint sampler_program;
+
+    void set_sampler_names();
 
 public:
-    MeshGLBuffer() {}
+    MeshGLBuffer() : vao(0), vbo(0), ebo(0),
+        vertex_num(0), index_num(0), sampler_program(0) {}
     ~MeshGLBuffer();
+    // gl buffers move with mesh, e.g. when vector grows
+    MeshGLBuffer(MeshGLBuffer&& other) noexcept;
+    MeshGLBuffer& operator=(MeshGLBuffer&& other) noexcept;
 
     inline std::vector<Vertex>& get_vertices() { return vertices; }
     inline std::vector<GLuint>& get_indices() { return indices; }
     inline std::vector<Texture>& get_textures() { return textures; }
+    inline size_t get_vertex_num() const { return vertex_num; }
+    inline size_t get_index_num() const { return size_t(index_num); }
 
+    // upload vertices and indices
     void setup_gl_buffer();
+    // upload data as is, e.g. mapped from MeshCacheFile
+    void setup_gl_buffer(const Vertex* vertex_data, size_t vert_num,
+        const GLuint* index_data, size_t idx_num);
+    // variant of load_obj_file shaders for textures of mesh
+    OpenGLShaderVariants::Key get_variant_key() const;
     
     void draw(OpenGLShaderProgram& shader);
     void clear();
+
+private: // no copy, copies would delete shared gl buffers
+    MeshGLBuffer(const MeshGLBuffer& other) = delete;
+    MeshGLBuffer& operator=(const MeshGLBuffer& other) = delete;
 };
 
 #endif
\ No newline at end of file
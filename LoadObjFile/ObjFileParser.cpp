@@ -0,0 +1,756 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "ObjFileParser.h"
+
+namespace
+{
+    // Indices of position, tex coord and normal of a face corner,
+    // 0 based or -1 if missing. Negative indices in file are relative
+    // to the end of the chunk data and marked in relative_bits until
+    // counts of previous chunks are added.
+    struct Corner
+    {
+        int32_t ids[3];
+        uint32_t relative_bits;
+    };
+
+    struct MaterialSwitch
+    {
+        // first triangle using the material
+        size_t triangle_id;
+        std::string name;
+    };
+
+    // data of a line aligned range of the file
+    struct Chunk
+    {
+        const char* begin;
+        const char* end;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> tex_coords;
+        std::vector<glm::vec3> normals;
+        // 3 corners per triangle
+        std::vector<Corner> corners;
+        std::vector<MaterialSwitch> switches;
+        std::vector<std::string> mtl_filenames;
+        size_t line_num;
+        // line in chunk, 0 if there is no error
+        size_t error_line;
+    };
+
+    // triangles of a chunk drawn with one material
+    struct TriangleRange
+    {
+        size_t chunk_id;
+        size_t begin, end;
+    };
+
+    inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+    inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    inline const char* skip_space(const char* p, const char* end)
+    {
+        while (p < end && is_space(*p))
+            ++p;
+        return p;
+    }
+
+    // keyword at p followed by space
+    inline bool match_keyword(const char* p, const char* end, const char* keyword)
+    {
+        size_t len = strlen(keyword);
+        return size_t(end - p) > len && !memcmp(p, keyword, len) && is_space(p[len]);
+    }
+
+    // rest of line without surrounding spaces
+    inline std::string get_name(const char* p, const char* end)
+    {
+        p = skip_space(p, end);
+        while (end > p && is_space(end[-1]))
+            --end;
+        return std::string(p, end);
+    }
+
+    // last word of line, i.e. filename after options of texture map
+    inline std::string get_last_word(const char* p, const char* end)
+    {
+        while (end > p && is_space(end[-1]))
+            --end;
+        const char* begin = end;
+        while (begin > p && !is_space(begin[-1]))
+            --begin;
+        return std::string(begin, end);
+    }
+
+    // parse up to num floats, return number parsed
+    inline size_t parse_floats(const char* p, const char* end, float* values, size_t num)
+    {
+        size_t value_num = 0;
+        for (; value_num < num; ++value_num)
+        {
+            p = skip_space(p, end);
+            p = ObjFileParser::parse_float(p, end, values[value_num]);
+            if (!p)
+                break;
+        }
+        return value_num;
+    }
+
+    // "v", "v/vt", "v//vn" or "v/vt/vn" at p, counts are local numbers
+    // of data in chunk for relative indices
+    const char* parse_corner(const char* p, const char* end,
+        const size_t counts[3], Corner& corner)
+    {
+        corner.ids[0] = corner.ids[1] = corner.ids[2] = -1;
+        corner.relative_bits = 0;
+        for (size_t i_id = 0; i_id < 3; ++i_id)
+        {
+            if (i_id > 0)
+            {
+                if (p >= end || *p != '/')
+                    break;
+                ++p;
+                // "v//vn" has no tex coord
+                if (i_id == 1 && p < end && *p == '/')
+                    continue;
+            }
+            int id = 0;
+            p = ObjFileParser::parse_int(p, end, id);
+            if (!p || id == 0)
+                return nullptr;
+            if (id > 0)
+                corner.ids[i_id] = id - 1;
+            else
+            {
+                corner.ids[i_id] = int32_t(counts[i_id]) + id;
+                corner.relative_bits |= 1u << i_id;
+            }
+        }
+        return p;
+    }
+
+    // return false if line is invalid
+    bool parse_line(const char* p, const char* end, Chunk& chunk,
+        std::vector<Corner>& face)
+    {
+        p = skip_space(p, end);
+        if (p >= end || *p == '#')
+            return true;
+
+        float values[3] = { 0.0f, 0.0f, 0.0f };
+        if (p[0] == 'v' && end - p > 1 && is_space(p[1]))
+        {
+            // w and vertex colors are ignored
+            if (parse_floats(p + 2, end, values, 3) < 3)
+                return false;
+            chunk.positions.push_back(glm::vec3(values[0], values[1], values[2]));
+        }
+        else if (match_keyword(p, end, "vt"))
+        {
+            if (parse_floats(p + 3, end, values, 2) < 1)
+                return false;
+            // as aiProcess_FlipUVs
+            chunk.tex_coords.push_back(glm::vec2(values[0], 1.0f - values[1]));
+        }
+        else if (match_keyword(p, end, "vn"))
+        {
+            if (parse_floats(p + 3, end, values, 3) < 3)
+                return false;
+            chunk.normals.push_back(glm::vec3(values[0], values[1], values[2]));
+        }
+        else if (p[0] == 'f' && end - p > 1 && is_space(p[1]))
+        {
+            const size_t counts[3] = {
+                chunk.positions.size(), chunk.tex_coords.size(), chunk.normals.size()
+            };
+            face.clear();
+            p = skip_space(p + 2, end);
+            while (p < end)
+            {
+                Corner corner;
+                p = parse_corner(p, end, counts, corner);
+                if (!p || (p < end && !is_space(*p)))
+                    return false;
+                face.push_back(corner);
+                p = skip_space(p, end);
+            }
+            if (face.size() < 3)
+                return false;
+            // triangle fan as aiProcess_Triangulate
+            for (size_t c_id = 1; c_id + 1 < face.size(); ++c_id)
+            {
+                chunk.corners.push_back(face[0]);
+                chunk.corners.push_back(face[c_id]);
+                chunk.corners.push_back(face[c_id + 1]);
+            }
+        }
+        else if (match_keyword(p, end, "usemtl"))
+        {
+            MaterialSwitch mtl_switch;
+            mtl_switch.triangle_id = chunk.corners.size() / 3;
+            mtl_switch.name = get_name(p + 6, end);
+            chunk.switches.push_back(mtl_switch);
+        }
+        else if (match_keyword(p, end, "mtllib"))
+        {
+            // may list several files
+            p += 6;
+            while ((p = skip_space(p, end)) < end)
+            {
+                const char* name_end = p;
+                while (name_end < end && !is_space(*name_end))
+                    ++name_end;
+                chunk.mtl_filenames.push_back(std::string(p, name_end));
+                p = name_end;
+            }
+        }
+        // o, g, s, l, p and others aren't used
+        return true;
+    }
+
+    void parse_chunk(Chunk& chunk)
+    {
+        std::vector<Corner> face;
+        chunk.line_num = 0;
+        chunk.error_line = 0;
+        const char* p = chunk.begin;
+        while (p < chunk.end)
+        {
+            const char* line_end = (const char*)memchr(p, '\n', chunk.end - p);
+            if (!line_end)
+                line_end = chunk.end;
+            ++chunk.line_num;
+            if (!parse_line(p, line_end, chunk, face) && !chunk.error_line)
+                chunk.error_line = chunk.line_num;
+            p = line_end + 1;
+        }
+    }
+
+    // Open addressing table from corner indices to vertex index
+    class CornerMap
+    {
+    protected:
+        struct Entry
+        {
+            int32_t ids[3];
+            uint32_t vertex_id;
+        };
+        std::vector<Entry> entries;
+        size_t mask;
+
+        static inline size_t get_hash(const int32_t ids[3])
+        {
+            uint64_t hash = uint32_t(ids[0]);
+            hash = hash * 0x9E3779B97F4A7C15ULL + uint32_t(ids[1]);
+            hash = hash * 0x9E3779B97F4A7C15ULL + uint32_t(ids[2]);
+            return size_t(hash ^ (hash >> 29));
+        }
+
+    public:
+        explicit CornerMap(size_t max_num)
+        {
+            size_t capacity = 16;
+            while (capacity < max_num * 2)
+                capacity *= 2;
+            Entry empty;
+            empty.ids[0] = -1;
+            empty.ids[1] = empty.ids[2] = 0;
+            empty.vertex_id = 0;
+            entries.assign(capacity, empty);
+            mask = capacity - 1;
+        }
+
+        // index of vertex with ids, new_id if it isn't in table
+        inline uint32_t insert(const int32_t ids[3], uint32_t new_id, bool& is_new)
+        {
+            size_t e_id = get_hash(ids) & mask;
+            while (true)
+            {
+                Entry& entry = entries[e_id];
+                if (entry.ids[0] < 0)
+                {
+                    memcpy(entry.ids, ids, sizeof(entry.ids));
+                    entry.vertex_id = new_id;
+                    is_new = true;
+                    return new_id;
+                }
+                if (!memcmp(entry.ids, ids, sizeof(entry.ids)))
+                {
+                    is_new = false;
+                    return entry.vertex_id;
+                }
+                e_id = (e_id + 1) & mask;
+            }
+        }
+    };
+
+    // normals of vertices without one are sums of face normals
+    void compute_normals(std::vector<Vertex>& vertices,
+        const std::vector<GLuint>& indices, const std::vector<bool>& missing)
+    {
+        for (size_t i_id = 0; i_id + 2 < indices.size(); i_id += 3)
+        {
+            Vertex* tri[3] = { &vertices[indices[i_id]],
+                &vertices[indices[i_id + 1]], &vertices[indices[i_id + 2]] };
+            glm::vec3 normal = glm::cross(tri[1]->position - tri[0]->position,
+                                          tri[2]->position - tri[0]->position);
+            for (size_t c_id = 0; c_id < 3; ++c_id)
+            {
+                if (missing[indices[i_id + c_id]])
+                    tri[c_id]->normal += normal;
+            }
+        }
+        for (size_t v_id = 0; v_id < vertices.size(); ++v_id)
+        {
+            float len = glm::length(vertices[v_id].normal);
+            if (missing[v_id] && len > 0.0f)
+                vertices[v_id].normal /= len;
+        }
+    }
+
+    // tangents of triangles are summed per vertex, then made
+    // orthogonal to normal
+    void compute_tangents(std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+    {
+        for (size_t i_id = 0; i_id + 2 < indices.size(); i_id += 3)
+        {
+            Vertex& v0 = vertices[indices[i_id]];
+            Vertex& v1 = vertices[indices[i_id + 1]];
+            Vertex& v2 = vertices[indices[i_id + 2]];
+            glm::vec3 edge1 = v1.position - v0.position;
+            glm::vec3 edge2 = v2.position - v0.position;
+            glm::vec2 duv1 = v1.tex_coord - v0.tex_coord;
+            glm::vec2 duv2 = v2.tex_coord - v0.tex_coord;
+            float det = duv1.x * duv2.y - duv2.x * duv1.y;
+            if (det == 0.0f)
+                continue;
+            float inv_det = 1.0f / det;
+            glm::vec3 tangent = (edge1 * duv2.y - edge2 * duv1.y) * inv_det;
+            glm::vec3 bitangent = (edge2 * duv1.x - edge1 * duv2.x) * inv_det;
+            v0.tangent += tangent;
+            v1.tangent += tangent;
+            v2.tangent += tangent;
+            v0.bitangent += bitangent;
+            v1.bitangent += bitangent;
+            v2.bitangent += bitangent;
+        }
+        for (size_t v_id = 0; v_id < vertices.size(); ++v_id)
+        {
+            Vertex& vertex = vertices[v_id];
+            glm::vec3 tangent = vertex.tangent - vertex.normal * glm::dot(vertex.normal, vertex.tangent);
+            float len = glm::length(tangent);
+            vertex.tangent = len > 0.0f ? tangent / len : glm::vec3(0.0f);
+            len = glm::length(vertex.bitangent);
+            if (len > 0.0f)
+                vertex.bitangent /= len;
+        }
+    }
+
+    // texture order of ObjModel, -1 if map isn't used
+    int get_texture_rank(const char* p, const char* end, const char*& type)
+    {
+        static const char* const keywords[] = { "map_Kd", "map_Ks", "map_Bump", "map_bump", "bump", "map_Ka" };
+        static const int ranks[] = { 0, 1, 2, 2, 2, 3 };
+        static const char* const types[] = { "texture_diffuse", "texture_specular", "texture_normal", "texture_height" };
+        for (size_t k_id = 0; k_id < sizeof(keywords) / sizeof(keywords[0]); ++k_id)
+        {
+            if (match_keyword(p, end, keywords[k_id]))
+            {
+                type = types[ranks[k_id]];
+                return ranks[k_id];
+            }
+        }
+        return -1;
+    }
+}
+
+const char* ObjFileParser::parse_int(const char* str, const char* end, int& value)
+{
+    const char* p = str;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !is_digit(*p))
+        return nullptr;
+    int64_t res = 0;
+    for (; p < end && is_digit(*p); ++p)
+    {
+        if (res < INT32_MAX)
+            res = res * 10 + (*p - '0');
+    }
+    if (res > INT32_MAX)
+        res = INT32_MAX;
+    value = int(negative ? -res : res);
+    return p;
+}
+
+const char* ObjFileParser::parse_float(const char* str, const char* end, float& value)
+{
+    // exactly representable powers of 10
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* p = str;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    // 19 significant digits fit in mantissa
+    uint64_t mantissa = 0;
+    int exponent = 0, digit_num = 0;
+    bool has_digit = false;
+    for (; p < end && is_digit(*p); ++p)
+    {
+        has_digit = true;
+        if (digit_num < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa)
+                ++digit_num;
+        }
+        else
+            ++exponent;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && is_digit(*p); ++p)
+        {
+            has_digit = true;
+            if (digit_num < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa)
+                    ++digit_num;
+                --exponent;
+            }
+        }
+    }
+    if (!has_digit)
+        return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        int exp_value = 0;
+        const char* exp_end = parse_int(p + 1, end, exp_value);
+        if (exp_end)
+        {
+            exponent += exp_value < -1000 ? -1000 : (exp_value > 1000 ? 1000 : exp_value);
+            p = exp_end;
+        }
+    }
+
+    double res = double(mantissa);
+    if (mantissa == 0)
+        res = 0.0;
+    else if (exponent >= 0 && exponent <= 22)
+        res *= pow10[exponent];
+    else if (exponent < 0 && exponent >= -22)
+        res /= pow10[-exponent];
+    else
+        res *= std::pow(10.0, double(exponent));
+    value = float(negative ? -res : res);
+    return p;
+}
+
+const ObjFileParser::Material* ObjFileParser::find_material(const std::string& name) const
+{
+    for (size_t m_id = 0; m_id < materials.size(); ++m_id)
+    {
+        if (materials[m_id].name == name)
+            return &materials[m_id];
+    }
+    return nullptr;
+}
+
+int ObjFileParser::load_materials(const std::string& filename)
+{
+    MappedFile file;
+    if (file.open(filename.c_str()))
+        return -1;
+
+    // textures of current material by rank
+    std::vector<Texture> textures[4];
+    std::string name;
+    bool has_material = false;
+    auto add_material = [&]()
+    {
+        if (!has_material)
+            return;
+        materials.emplace_back();
+        Material& material = materials.back();
+        material.name = name;
+        for (size_t r_id = 0; r_id < 4; ++r_id)
+        {
+            material.textures.insert(material.textures.end(), textures[r_id].begin(), textures[r_id].end());
+            textures[r_id].clear();
+        }
+    };
+
+    const char* p = file.get_data();
+    const char* end = p + file.get_size();
+    while (p < end)
+    {
+        const char* line_end = (const char*)memchr(p, '\n', end - p);
+        if (!line_end)
+            line_end = end;
+        const char* line = skip_space(p, line_end);
+        const char* type = nullptr;
+        int rank;
+        if (match_keyword(line, line_end, "newmtl"))
+        {
+            add_material();
+            name = get_name(line + 6, line_end);
+            has_material = true;
+        }
+        else if (has_material && (rank = get_texture_rank(line, line_end, type)) >= 0)
+        {
+            Texture texture;
+            texture.filename = get_last_word(line, line_end);
+            texture.type = type;
+            texture.id = 0;
+            textures[rank].push_back(texture);
+        }
+        p = line_end + 1;
+    }
+    add_material();
+    return 0;
+}
+
+int ObjFileParser::load(const char* filename, std::vector<MeshGLBuffer>& meshes)
+{
+    material_filenames.clear();
+
+    MappedFile file;
+    if (file.open(filename))
+        return -1;
+    std::string directory(filename);
+    size_t dir_end = directory.find_last_of("/\\");
+    directory = dir_end == std::string::npos ? std::string(".") : directory.substr(0, dir_end);
+
+    // 0 means default thread number
+    const size_t worker_num = thread_num ? thread_num : get_default_thread_num();
+
+    // line aligned chunks
+    const char* data = file.get_data();
+    const char* data_end = data + file.get_size();
+    size_t chunk_num = worker_num;
+    // at least 64 KB per chunk
+    const size_t min_chunk_size = 65536;
+    if (chunk_num > file.get_size() / min_chunk_size)
+        chunk_num = file.get_size() / min_chunk_size;
+    if (chunk_num == 0)
+        chunk_num = 1;
+    std::vector<Chunk> chunks(chunk_num);
+    const char* chunk_begin = data;
+    for (size_t c_id = 0; c_id < chunk_num; ++c_id)
+    {
+        const char* chunk_end = data + file.get_size() * (c_id + 1) / chunk_num;
+        if (chunk_end < chunk_begin)
+            chunk_end = chunk_begin;
+        if (c_id + 1 == chunk_num)
+            chunk_end = data_end;
+        else
+        {
+            const char* line_end = (const char*)memchr(chunk_end, '\n', data_end - chunk_end);
+            chunk_end = line_end ? line_end + 1 : data_end;
+        }
+        chunks[c_id].begin = chunk_begin;
+        chunks[c_id].end = chunk_end;
+        chunk_begin = chunk_end;
+    }
+
+    parallel_for(chunk_num, chunk_num,
+        [&](size_t th_id, size_t begin, size_t end)
+        {
+            for (size_t c_id = begin; c_id < end; ++c_id)
+                parse_chunk(chunks[c_id]);
+        });
+
+    // offsets of chunk data
+    std::vector<size_t> offsets[3];
+    size_t totals[3] = { 0, 0, 0 };
+    size_t line_offset = 0, triangle_num = 0;
+    for (size_t c_id = 0; c_id < chunk_num; ++c_id)
+    {
+        Chunk& chunk = chunks[c_id];
+        if (chunk.error_line)
+        {
+            std::cout << "ObjFileParser: " << filename << " has invalid line "
+                      << line_offset + chunk.error_line << ".\n";
+            return -1;
+        }
+        line_offset += chunk.line_num;
+        const size_t counts[3] = { chunk.positions.size(), chunk.tex_coords.size(), chunk.normals.size() };
+        for (size_t i_id = 0; i_id < 3; ++i_id)
+        {
+            offsets[i_id].push_back(totals[i_id]);
+            totals[i_id] += counts[i_id];
+        }
+        triangle_num += chunk.corners.size() / 3;
+    }
+    if (triangle_num == 0)
+    {
+        std::cout << "ObjFileParser: " << filename << " has no faces.\n";
+        return -1;
+    }
+
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> tex_coords;
+    positions.reserve(totals[0]);
+    tex_coords.reserve(totals[1]);
+    normals.reserve(totals[2]);
+    for (size_t c_id = 0; c_id < chunk_num; ++c_id)
+    {
+        Chunk& chunk = chunks[c_id];
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        tex_coords.insert(tex_coords.end(), chunk.tex_coords.begin(), chunk.tex_coords.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    }
+
+    // resolve relative indices and check range
+    std::vector<size_t> invalid_nums(chunk_num, 0);
+    parallel_for(chunk_num, chunk_num,
+        [&](size_t th_id, size_t begin, size_t end)
+        {
+            for (size_t c_id = begin; c_id < end; ++c_id)
+            {
+                std::vector<Corner>& corners = chunks[c_id].corners;
+                for (size_t cn_id = 0; cn_id < corners.size(); ++cn_id)
+                {
+                    Corner& corner = corners[cn_id];
+                    for (size_t i_id = 0; i_id < 3; ++i_id)
+                    {
+                        if (corner.relative_bits & (1u << i_id))
+                            corner.ids[i_id] += int32_t(offsets[i_id][c_id]);
+                        if (corner.ids[i_id] >= int32_t(totals[i_id]) ||
+                            (corner.ids[i_id] < 0 && (i_id == 0 || (corner.relative_bits & (1u << i_id)))))
+                            ++invalid_nums[c_id];
+                    }
+                    corner.relative_bits = 0;
+                }
+            }
+        });
+    for (size_t c_id = 0; c_id < chunk_num; ++c_id)
+    {
+        if (invalid_nums[c_id])
+        {
+            std::cout << "ObjFileParser: " << filename << " has face indices out of range.\n";
+            return -1;
+        }
+    }
+
+    std::vector<std::string> mtl_filenames;
+    for (size_t c_id = 0; c_id < chunk_num; ++c_id)
+    {
+        for (size_t f_id = 0; f_id < chunks[c_id].mtl_filenames.size(); ++f_id)
+        {
+            const std::string& mtl_filename = chunks[c_id].mtl_filenames[f_id];
+            if (std::find(mtl_filenames.begin(), mtl_filenames.end(), mtl_filename) != mtl_filenames.end())
+                continue;
+            mtl_filenames.push_back(mtl_filename);
+            material_filenames.push_back(directory + '/' + mtl_filename);
+            // missing mtl file leaves meshes without textures
+            load_materials(material_filenames.back());
+        }
+    }
+
+    // group triangles by material in order of first use
+    std::unordered_map<std::string, size_t> mesh_ids;
+    std::vector<std::string> mesh_materials;
+    std::vector<std::vector<TriangleRange>> mesh_ranges;
+    std::string cur_material;
+    for (size_t c_id = 0; c_id < chunk_num; ++c_id)
+    {
+        const Chunk& chunk = chunks[c_id];
+        size_t chunk_triangle_num = chunk.corners.size() / 3;
+        for (size_t s_id = 0; s_id <= chunk.switches.size(); ++s_id)
+        {
+            TriangleRange range;
+            range.chunk_id = c_id;
+            range.begin = s_id > 0 ? chunk.switches[s_id - 1].triangle_id : 0;
+            range.end = s_id < chunk.switches.size() ? chunk.switches[s_id].triangle_id : chunk_triangle_num;
+            if (s_id > 0)
+                cur_material = chunk.switches[s_id - 1].name;
+            if (range.begin == range.end)
+                continue;
+            auto iter = mesh_ids.find(cur_material);
+            if (iter == mesh_ids.end())
+            {
+                iter = mesh_ids.insert(std::make_pair(cur_material, mesh_ranges.size())).first;
+                mesh_materials.push_back(cur_material);
+                mesh_ranges.emplace_back();
+            }
+            mesh_ranges[iter->second].push_back(range);
+        }
+    }
+
+    // vertices of meshes in parallel
+    size_t first_mesh_id = meshes.size();
+    size_t mesh_num = mesh_ranges.size();
+    meshes.resize(first_mesh_id + mesh_num);
+    parallel_for(mesh_num, worker_num,
+        [&](size_t th_id, size_t begin, size_t end)
+        {
+            for (size_t m_id = begin; m_id < end; ++m_id)
+            {
+                MeshGLBuffer& mesh = meshes[first_mesh_id + m_id];
+                const std::vector<TriangleRange>& ranges = mesh_ranges[m_id];
+                size_t corner_num = 0;
+                for (size_t r_id = 0; r_id < ranges.size(); ++r_id)
+                    corner_num += (ranges[r_id].end - ranges[r_id].begin) * 3;
+
+                std::vector<Vertex>& vertices = mesh.get_vertices();
+                std::vector<GLuint>& indices = mesh.get_indices();
+                std::vector<bool> missing_normals;
+                bool has_missing_normal = false;
+                indices.reserve(corner_num);
+                CornerMap corner_map(corner_num);
+                for (size_t r_id = 0; r_id < ranges.size(); ++r_id)
+                {
+                    const TriangleRange& range = ranges[r_id];
+                    const std::vector<Corner>& corners = chunks[range.chunk_id].corners;
+                    for (size_t cn_id = range.begin * 3; cn_id < range.end * 3; ++cn_id)
+                    {
+                        const Corner& corner = corners[cn_id];
+                        bool is_new;
+                        GLuint v_id = corner_map.insert(corner.ids, GLuint(vertices.size()), is_new);
+                        indices.push_back(v_id);
+                        if (!is_new)
+                            continue;
+                        Vertex vertex;
+                        vertex.position = positions[corner.ids[0]];
+                        vertex.tex_coord = corner.ids[1] >= 0 ? tex_coords[corner.ids[1]] : glm::vec2(0.0f);
+                        vertex.normal = corner.ids[2] >= 0 ? normals[corner.ids[2]] : glm::vec3(0.0f);
+                        vertex.tangent = glm::vec3(0.0f);
+                        vertex.bitangent = glm::vec3(0.0f);
+                        vertices.push_back(vertex);
+                        missing_normals.push_back(corner.ids[2] < 0);
+                        has_missing_normal = has_missing_normal || corner.ids[2] < 0;
+                    }
+                }
+                if (has_missing_normal)
+                    compute_normals(vertices, indices, missing_normals);
+                compute_tangents(vertices, indices);
+
+                const Material* material = find_material(mesh_materials[m_id]);
+                if (material)
+                    mesh.get_textures() = material->textures;
+            }
+        });
+    return 0;
+}
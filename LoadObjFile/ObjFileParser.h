@@ -0,0 +1,59 @@
+#ifndef __Obj_File_Parser_h__
+#define __Obj_File_Parser_h__
+
+#include <string>
+#include <vector>
+
+#include "MeshGLBuffer.h"
+
+// Native loader of Wavefront OBJ files with MTL materials, a fast
+// alternative to Assimp for plain OBJ assets. The file is mapped and
+// split into line aligned chunks parsed by parallel threads.
+// Results match Assimp with aiProcess_Triangulate, aiProcess_FlipUVs
+// and aiProcess_CalcTangentSpace: faces are triangulated as fans,
+// v of tex coords is flipped and tangents are generated. Corners
+// with the same position, tex coord and normal indices share one
+// vertex. There is one mesh per material, normals missing in file
+// are computed from faces.
+class ObjFileParser
+{
+public:
+    struct Material
+    {
+        std::string name;
+        // ids are 0, in order of ObjModel: diffuse, specular,
+        // normal (map_Bump) and height (map_Ka) maps
+        std::vector<Texture> textures;
+    };
+
+protected:
+    size_t thread_num;
+    std::vector<Material> materials;
+    // mtl files referenced by the last loaded obj file
+    std::vector<std::string> material_filenames;
+
+    // append materials of mtl file, return 0 if success
+    int load_materials(const std::string& filename);
+    const Material* find_material(const std::string& name) const;
+
+public:
+    ObjFileParser() : thread_num(0) {}
+
+    // 0 uses all hardware threads
+    inline void set_thread_num(size_t num) { thread_num = num; }
+    inline const std::vector<Material>& get_materials() const { return materials; }
+    // paths as opened, including files that are missing
+    inline const std::vector<std::string>& get_material_filenames() const { return material_filenames; }
+
+    // Append one mesh per material to meshes, gl buffers aren't set
+    // up. Texture ids are 0 and filenames are relative to directory
+    // of obj file. Return 0 if success, -1 if fails.
+    int load(const char* filename, std::vector<MeshGLBuffer>& meshes);
+
+    // Number at [str, end), e.g. "-1.5e-3", return position after it
+    // or nullptr if there is no number
+    static const char* parse_float(const char* str, const char* end, float& value);
+    static const char* parse_int(const char* str, const char* end, int& value);
+};
+
+#endif
@@ -1,17 +1,41 @@
 #include <map>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include <assimp/DefaultIOSystem.h>
+
+#include "GLStateCache.h"
 #include "ObjModel.h"
 
+namespace
+{
+    // Remember files assimp opens, e.g. mtl files of the model
+    class RecordingIOSystem : public Assimp::DefaultIOSystem
+    {
+    public:
+        std::vector<std::string> filenames;
+
+        Assimp::IOStream* Open(const char* file, const char* mode = "rb") override
+        {
+            Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file, mode);
+            if (stream)
+                filenames.push_back(file);
+            return stream;
+        }
+    };
+}
+
 ObjModel::~ObjModel()
 {
     // delete textures from gl buffers
     for (auto iter = textures_map.begin();
          iter != textures_map.end(); ++iter)
-        glDeleteTextures(1, &iter->second);
+        GLStateCache::get().delete_textures(1, &iter->second);
 }
 
 void ObjModel::print_info()
@@ -21,8 +45,8 @@ void ObjModel::print_info()
     {
         MeshGLBuffer& mh = meshes[mh_id];
         std::cout << "mesh " << mh_id << ":\n"
-            << "  " << mh.get_vertices().size() << " nodes\n"
-            << "  " << mh.get_indices().size() << " indices\n"
+            << "  " << mh.get_vertex_num() << " nodes\n"
+            << "  " << mh.get_index_num() << " indices\n"
             << "  " << mh.get_textures().size() << " textures\n";
         size_t tex_num = mh.get_textures().size();
         for (size_t t_id = 0; t_id < tex_num; ++t_id)
@@ -36,22 +60,146 @@ void ObjModel::print_info()
 void ObjModel::load_model(const char *model_filename)
 {
     std::string md_filename(model_filename);
-    
-    // import model
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(md_filename,
-        aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-    {
-        std::cout << "ASSIMP::ERROR::" << importer.GetErrorString() << "\n";
-        return;
-    }
 
     // retrieve the directory of filename
     // for loading textures
     directory = md_filename.substr(0, md_filename.find_last_of('/'));
+    texture_filenames.clear();
+
+    std::string cache_filename;
+    if (!cache_dir.empty())
+    {
+        cache_filename = get_cache_filename(model_filename);
+        if (load_from_cache(cache_filename.c_str(), model_filename) == 0)
+            return;
+    }
+    const size_t first_mesh_id = meshes.size();
+
+    size_t ext_pos = md_filename.find_last_of('.');
+    std::string ext = ext_pos == std::string::npos ? "" : md_filename.substr(ext_pos);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    bool loaded = false;
+    // cache is stale if they change, e.g. mtl files
+    std::vector<std::string> dependency_filenames;
+    if (ext == ".obj")
+    {
+        loaded = load_obj_file(model_filename, dependency_filenames) == 0;
+        if (!loaded)
+            std::cout << "ObjModel: Load " << md_filename << " with Assimp.\n";
+    }
 
-    process_node(scene->mRootNode, scene);
+    if (!loaded)
+    {
+        // import model, importer owns and deletes io_system
+        Assimp::Importer importer;
+        RecordingIOSystem* io_system = new RecordingIOSystem;
+        importer.SetIOHandler(io_system);
+        const aiScene* scene = importer.ReadFile(md_filename,
+            aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        {
+            std::cout << "ASSIMP::ERROR::" << importer.GetErrorString() << "\n";
+            return;
+        }
+
+        process_node(scene->mRootNode, scene);
+        for (size_t f_id = 0; f_id < io_system->filenames.size(); ++f_id)
+        {
+            if (io_system->filenames[f_id] != md_filename)
+                dependency_filenames.push_back(io_system->filenames[f_id]);
+        }
+    }
+    // textures which failed to load are dropped from meshes,
+    // so the cache is also stale when one appears
+    dependency_filenames.insert(dependency_filenames.end(),
+        texture_filenames.begin(), texture_filenames.end());
+    std::sort(dependency_filenames.begin(), dependency_filenames.end());
+    dependency_filenames.erase(std::unique(dependency_filenames.begin(),
+        dependency_filenames.end()), dependency_filenames.end());
+
+    if (!cache_filename.empty() && meshes.size() > first_mesh_id)
+        MeshCacheFile::write(cache_filename.c_str(), model_filename,
+            &meshes[first_mesh_id], meshes.size() - first_mesh_id,
+            dependency_filenames);
+}
+
+std::string ObjModel::get_cache_filename(const char *model_filename) const
+{
+    // FNV-1a hash of model path
+    unsigned long long hash = 14695981039346656037ULL;
+    for (const char *c = model_filename; *c; ++c)
+        hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+
+    char name[32];
+    snprintf(name, sizeof(name), "mesh_%016llx.mshc", hash);
+    return cache_dir + '/' + name;
+}
+
+int ObjModel::load_from_cache(const char *cache_filename, const char *model_filename)
+{
+    MeshCacheFile file;
+    if (file.open(cache_filename) || !file.is_up_to_date(model_filename))
+        return -1;
+
+    // blobs go to gl buffers as mapped, vertices
+    // and indices of meshes stay empty
+    meshes.reserve(meshes.size() + file.get_mesh_num());
+    for (size_t mh_id = 0; mh_id < file.get_mesh_num(); ++mh_id)
+    {
+        const MeshCacheMesh &cache_mesh = file.get_mesh(mh_id);
+        meshes.emplace_back();
+        MeshGLBuffer &mesh = meshes.back();
+
+        // textures which can't be loaded are skipped
+        const MeshCacheMaterial &material = file.get_material(cache_mesh.material_id);
+        std::vector<Texture> &textures = mesh.get_textures();
+        for (uint32_t t_id = 0; t_id < material.texture_num; ++t_id)
+        {
+            const MeshCacheTexture &cache_texture = file.get_texture(material.first_texture + t_id);
+            GLuint texture_id = get_texture(cache_texture.filename);
+            if (texture_id)
+            {
+                textures.emplace_back();
+                Texture &texture = textures.back();
+                texture.filename = cache_texture.filename;
+                texture.type = cache_texture.type;
+                texture.id = texture_id;
+            }
+        }
+
+        mesh.setup_gl_buffer(file.get_vertices(mh_id), size_t(cache_mesh.vertex_num),
+            file.get_indices(mh_id), size_t(cache_mesh.index_num));
+    }
+    return 0;
+}
+
+int ObjModel::load_obj_file(
+    const char *model_filename,
+    std::vector<std::string> &material_filenames
+    )
+{
+    ObjFileParser parser;
+    size_t first_mesh_id = meshes.size();
+    if (parser.load(model_filename, meshes))
+        return -1;
+    material_filenames.insert(material_filenames.end(),
+        parser.get_material_filenames().begin(), parser.get_material_filenames().end());
+
+    for (size_t mh_id = first_mesh_id; mh_id < meshes.size(); ++mh_id)
+    {
+        // textures which can't be loaded are skipped
+        std::vector<Texture> &textures = meshes[mh_id].get_textures();
+        size_t tex_num = 0;
+        for (size_t t_id = 0; t_id < textures.size(); ++t_id)
+        {
+            textures[t_id].id = get_texture(textures[t_id].filename.c_str());
+            if (textures[t_id].id)
+                textures[tex_num++] = textures[t_id];
+        }
+        textures.resize(tex_num);
+        meshes[mh_id].setup_gl_buffer();
+    }
+    return 0;
 }
 
 void ObjModel::process_node(aiNode* node, const aiScene* scene)
@@ -68,7 +216,6 @@ void ObjModel::process_node(aiNode* node, const aiScene* scene)
     }
 
     // recursively process children nodes
-    if (node->mNumChildren) node->mNumChildren = 2; //debug
     for (GLuint c_id = 0; c_id < node->mNumChildren; ++c_id)
         process_node(node->mChildren[c_id], scene);
 }
@@ -179,7 +326,7 @@ static GLuint load_texture_from_file(
         }
 
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLStateCache::get().bind_texture(GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -213,22 +360,7 @@ void ObjModel::load_material_textures(
     {
         aiString str;
         mat->GetTexture(type, t_id, &str);
-        auto iter = textures_map.find(str.C_Str());
-        if (iter != textures_map.end())
-        {
-            texture_id = iter->second;
-        }
-        else
-        {
-            texture_id = load_texture_from_file(str.C_Str(), this->directory);
-            textures_map.insert(std::pair<std::string, GLuint>(str.C_Str(), texture_id));
-            if (!texture_id)
-            {
-                std::cout << "Error::ObjModel:: can't find texture image " << str.C_Str()
-                          << " in path " << directory << ".\n";
-            }
-        }
-        
+        texture_id = get_texture(str.C_Str());
         if (texture_id)
         {
             textures.emplace_back();
@@ -239,3 +371,20 @@ void ObjModel::load_material_textures(
         }
     }
 }
+
+GLuint ObjModel::get_texture(const char *texture_filename)
+{
+    texture_filenames.push_back(directory + '/' + texture_filename);
+    auto iter = textures_map.find(texture_filename);
+    if (iter != textures_map.end())
+        return iter->second;
+
+    GLuint texture_id = load_texture_from_file(texture_filename, this->directory);
+    textures_map.insert(std::pair<std::string, GLuint>(texture_filename, texture_id));
+    if (!texture_id)
+    {
+        std::cout << "Error::ObjModel:: can't find texture image " << texture_filename
+                  << " in path " << directory << ".\n";
+    }
+    return texture_id;
+}
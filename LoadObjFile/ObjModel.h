@@ -16,6 +16,8 @@
 
 #include "OpenGLShaderUtilities.h"
 #include "MeshGLBuffer.h"
+#include "ObjFileParser.h"
+#include "MeshCacheFile.h"
 
 class ObjModel
 {
@@ -26,11 +28,22 @@ protected:
 
     // map texture filename to id
     std::unordered_map<std::string, GLuint> textures_map;
+    // textures requested by the model being loaded, cache dependencies
+    std::vector<std::string> texture_filenames;
+
+    // directory for mesh cache files, disabled if empty
+    std::string cache_dir;
 
 public:
     ObjModel() {}
     ~ObjModel();
 
+    // imported meshes are cached in binary files under dir,
+    // later loads of the unchanged model map the cache
+    inline void set_cache_dir(const char *dir) { cache_dir = dir ? dir : ""; }
+
+    // .obj files are loaded by ObjFileParser, other formats
+    // and obj files it fails to load by Assimp
     void load_model(const char *model_filename);
 
     void draw(OpenGLShaderProgram &shader)
@@ -39,10 +52,48 @@ public:
             meshes[m_id].draw(shader);
     }
 
+    // Meshes are drawn with the variant for their textures, grouped
+    // so that each variant is bound once. set_uniforms(program, key)
+    // is called after a variant is bound.
+    template <typename SetUniforms>
+    void draw(OpenGLShaderVariants &variants, SetUniforms set_uniforms)
+    {
+        const size_t variant_num = size_t(1) << variants.get_define_num();
+        for (OpenGLShaderVariants::Key key = 0; key < variant_num; ++key)
+        {
+            OpenGLShaderProgram* program = nullptr;
+            for (size_t m_id = 0; m_id < meshes.size(); ++m_id)
+            {
+                if (meshes[m_id].get_variant_key() != key)
+                    continue;
+                if (!program)
+                {
+                    program = variants.get(key);
+                    if (!program)
+                        break;
+                    program->use();
+                    set_uniforms(*program, key);
+                }
+                meshes[m_id].draw(*program);
+            }
+        }
+    }
+
     // for debug
     void print_info();
 
 protected:
+    // return 0 if success, mtl files it read are
+    // appended to material_filenames
+    int load_obj_file(const char *model_filename,
+        std::vector<std::string> &material_filenames);
+    // texture in directory, loaded once, 0 if it fails
+    GLuint get_texture(const char *texture_filename);
+
+    std::string get_cache_filename(const char *model_filename) const;
+    // return 0 if cache is up to date and loaded
+    int load_from_cache(const char *cache_filename, const char *model_filename);
+
     // processes each mesh node recursively.
     void process_node(aiNode* node, const aiScene* scene);
 
@@ -0,0 +1,155 @@
+#include <cmath>
+#include <cstdint>
+
+#include "ParallelFor.h"
+
+#include "ApproxBlueNoiseSampling.h"
+
+// stateless hash so that every point can be generated independently
+static inline uint32_t hash_u32(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+// random double in [0, 1)
+static inline double hash_double(uint32_t x)
+{
+	return double(hash_u32(x)) * (1.0 / 4294967296.0);
+}
+
+ApproxBlueNoiseSampling::ApproxBlueNoiseSampling(Mode _mode) :
+	mode(_mode), jitter(0.5), thread_num(0)
+{
+
+}
+
+int ApproxBlueNoiseSampling::generate_points_in_rect(
+	double xl, double xu, double yl, double yu,
+	double dist_min)
+{
+	points.clear();
+	if (dist_min <= 0.0 || xu <= xl || yu <= yl)
+		return -1;
+
+	double amp = jitter < 0.0 ? 0.0 : (jitter > 1.0 ? 1.0 : jitter);
+	switch (mode)
+	{
+	case JitteredGrid:
+		gen_lattice_points(xl, xu, yl, yu, dist_min, dist_min, false, amp);
+		break;
+	case HexJitter:
+		gen_lattice_points(xl, xu, yl, yu,
+			dist_min, dist_min * sqrt(3.0) * 0.5, true, amp);
+		break;
+	case RelaxedStratified:
+		gen_lattice_points(xl, xu, yl, yu, dist_min, dist_min, false, 1.0);
+		relax_points(xl, xu, yl, yu, dist_min);
+		break;
+	default:
+		return -1;
+	}
+
+	PointSetSort sorter;
+	sorter.set_thread_num(thread_num);
+	sorter.sort(points, xl, xu, yl, yu, sort_key);
+	return 0;
+}
+
+void ApproxBlueNoiseSampling::gen_lattice_points(
+	double xl, double xu, double yl, double yu,
+	double hx, double hy, bool is_hex, double amp)
+{
+	size_t row_num = size_t((yu - yl) / hy);
+	if (row_num == 0)
+		row_num = 1;
+	// odd rows of hex lattice are shifted by half spacing
+	const double col_num_f = (xu - xl) / hx;
+	size_t even_col_num = size_t(col_num_f);
+	if (even_col_num == 0)
+		even_col_num = 1;
+	// narrow hex domains may have no odd columns, square lattice
+	// keeps the same column number for relax_points
+	size_t odd_col_num = is_hex ?
+		size_t(col_num_f > 0.5 ? col_num_f - 0.5 : 0.0) : even_col_num;
+
+	size_t pt_num = (row_num + 1) / 2 * even_col_num
+				  + row_num / 2 * odd_col_num;
+	points.resize(pt_num);
+
+	const uint32_t seed_hash = hash_u32(seed);
+	parallel_for(row_num, thread_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t r_id = begin; r_id < end; ++r_id)
+		{
+			bool is_odd = (r_id & 1) != 0;
+			size_t col_num = is_odd ? odd_col_num : even_col_num;
+			size_t p_id = (r_id + 1) / 2 * even_col_num
+						+ r_id / 2 * odd_col_num;
+			double x_off = xl + hx * (is_odd && is_hex ? 1.0 : 0.5);
+			double y_cen = yl + hy * (double(r_id) + 0.5);
+			for (size_t c_id = 0; c_id < col_num; ++c_id, ++p_id)
+			{
+				uint32_t key = uint32_t(p_id) * 2 + seed_hash;
+				glm::vec2 &pt = points[p_id];
+				pt.x = float(x_off + hx * (double(c_id) + amp * (hash_double(key) - 0.5)));
+				pt.y = float(y_cen + hy * amp * (hash_double(key + 1) - 0.5));
+			}
+		}
+	});
+}
+
+void ApproxBlueNoiseSampling::relax_points(
+	double xl, double xu, double yl, double yu,
+	double dist_min)
+{
+	// points are on a square lattice generated by gen_lattice_points,
+	// so points closer than dist_min are in adjacent lattice cells
+	size_t row_num = size_t((yu - yl) / dist_min);
+	if (row_num == 0)
+		row_num = 1;
+	size_t col_num = points.size() / row_num;
+
+	std::vector<glm::vec2> pts_old(points);
+	const double dist_min2 = dist_min * dist_min;
+	parallel_for(row_num, thread_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t r_id = begin; r_id < end; ++r_id)
+			for (size_t c_id = 0; c_id < col_num; ++c_id)
+			{
+				const glm::vec2 &p = pts_old[r_id * col_num + c_id];
+				double dx_sum = 0.0, dy_sum = 0.0;
+				size_t nr_l = r_id ? r_id - 1 : 0;
+				size_t nr_u = r_id + 1 < row_num ? r_id + 1 : r_id;
+				size_t nc_l = c_id ? c_id - 1 : 0;
+				size_t nc_u = c_id + 1 < col_num ? c_id + 1 : c_id;
+				for (size_t nr_id = nr_l; nr_id <= nr_u; ++nr_id)
+					for (size_t nc_id = nc_l; nc_id <= nc_u; ++nc_id)
+					{
+						const glm::vec2 &q = pts_old[nr_id * col_num + nc_id];
+						double dx = double(p.x) - double(q.x);
+						double dy = double(p.y) - double(q.y);
+						double d2 = dx * dx + dy * dy;
+						if (d2 >= dist_min2 || d2 == 0.0)
+							continue;
+						// each point of the pair moves half the overlap
+						double d = sqrt(d2);
+						double s = 0.5 * (dist_min - d) / d;
+						dx_sum += dx * s;
+						dy_sum += dy * s;
+					}
+
+				double x = double(p.x) + dx_sum;
+				double y = double(p.y) + dy_sum;
+				glm::vec2 &pt = points[r_id * col_num + c_id];
+				pt.x = float(x < xl ? xl : (x > xu ? xu : x));
+				pt.y = float(y < yl ? yl : (y > yu ? yu : y));
+			}
+	});
+}
@@ -0,0 +1,60 @@
+#ifndef __Approx_Blue_Noise_Sampling_h__
+#define __Approx_Blue_Noise_Sampling_h__
+
+#include "PointSamplingBase.h"
+
+// Cheap approximations of poisson disk sampling.
+// dist_min is the spacing of the underlying lattice, every point
+// is generated independently so output is fully parallel.
+//   JitteredGrid: square lattice, each point moved randomly inside
+//     jitter * dist_min box. Strong grid peaks remain in the
+//     power spectrum unless jitter is close to 1.
+//   HexJitter: same with hexagonal lattice, 15% denser than square
+//     grid with more isotropic spectrum.
+//   RelaxedStratified: fully jittered grid then one sweep pushing
+//     apart pairs closer than dist_min. Closest to poisson disk in
+//     RDF, several times the cost of the other modes.
+// Run test_approx_sampling to compare quality and throughput
+// against PoissonDiskSampling with PDSAnalysis.
+class ApproxBlueNoiseSampling : public PointSamplingBase
+{
+public:
+	enum Mode
+	{
+		JitteredGrid = 0,
+		HexJitter = 1,
+		RelaxedStratified = 2
+	};
+
+protected:
+	Mode mode;
+	// jitter amplitude as fraction of spacing
+	double jitter;
+	size_t thread_num;
+
+public:
+	ApproxBlueNoiseSampling(Mode _mode = JitteredGrid);
+	~ApproxBlueNoiseSampling() { clear(); }
+
+	inline void set_mode(Mode _mode) { mode = _mode; }
+	inline Mode get_mode() const { return mode; }
+	// guaranteed separation is (1 - jitter) * dist_min
+	// for JitteredGrid and HexJitter
+	inline void set_jitter(double _jitter) { jitter = _jitter; }
+	// 0 means hardware concurrency
+	inline void set_thread_num(size_t num) { thread_num = num; }
+
+	int generate_points_in_rect(
+		double xl, double xu, double yl, double yu,
+		double dist_min) override;
+
+protected:
+	void gen_lattice_points(
+		double xl, double xu, double yl, double yu,
+		double hx, double hy, bool is_hex, double amp);
+	void relax_points(
+		double xl, double xu, double yl, double yu,
+		double dist_min);
+};
+
+#endif
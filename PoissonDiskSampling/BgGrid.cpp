@@ -44,8 +44,8 @@ bool BgGrid::add_point(Point2D& p)
 		p.y < yl || p.y > yu)
 		return false;
 
-	size_t x_id = size_t(floor((p.x - xl) / hx));
-	size_t y_id = size_t(floor((p.y - yl) / hy));
+	size_t x_id, y_id;
+	get_cell_index(p, x_id, y_id);
 	Cell& c = get_cell(x_id, y_id);
 	p.next = c.top;
 	c.top = &p;
@@ -1,6 +1,8 @@
 #ifndef __Bg_Grid_h__
 #define __Bg_Grid_h__
 
+#include <cmath>
+
 #include "pds_utils.h"
 
 class BgGrid
@@ -27,6 +29,20 @@ public:
 	{
 		return cells[y_id * x_num + x_id];
 	}
+	inline size_t get_x_num() const { return x_num; }
+	inline size_t get_y_num() const { return y_num; }
+	inline double get_hx() const { return hx; }
+	inline double get_hy() const { return hy; }
+	// index of cell containing p, p must be in grid
+	inline void get_cell_index(const Point2D& p, size_t &x_id, size_t &y_id) const
+	{
+		x_id = size_t(floor((p.x - xl) / hx));
+		if (x_id >= x_num)
+			x_id = x_num - 1;
+		y_id = size_t(floor((p.y - yl) / hy));
+		if (y_id >= y_num)
+			y_id = y_num - 1;
+	}
 
 	int init(double _xl, double _xu,
 			 double _yl, double _yu,
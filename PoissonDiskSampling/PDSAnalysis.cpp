@@ -0,0 +1,333 @@
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <iostream>
+
+#include "ParallelFor.h"
+#include "BgGrid.h"
+
+#include "PDSAnalysis.h"
+
+#define PI 3.14159265358979323846
+
+PDSAnalysis::PDSAnalysis() :
+	thread_num(0),
+	rdf_dr(0.0), spectrum_df(0.0)
+{
+
+}
+
+int PDSAnalysis::compute_rdf(
+	const glm::vec2 *pts, size_t pt_num,
+	double xl, double xu, double yl, double yu,
+	double r_max, size_t bin_num)
+{
+	rdf.clear();
+	if (pt_num == 0 || bin_num == 0 || r_max <= 0.0)
+		return -1;
+
+	// cell size no less than r_max so that
+	// neighbours are within the adjacent cells
+	size_t x_num = size_t((xu - xl) / r_max);
+	size_t y_num = size_t((yu - yl) / r_max);
+	if (x_num == 0) x_num = 1;
+	if (y_num == 0) y_num = 1;
+	BgGrid grid;
+	grid.init(xl, xu, yl, yu, x_num, y_num);
+
+	std::vector<Point2D> nodes(pt_num);
+	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+	{
+		nodes[p_id].x = pts[p_id].x;
+		nodes[p_id].y = pts[p_id].y;
+		nodes[p_id].next = nullptr;
+		grid.add_point(nodes[p_id]);
+	}
+
+	size_t th_num = thread_num ? thread_num : get_default_thread_num();
+	std::vector<std::vector<size_t>> th_hists(th_num);
+	std::vector<size_t> th_ref_nums(th_num, 0);
+	const double r_max2 = r_max * r_max;
+	const double inv_dr = double(bin_num) / r_max;
+	parallel_for(pt_num, th_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		std::vector<size_t> &hist = th_hists[th_id];
+		hist.assign(bin_num, 0);
+		size_t ref_num = 0;
+		size_t x_id, y_id;
+		for (size_t p_id = begin; p_id < end; ++p_id)
+		{
+			const Point2D &p = nodes[p_id];
+			// skip points whose neighbourhood is cut by boundary
+			if (p.x < xl + r_max || p.x > xu - r_max ||
+				p.y < yl + r_max || p.y > yu - r_max)
+				continue;
+			++ref_num;
+
+			grid.get_cell_index(p, x_id, y_id);
+			size_t cxl = x_id ? x_id - 1 : 0;
+			size_t cxu = x_id + 1 < grid.get_x_num() ? x_id + 1 : x_id;
+			size_t cyl = y_id ? y_id - 1 : 0;
+			size_t cyu = y_id + 1 < grid.get_y_num() ? y_id + 1 : y_id;
+			for (size_t cy_id = cyl; cy_id <= cyu; ++cy_id)
+				for (size_t cx_id = cxl; cx_id <= cxu; ++cx_id)
+				{
+					for (const Point2D *pt = grid.get_cell(cx_id, cy_id).top;
+						 pt; pt = pt->next)
+					{
+						if (pt == &p)
+							continue;
+						double dx = pt->x - p.x;
+						double dy = pt->y - p.y;
+						double d2 = dx * dx + dy * dy;
+						if (d2 < r_max2)
+						{
+							size_t bin_id = size_t(sqrt(d2) * inv_dr);
+							if (bin_id < bin_num)
+								++hist[bin_id];
+						}
+					}
+				}
+		}
+		th_ref_nums[th_id] = ref_num;
+	});
+
+	size_t ref_num = 0;
+	std::vector<size_t> hist(bin_num, 0);
+	for (size_t th_id = 0; th_id < th_num; ++th_id)
+	{
+		ref_num += th_ref_nums[th_id];
+		if (th_hists[th_id].empty())
+			continue;
+		for (size_t b_id = 0; b_id < bin_num; ++b_id)
+			hist[b_id] += th_hists[th_id][b_id];
+	}
+	if (ref_num == 0)
+	{
+		std::cout << "PDSAnalysis: r_max is too large for the domain.\n";
+		return -1;
+	}
+
+	// normalize by expected count of uniform random points in annulus
+	rdf_dr = r_max / double(bin_num);
+	double density = double(pt_num) / ((xu - xl) * (yu - yl));
+	rdf.resize(bin_num);
+	for (size_t b_id = 0; b_id < bin_num; ++b_id)
+	{
+		double r0 = rdf_dr * double(b_id);
+		double r1 = r0 + rdf_dr;
+		double expected = double(ref_num) * density * PI * (r1 * r1 - r0 * r0);
+		rdf[b_id] = double(hist[b_id]) / expected;
+	}
+
+	return 0;
+}
+
+typedef std::complex<double> Complex;
+
+// in-place iterative radix-2 fft, twiddles[k] = exp(-2*pi*i*k/n)
+static void fft(Complex *data, size_t n, const Complex *twiddles)
+{
+	// bit reversal permutation
+	for (size_t i = 1, j = 0; i < n; ++i)
+	{
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j)
+			std::swap(data[i], data[j]);
+	}
+
+	for (size_t len = 2; len <= n; len <<= 1)
+	{
+		size_t half_len = len >> 1;
+		size_t step = n / len;
+		for (size_t i = 0; i < n; i += len)
+			for (size_t j = 0; j < half_len; ++j)
+			{
+				Complex u = data[i + j];
+				Complex v = data[i + j + half_len] * twiddles[j * step];
+				data[i + j] = u + v;
+				data[i + j + half_len] = u - v;
+			}
+	}
+}
+
+int PDSAnalysis::compute_power_spectrum(
+	const glm::vec2 *pts, size_t pt_num,
+	double xl, double xu, double yl, double yu,
+	size_t res)
+{
+	spectrum.clear();
+	if (pt_num == 0)
+	{
+		std::cout << "PDSAnalysis: no points for power spectrum.\n";
+		return -1;
+	}
+	if (res < 2 || (res & (res - 1)))
+	{
+		std::cout << "PDSAnalysis: raster resolution must be power of 2.\n";
+		return -1;
+	}
+
+	size_t th_num = thread_num ? thread_num : get_default_thread_num();
+	const size_t cell_num = res * res;
+
+	// bucket points by lower raster row, so that each thread
+	// splats a band of rows without a raster of its own
+	const double sx = double(res) / (xu - xl);
+	const double sy = double(res) / (yu - yl);
+	std::vector<uint32_t> pt_rows(pt_num);
+	parallel_for(pt_num, th_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t p_id = begin; p_id < end; ++p_id)
+		{
+			double v0 = floor((pts[p_id].y - yl) * sy - 0.5);
+			pt_rows[p_id] = uint32_t(size_t((long long)v0 + (long long)res) % res);
+		}
+	});
+	std::vector<size_t> row_begins(res + 1, 0);
+	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+		++row_begins[pt_rows[p_id] + 1];
+	for (size_t j = 0; j < res; ++j)
+		row_begins[j + 1] += row_begins[j];
+	std::vector<size_t> row_pt_ids(pt_num);
+	{
+		std::vector<size_t> row_ends(row_begins.begin(), row_begins.end() - 1);
+		for (size_t p_id = 0; p_id < pt_num; ++p_id)
+			row_pt_ids[row_ends[pt_rows[p_id]]++] = p_id;
+	}
+	pt_rows.clear();
+
+	// cloud-in-cell weights, periodic boundary, row j gets
+	// points of row j and the upper weights of row j - 1
+	std::vector<Complex> grid(cell_num, Complex(0.0, 0.0));
+	parallel_for(res, th_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t j = begin; j < end; ++j)
+		{
+			Complex *row = &grid[j * res];
+			for (size_t k = 0; k < 2; ++k)
+			{
+				size_t src_row = k ? (j + res - 1) % res : j;
+				for (size_t r_id = row_begins[src_row]; r_id < row_begins[src_row + 1]; ++r_id)
+				{
+					const glm::vec2 &pt = pts[row_pt_ids[r_id]];
+					double u = (pt.x - xl) * sx - 0.5;
+					double v = (pt.y - yl) * sy - 0.5;
+					double u0 = floor(u);
+					double fu = u - u0;
+					double fv = v - floor(v);
+					double wv = k ? fv : 1.0 - fv;
+					size_t i0 = size_t((long long)u0 + (long long)res) % res;
+					size_t i1 = (i0 + 1) % res;
+					row[i0] += (1.0 - fu) * wv;
+					row[i1] += fu * wv;
+				}
+			}
+		}
+	});
+	row_pt_ids.clear();
+
+	std::vector<Complex> twiddles(res / 2);
+	for (size_t k = 0; k < res / 2; ++k)
+		twiddles[k] = std::polar(1.0, -2.0 * PI * double(k) / double(res));
+
+	// rows
+	parallel_for(res, th_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t j = begin; j < end; ++j)
+			fft(&grid[j * res], res, &twiddles[0]);
+	});
+	// columns
+	parallel_for(res, th_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		std::vector<Complex> column(res);
+		for (size_t i = begin; i < end; ++i)
+		{
+			for (size_t j = 0; j < res; ++j)
+				column[j] = grid[j * res + i];
+			fft(&column[0], res, &twiddles[0]);
+			for (size_t j = 0; j < res; ++j)
+				grid[j * res + i] = column[j];
+		}
+	});
+
+	// radial average, frequency unit is 1 / (xu - xl)
+	const double w = xu - xl;
+	const double h = yu - yl;
+	const double aspect = w / h;
+	const size_t bin_num = res / 2;
+	std::vector<double> power_sum(bin_num, 0.0);
+	std::vector<size_t> sample_num(bin_num, 0);
+	const long long half_res = (long long)(res / 2);
+	for (size_t j = 0; j < res; ++j)
+	{
+		long long ky = (long long)j < half_res ? (long long)j : (long long)j - (long long)res;
+		for (size_t i = 0; i < res; ++i)
+		{
+			long long kx = (long long)i < half_res ? (long long)i : (long long)i - (long long)res;
+			if (kx == 0 && ky == 0)
+				continue;
+			double fx = double(kx);
+			double fy = double(ky) * aspect;
+			size_t bin_id = size_t(sqrt(fx * fx + fy * fy) + 0.5);
+			if (bin_id >= bin_num)
+				continue;
+			// undo the cloud-in-cell window sinc^2 in each axis
+			double ax = PI * double(kx) / double(res);
+			double ay = PI * double(ky) / double(res);
+			double wx = kx ? sin(ax) / ax : 1.0;
+			double wy = ky ? sin(ay) / ay : 1.0;
+			double window = wx * wx * wy * wy;
+			power_sum[bin_id] += std::norm(grid[j * res + i]) / (window * window);
+			++sample_num[bin_id];
+		}
+	}
+
+	spectrum_df = 1.0 / w;
+	spectrum.assign(bin_num, 0.0);
+	for (size_t b_id = 1; b_id < bin_num; ++b_id)
+	{
+		if (sample_num[b_id])
+			spectrum[b_id] = power_sum[b_id] / (double(sample_num[b_id]) * double(pt_num));
+	}
+
+	return 0;
+}
+
+int PDSAnalysis::output_rdf_to_csv(const char *filename) const
+{
+	std::fstream file(filename, std::ios::out);
+	if (!file.is_open())
+	{
+		std::cout << "PDSAnalysis: Can't open file " << filename << ".\n";
+		return -1;
+	}
+	file.precision(10);
+	file << "r,g\n";
+	for (size_t b_id = 0; b_id < rdf.size(); ++b_id)
+		file << rdf_dr * (double(b_id) + 0.5) << "," << rdf[b_id] << "\n";
+	return 0;
+}
+
+int PDSAnalysis::output_spectrum_to_csv(const char *filename) const
+{
+	std::fstream file(filename, std::ios::out);
+	if (!file.is_open())
+	{
+		std::cout << "PDSAnalysis: Can't open file " << filename << ".\n";
+		return -1;
+	}
+	file.precision(10);
+	file << "frequency,power\n";
+	for (size_t b_id = 1; b_id < spectrum.size(); ++b_id)
+		file << spectrum_df * double(b_id) << "," << spectrum[b_id] << "\n";
+	return 0;
+}
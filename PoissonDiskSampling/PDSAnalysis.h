@@ -0,0 +1,67 @@
+#ifndef __PDS_Analysis_h__
+#define __PDS_Analysis_h__
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Blue noise quality measurement of point sets:
+//   radial distribution function g(r), binned with BgGrid
+//   radially averaged power spectrum, from FFT of splatted density
+class PDSAnalysis
+{
+protected:
+	size_t thread_num;
+
+	// radial distribution function
+	double rdf_dr;
+	std::vector<double> rdf;
+
+	// radially averaged power spectrum
+	double spectrum_df;
+	std::vector<double> spectrum;
+
+public:
+	PDSAnalysis();
+	~PDSAnalysis() {}
+
+	// 0 means hardware concurrency
+	inline void set_thread_num(size_t num) { thread_num = num; }
+
+	inline const std::vector<double> &get_rdf() const { return rdf; }
+	inline double get_rdf_bin_width() const { return rdf_dr; }
+	inline const std::vector<double> &get_spectrum() const { return spectrum; }
+	inline double get_spectrum_bin_width() const { return spectrum_df; }
+
+	// g(r) for r in [0, r_max), only points further than r_max
+	// from the domain boundary are used as reference points
+	int compute_rdf(const glm::vec2 *pts, size_t pt_num,
+		double xl, double xu, double yl, double yu,
+		double r_max, size_t bin_num);
+	inline int compute_rdf(std::vector<glm::vec2> &pts,
+		double xl, double xu, double yl, double yu,
+		double r_max, size_t bin_num)
+	{
+		return compute_rdf(pts.size() ? &pts[0] : nullptr, pts.size(),
+			xl, xu, yl, yu, r_max, bin_num);
+	}
+
+	// points are splatted into res x res raster (res must be power of 2)
+	// frequencies are in cycles per unit length along x
+	int compute_power_spectrum(const glm::vec2 *pts, size_t pt_num,
+		double xl, double xu, double yl, double yu,
+		size_t res);
+	inline int compute_power_spectrum(std::vector<glm::vec2> &pts,
+		double xl, double xu, double yl, double yu,
+		size_t res)
+	{
+		return compute_power_spectrum(pts.size() ? &pts[0] : nullptr, pts.size(),
+			xl, xu, yl, yu, res);
+	}
+
+	// csv columns: r, g(r)
+	int output_rdf_to_csv(const char *filename) const;
+	// csv columns: frequency, power
+	int output_spectrum_to_csv(const char *filename) const;
+};
+
+#endif
@@ -1,8 +1,19 @@
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
 #include "PoissonDiskSampling.h"
+#include "PoissonDiskSamplingGPU.h"
+#include "PointSetFile.h"
 
 #include "PDSResultView.h"
 
-PDSResultView::PDSResultView()
+PDSResultView::PDSResultView() :
+	use_gpu_sampler(false), lod_density(0.5f),
+	heatmap_ratio(2.0f), density_view(0.0f),
+	view_center(0.0f), view_zoom(1.0f),
+	vp_x(0), vp_y(0), vp_size(1),
+	cursor_x(0.0), cursor_y(0.0)
 {
 
 }
@@ -18,46 +29,157 @@ void PDSResultView::set_square_viewport(int wd, int ht)
 	if (wd >= ht)
 	{
 		padding = (wd - ht) / 2;
-		glViewport(padding, 0, ht, ht);
+		vp_x = padding;
+		vp_y = 0;
+		vp_size = ht;
 	}
 	else
 	{
 		padding = (ht - wd) / 2;
-		glViewport(0, padding, wd, wd);
+		vp_x = 0;
+		vp_y = padding;
+		vp_size = wd;
+	}
+	if (vp_size < 1)
+		vp_size = 1;
+	glViewport(vp_x, vp_y, vp_size, vp_size);
+}
+
+glm::vec2 PDSResultView::cursor_to_view(double xpos, double ypos) const
+{
+	// cursor in framebuffer pixels, y points down from top of window
+	double top = double(height - vp_y - vp_size);
+	return glm::vec2(
+		float((xpos - double(vp_x)) / double(vp_size) * 2.0 - 1.0),
+		float(1.0 - (ypos - top) / double(vp_size) * 2.0));
+}
+
+int PDSResultView::init_points(const glm::vec2 *pts, size_t pt_num, const glm::vec3 &color)
+{
+	points.assign(pts, pts + pt_num);
+	if (pt_num)
+	{
+		// bounding box so that culling never misses points
+		glm::vec2 lower = points[0], upper = points[0];
+		for (size_t p_id = 1; p_id < pt_num; ++p_id)
+		{
+			lower = glm::min(lower, points[p_id]);
+			upper = glm::max(upper, points[p_id]);
+		}
+		upper = glm::max(upper, lower + glm::vec2(1.0e-6f));
+		quadtree.build(points, lower.x, upper.x, lower.y, upper.y);
 	}
+	return point_buf.init(points, 1.0e-4, color);
 }
 
 int PDSResultView::init()
 {
-	// generate point with poisson disk sampling method
-	PoissonDiskSampling pds;
-	pds.generate_points_in_rect(-1.0, 1.0, -1.0, 1.0, 0.02);
-	
 	set_square_viewport(width, height);
 
+	frame_ubo.create(FrameData::layout);
 	point_shader.create("../../Shaders/circles_shader.vert",
 						"../../Shaders/circles_shader.frag");
-	point_shader.use();
-	glm::mat4 proj_mat = glm::ortho(-1.0, 1.0, -1.0, 1.0);
-	point_shader.set_uniform("proj_mat", proj_mat);
+	density_shader.create("../../Shaders/point_density.vert",
+						  "../../Shaders/point_density.frag");
+	density_buf.init(vp_size, vp_size);
+
+	glm::vec3 pt_color(1.0f, 1.0f, 0.804f);
+	PointSetFile pt_file;
+	if (!point_set_filename.empty() &&
+		!pt_file.open(point_set_filename.c_str()) &&
+		pt_file.get_points())
+	{
+		// quadtree order needs a copy of the mapped points
+		init_points(pt_file.get_points(), pt_file.get_point_num(), pt_color);
+		return 0;
+	}
+
+	const double dist_min = 0.02;
+	if (use_gpu_sampler)
+	{
+		// points stay in gpu buffer
+		PoissonDiskSamplingGPU pds_gpu;
+		if (!pds_gpu.init("../../Shaders/pds_dart_throwing.comp"))
+		{
+			point_buf.init_gpu(
+				PoissonDiskSamplingGPU::get_max_point_num(-1.0, 1.0, -1.0, 1.0, dist_min),
+				1.0e-4, pt_color);
+			if (!pds_gpu.generate_points_in_rect(-1.0, 1.0, -1.0, 1.0, dist_min, point_buf))
+				return 0;
+		}
+		std::cout << "PDSResultView: fall back to cpu sampler.\n";
+	}
+
+	// generate point with poisson disk sampling method
+	PoissonDiskSampling pds;
+	pds.set_cache_dir(".");
+	pds.generate_points_in_rect(-1.0, 1.0, -1.0, 1.0, dist_min);
 
 	// draw point buffer
-	point_buf.init(pds.get_points(), 1.0e-4,
-				   glm::vec3(1.0f, 1.0f, 0.804f));
-	
+	std::vector<glm::vec2> &pds_pts = pds.get_points();
+	init_points(pds_pts.size() ? &pds_pts[0] : nullptr, pds_pts.size(), pt_color);
+
 	return 0;
 }
 
 int PDSResultView::paint()
 {
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	float half_size = 1.0f / view_zoom;
+	float xl = view_center.x - half_size;
+	float xu = view_center.x + half_size;
+	float yl = view_center.y - half_size;
+	float yu = view_center.y + half_size;
+	frame_data.projection = glm::ortho(xl, xu, yl, yu);
+	frame_data.view = glm::mat4(1.0f);
+	frame_data.viewport = glm::vec4(float(vp_x), float(vp_y), float(vp_size), float(vp_size));
+	frame_data.time = float(get_time());
+	frame_ubo.update(frame_data);
 	point_shader.use();
-	point_buf.draw(point_shader);
+	float pixel_scale = 0.5f * float(vp_size) * view_zoom;
+	point_buf.set_pixel_scale(pixel_scale);
+
+	if (points.empty())
+	{
+		// gpu generated points
+		point_buf.draw(point_shader);
+		return 0;
+	}
+
+	// circles centered outside still cover the border
+	float r = point_buf.get_point_radius();
+	size_t visible_num = quadtree.select(xl - r, xu + r, yl - r, yu + r, 0.0, draw_ranges);
+	if (heatmap_ratio > 0.0f &&
+		double(visible_num) > double(heatmap_ratio) * double(vp_size) * double(vp_size))
+	{
+		// circles would saturate, show point count per pixel
+		glm::vec4 view(xl, xu, yl, yu);
+		if (density_view != view ||
+			density_buf.get_res_x() != vp_size || density_buf.get_res_y() != vp_size)
+		{
+			density_buf.resize(vp_size, vp_size);
+			density_buf.update_ranges(&points[0],
+				draw_ranges.size() ? &draw_ranges[0] : nullptr, draw_ranges.size(),
+				xl, xu, yl, yu);
+			density_view = view;
+		}
+		density_shader.use();
+		density_buf.draw(density_shader);
+		return 0;
+	}
+
+	double max_density = double(lod_density) * pixel_scale * pixel_scale;
+	quadtree.select(xl - r, xu + r, yl - r, yu + r, max_density, draw_ranges);
+	point_buf.draw_ranges(point_shader,
+		draw_ranges.size() ? &draw_ranges[0] : nullptr, draw_ranges.size());
 	return 0;
 }
 
 void PDSResultView::destroy()
 {
-
+	density_buf.clear();
+	frame_ubo.destroy();
 }
 
 int PDSResultView::resize(int wd, int ht)
@@ -65,3 +187,42 @@ int PDSResultView::resize(int wd, int ht)
 	set_square_viewport(wd, ht);
 	return 0;
 }
+
+void PDSResultView::mouse_move(double xpos, double ypos)
+{
+	// viewport is in framebuffer pixels
+	cursor_to_pixels(xpos, ypos);
+	if (mouse_is_pressed(GLFW_MOUSE_BUTTON_LEFT))
+	{
+		// points follow the cursor
+		float scale = 2.0f / (float(vp_size) * view_zoom);
+		view_center.x -= float(xpos - cursor_x) * scale;
+		view_center.y += float(ypos - cursor_y) * scale;
+	}
+	cursor_x = xpos;
+	cursor_y = ypos;
+}
+
+void PDSResultView::mouse_scroll(double offset)
+{
+	// keep point under cursor fixed
+	glm::vec2 c = cursor_to_view(cursor_x, cursor_y);
+	glm::vec2 focus = view_center + c / view_zoom;
+	float zoom = view_zoom * float(pow(1.25, offset));
+	if (zoom < 0.5f)
+		zoom = 0.5f;
+	if (zoom > 65536.0f)
+		zoom = 65536.0f;
+	view_zoom = zoom;
+	view_center = focus - c / view_zoom;
+}
+
+void PDSResultView::process_keyboard_input()
+{
+	GlfwApp::process_keyboard_input();
+	if (key_is_pressed(GLFW_KEY_R))
+	{
+		view_center = glm::vec2(0.0f);
+		view_zoom = 1.0f;
+	}
+}
@@ -1,26 +1,78 @@
 #ifndef __PDS_Result_View_h__
 #define __PDS_Result_View_h__
 
+#include <string>
+#include <vector>
+
 #include "OpenGLShaderUtilities.h"
 #include "CirclesGLBuffer.h"
+#include "PointDensityGLBuffer.h"
 #include "GlfwApp.h"
+#include "PointQuadtree.h"
 
 class PDSResultView : public GlfwApp
 {
 protected:
 	CirclesGLBuffer point_buf;
 	OpenGLShaderProgram point_shader;
+	// zoomed projection, uploaded once per frame
+	FrameData frame_data;
+	OpenGLUniformBuffer frame_ubo;
+
+	// display points from this file instead of generating them
+	std::string point_set_filename;
+	// generate points with compute shader if supported
+	bool use_gpu_sampler;
+
+	// cpu points in quadtree order, only visible leaves are drawn
+	std::vector<glm::vec2> points;
+	PointQuadtree quadtree;
+	std::vector<PointQuadtree::Range> draw_ranges;
+	// subsample leaves to this many points per pixel, 0 draws all
+	float lod_density;
+
+	// heatmap instead of circles above this many visible points
+	// per pixel, 0 disables it
+	float heatmap_ratio;
+	PointDensityGLBuffer density_buf;
+	OpenGLShaderProgram density_shader;
+	// view of density_buf, rebinned only when it changes
+	glm::vec4 density_view;
+
+	// drag with left button, scroll to zoom, R to reset
+	glm::vec2 view_center;
+	float view_zoom;
+	int vp_x, vp_y, vp_size;
+	// last cursor position in framebuffer pixels
+	double cursor_x, cursor_y;
 
 	void set_square_viewport(int wd, int ht);
+	// cursor position in [-1, 1] coordinate of unzoomed view
+	glm::vec2 cursor_to_view(double xpos, double ypos) const;
+	int init_points(const glm::vec2 *pts, size_t pt_num, const glm::vec3 &color);
 
 public:
 	PDSResultView();
 	~PDSResultView();
 
+	inline void set_point_set_file(const char *filename) { point_set_filename = filename; }
+	inline void set_lod_density(float density) { lod_density = density; }
+	inline void set_heatmap_ratio(float ratio) { heatmap_ratio = ratio; }
+	// needs opengl 4.3, falls back to cpu sampler otherwise
+	inline void set_use_gpu_sampler(bool enable)
+	{
+		use_gpu_sampler = enable;
+		if (enable)
+			set_gl_version(4, 3);
+	}
+
 	int init() override;
 	int paint() override;
 	void destroy() override;
 	int resize(int wd, int ht) override;
+	void mouse_move(double xpos, double ypos) override;
+	void mouse_scroll(double offset) override;
+	void process_keyboard_input() override;
 };
 
 #endif
\ No newline at end of file
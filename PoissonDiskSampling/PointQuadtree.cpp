@@ -0,0 +1,156 @@
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include "ParallelFor.h"
+
+#include "PointQuadtree.h"
+
+// morton keys have 16 levels
+#define MAX_DEPTH 16
+
+int PointQuadtree::build(
+	glm::vec2 *pts, size_t pt_num,
+	double xl, double xu, double yl, double yu,
+	std::vector<uint32_t> *perm)
+{
+	clear();
+	if (xu <= xl || yu <= yl || uint64_t(pt_num) > uint64_t(UINT32_MAX))
+		return -1;
+
+	std::vector<uint32_t> ids_tmp;
+	std::vector<uint32_t> *ids = perm ? perm : &ids_tmp;
+	ids->clear();
+	if (pt_num)
+	{
+		sorter.set_thread_num(thread_num);
+		sorter.sort(pts, pt_num, xl, xu, yl, yu, PointSetSort::Morton, ids);
+	}
+	const std::vector<uint32_t> &keys = sorter.get_keys();
+
+	Node root;
+	root.xl = float(xl);
+	root.xu = float(xu);
+	root.yl = float(yl);
+	root.yu = float(yu);
+	root.begin = 0;
+	root.end = uint32_t(pt_num);
+	root.child = -1;
+	nodes.push_back(root);
+
+	// (node id, depth)
+	std::vector<std::pair<uint32_t, uint32_t> > node_stack;
+	node_stack.push_back(std::make_pair(0, 0));
+	while (!node_stack.empty())
+	{
+		uint32_t n_id = node_stack.back().first;
+		uint32_t depth = node_stack.back().second;
+		node_stack.pop_back();
+
+		Node nd = nodes[n_id];
+		if (nd.end - nd.begin <= leaf_size || depth >= MAX_DEPTH)
+		{
+			leaf_ids.push_back(n_id);
+			continue;
+		}
+
+		// 2 key bits of this level are (y, x) of the child
+		uint32_t shift = 2 * (MAX_DEPTH - 1 - depth);
+		uint32_t prefix = uint32_t(uint64_t(keys[nd.begin]) & ~((uint64_t(1) << (shift + 2)) - 1));
+		float xm = 0.5f * (nd.xl + nd.xu);
+		float ym = 0.5f * (nd.yl + nd.yu);
+		nodes[n_id].child = int32_t(nodes.size());
+		uint32_t begin = nd.begin;
+		for (uint32_t c_id = 0; c_id < 4; ++c_id)
+		{
+			uint32_t end = nd.end;
+			if (c_id < 3)
+			{
+				uint32_t next_key = prefix | ((c_id + 1) << shift);
+				end = uint32_t(std::lower_bound(keys.begin() + begin,
+					keys.begin() + nd.end, next_key) - keys.begin());
+			}
+			Node child;
+			child.xl = c_id & 1 ? xm : nd.xl;
+			child.xu = c_id & 1 ? nd.xu : xm;
+			child.yl = c_id & 2 ? ym : nd.yl;
+			child.yu = c_id & 2 ? nd.yu : ym;
+			child.begin = begin;
+			child.end = end;
+			child.child = -1;
+			nodes.push_back(child);
+			node_stack.push_back(std::make_pair(uint32_t(nodes.size() - 1), depth + 1));
+			begin = end;
+		}
+	}
+
+	// random order inside leaves for subsampling
+	parallel_for(leaf_ids.size(), thread_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t l_id = begin; l_id < end; ++l_id)
+		{
+			const Node &leaf = nodes[leaf_ids[l_id]];
+			std::mt19937 rand_gen(seed * 0x9E3779B9U + uint32_t(l_id));
+			for (uint32_t p_id = leaf.end; p_id > leaf.begin + 1; --p_id)
+			{
+				std::uniform_int_distribution<uint32_t> dist(leaf.begin, p_id - 1);
+				uint32_t s_id = dist(rand_gen);
+				std::swap(pts[p_id - 1], pts[s_id]);
+				if (perm)
+					std::swap((*perm)[p_id - 1], (*perm)[s_id]);
+			}
+		}
+	});
+	return 0;
+}
+
+size_t PointQuadtree::select(
+	double xl, double xu, double yl, double yu,
+	double max_density, std::vector<Range> &ranges) const
+{
+	ranges.clear();
+	if (nodes.empty())
+		return 0;
+
+	size_t pt_num = 0;
+	std::vector<uint32_t> node_stack;
+	node_stack.push_back(0);
+	while (!node_stack.empty())
+	{
+		const Node &nd = nodes[node_stack.back()];
+		node_stack.pop_back();
+		if (nd.begin == nd.end ||
+			nd.xu < xl || nd.xl > xu || nd.yu < yl || nd.yl > yu)
+			continue;
+
+		if (nd.child >= 0)
+		{
+			// push in reverse to visit children in memory order
+			for (int32_t c_id = 3; c_id >= 0; --c_id)
+				node_stack.push_back(uint32_t(nd.child + c_id));
+			continue;
+		}
+
+		uint32_t num = nd.end - nd.begin;
+		if (max_density > 0.0)
+		{
+			double area = double(nd.xu - nd.xl) * double(nd.yu - nd.yl);
+			double max_num = ceil(max_density * area);
+			if (max_num < double(num))
+				num = max_num < 1.0 ? 1 : uint32_t(max_num);
+		}
+		pt_num += num;
+		if (!ranges.empty() &&
+			ranges.back().first + ranges.back().num == nd.begin)
+		{
+			ranges.back().num += num;
+			continue;
+		}
+		Range r;
+		r.first = nd.begin;
+		r.num = num;
+		ranges.push_back(r);
+	}
+	return pt_num;
+}
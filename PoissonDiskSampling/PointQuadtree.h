@@ -0,0 +1,74 @@
+#ifndef __Point_Quadtree_h__
+#define __Point_Quadtree_h__
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "PointSetSort.h"
+
+// Quadtree over a point set stored in morton order, so that
+// every node owns a contiguous range of the point array.
+// Points inside each leaf are shuffled, any prefix of a leaf
+// is a random subsample of it.
+class PointQuadtree
+{
+public:
+	struct Node
+	{
+		float xl, xu, yl, yu;
+		uint32_t begin, end;
+		// first of 4 children, -1 for leaf
+		int32_t child;
+	};
+	// points [first, first + num) of the sorted array
+	struct Range
+	{
+		uint32_t first;
+		uint32_t num;
+	};
+
+protected:
+	size_t thread_num;
+	size_t leaf_size;
+	unsigned int seed;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> leaf_ids;
+	PointSetSort sorter;
+
+public:
+	PointQuadtree() : thread_num(0), leaf_size(4096), seed(1) {}
+	~PointQuadtree() {}
+
+	// 0 means hardware concurrency
+	inline void set_thread_num(size_t num) { thread_num = num; }
+	// nodes with at most this number of points are not split
+	inline void set_leaf_size(size_t size) { leaf_size = size ? size : 1; }
+	inline void set_seed(unsigned int s) { seed = s; }
+
+	inline void clear() { nodes.clear(); leaf_ids.clear(); }
+	inline const std::vector<Node> &get_nodes() const { return nodes; }
+	inline size_t get_leaf_num() const { return leaf_ids.size(); }
+
+	// reorder pts in place, if perm is not null, perm[i] is
+	// the original index of the i-th point
+	int build(glm::vec2 *pts, size_t pt_num,
+		double xl, double xu, double yl, double yu,
+		std::vector<uint32_t> *perm = nullptr);
+	inline int build(std::vector<glm::vec2> &pts,
+		double xl, double xu, double yl, double yu,
+		std::vector<uint32_t> *perm = nullptr)
+	{
+		return build(pts.size() ? &pts[0] : nullptr, pts.size(),
+			xl, xu, yl, yu, perm);
+	}
+
+	// ranges of leaves overlapping the rect, adjacent ranges are merged
+	// leaves draw at most max_density * leaf area points if max_density > 0
+	// return number of selected points
+	size_t select(double xl, double xu, double yl, double yu,
+		double max_density, std::vector<Range> &ranges) const;
+};
+
+#endif
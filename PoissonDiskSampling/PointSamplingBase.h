@@ -0,0 +1,36 @@
+#ifndef __Point_Sampling_Base_h__
+#define __Point_Sampling_Base_h__
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "PointSetSort.h"
+
+// Common output of point samplers
+class PointSamplingBase
+{
+protected:
+	std::vector<glm::vec2> points;
+
+	unsigned int seed;
+	// order of output points
+	PointSetSort::KeyType sort_key;
+
+public:
+	PointSamplingBase() : seed(1), sort_key(PointSetSort::None) {}
+	virtual ~PointSamplingBase() {}
+	inline void clear() { points.clear(); }
+
+	inline std::vector<glm::vec2> &get_points() { return points; }
+	inline unsigned int get_seed() const { return seed; }
+	inline void set_seed(unsigned int _seed) { seed = _seed; }
+	// output points in generation order by default,
+	// use PointSetSort directly if permutation is needed
+	inline void set_sort_key(PointSetSort::KeyType key) { sort_key = key; }
+
+	virtual int generate_points_in_rect(
+		double xl, double xu, double yl, double yu,
+		double dist_min) = 0;
+};
+
+#endif
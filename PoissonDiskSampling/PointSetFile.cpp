@@ -0,0 +1,113 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "PointSetFile.h"
+
+static const char point_set_magic[4] = { 'P', 'D', 'S', 'P' };
+static const uint32_t point_set_version = 1;
+// align point data for direct use as vertex data
+static const uint64_t point_set_data_align = 16;
+
+int PointSetFile::open(const char *filename)
+{
+	close();
+
+	if (file.open(filename))
+		return -1;
+
+	if (file.get_size() < sizeof(PointSetHeader))
+	{
+		std::cout << "PointSetFile: " << filename << " is too small.\n";
+		close();
+		return -1;
+	}
+
+	const PointSetHeader *hd = (const PointSetHeader *)file.get_data();
+	if (memcmp(hd->magic, point_set_magic, sizeof(point_set_magic)) ||
+		hd->version != point_set_version ||
+		(hd->precision != sizeof(float) && hd->precision != sizeof(double)))
+	{
+		std::cout << "PointSetFile: " << filename << " has invalid header.\n";
+		close();
+		return -1;
+	}
+
+	// compare counts rather than sizes, which may overflow
+	const uint64_t file_size = file.get_size();
+	if (hd->data_offset < sizeof(PointSetHeader) ||
+		hd->data_offset > file_size ||
+		hd->pt_num > (file_size - hd->data_offset) / (2 * hd->precision))
+	{
+		std::cout << "PointSetFile: " << filename << " is truncated.\n";
+		close();
+		return -1;
+	}
+
+	header = hd;
+	pt_data = file.get_data() + hd->data_offset;
+	return 0;
+}
+
+void PointSetFile::close()
+{
+	header = nullptr;
+	pt_data = nullptr;
+	file.close();
+}
+
+void PointSetFile::copy_points(std::vector<glm::vec2> &pts) const
+{
+	size_t pt_num = get_point_num();
+	pts.resize(pt_num);
+	if (pt_num == 0)
+		return;
+
+	if (header->precision == sizeof(float))
+	{
+		memcpy(&pts[0], pt_data, pt_num * sizeof(glm::vec2));
+		return;
+	}
+
+	const double *coords = (const double *)pt_data;
+	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+	{
+		pts[p_id].x = float(coords[2 * p_id]);
+		pts[p_id].y = float(coords[2 * p_id + 1]);
+	}
+}
+
+int PointSetFile::write(
+	const char *filename,
+	PointSetHeader &header,
+	const glm::vec2 *pts,
+	size_t pt_num
+	)
+{
+	std::fstream file(filename, std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "PointSetFile: Can't open file " << filename << ".\n";
+		return -1;
+	}
+
+	memcpy(header.magic, point_set_magic, sizeof(point_set_magic));
+	header.version = point_set_version;
+	header.precision = sizeof(float);
+	header.pt_num = pt_num;
+	header.data_offset = (sizeof(PointSetHeader) + point_set_data_align - 1)
+		/ point_set_data_align * point_set_data_align;
+
+	file.write((const char *)&header, sizeof(PointSetHeader));
+	char padding[point_set_data_align] = { 0 };
+	file.write(padding, header.data_offset - sizeof(PointSetHeader));
+	if (pt_num)
+		file.write((const char *)pts, pt_num * sizeof(glm::vec2));
+	file.close();
+	if (!file)
+	{
+		std::cout << "PointSetFile: Can't write file " << filename << ".\n";
+		return -1;
+	}
+	return 0;
+}
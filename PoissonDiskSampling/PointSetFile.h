@@ -0,0 +1,61 @@
+#ifndef __Point_Set_File_h__
+#define __Point_Set_File_h__
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+
+// Binary point set file:
+//   PointSetHeader
+//   padding to data_offset
+//   pt_num * 2 coordinates (float or double, see precision)
+struct PointSetHeader
+{
+	char magic[4]; // "PDSP"
+	uint32_t version;
+	uint32_t precision; // bytes per coordinate, 4 or 8
+	uint32_t seed;
+	// domain
+	double xl, xu;
+	double yl, yu;
+	double dist_min;
+	uint64_t pt_num;
+	uint64_t data_offset;
+};
+
+class PointSetFile
+{
+protected:
+	MappedFile file;
+	const PointSetHeader *header;
+	const char *pt_data;
+
+public:
+	PointSetFile() : header(nullptr), pt_data(nullptr) {}
+	~PointSetFile() { close(); }
+
+	// map file and validate header, return 0 if success
+	int open(const char *filename);
+	void close();
+
+	inline bool is_open() const { return header != nullptr; }
+	inline const PointSetHeader &get_header() const { return *header; }
+	inline size_t get_point_num() const { return size_t(header->pt_num); }
+	// pointer into the mapped file, nullptr if not single precision
+	inline const glm::vec2 *get_points() const
+	{
+		return header->precision == sizeof(float) ?
+			(const glm::vec2 *)pt_data : nullptr;
+	}
+	void copy_points(std::vector<glm::vec2> &pts) const;
+
+	// header.magic, version, pt_num, data_offset and
+	// precision are filled in by this function
+	static int write(const char *filename,
+		PointSetHeader &header,
+		const glm::vec2 *pts, size_t pt_num);
+};
+
+#endif
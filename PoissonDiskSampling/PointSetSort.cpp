@@ -0,0 +1,180 @@
+#include <numeric>
+
+#include "ParallelFor.h"
+
+#include "PointSetSort.h"
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+static inline uint32_t quantize(double v, double l, double u, uint32_t max_q)
+{
+	double q = (v - l) / (u - l) * double(max_q + 1);
+	if (q < 0.0)
+		return 0;
+	if (q >= double(max_q))
+		return max_q;
+	return uint32_t(q);
+}
+
+uint32_t PointSetSort::hilbert_code_2d(uint32_t x, uint32_t y)
+{
+	const uint32_t n = 1 << 16;
+	uint32_t rx, ry, d = 0, tmp;
+	for (uint32_t s = n >> 1; s > 0; s >>= 1)
+	{
+		rx = (x & s) > 0;
+		ry = (y & s) > 0;
+		d += s * s * ((3 * rx) ^ ry);
+		// rotate quadrant
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			tmp = x;
+			x = y;
+			y = tmp;
+		}
+	}
+	return d;
+}
+
+// points stay in place, perm is still filled for callers
+static inline void set_identity_perm(std::vector<uint32_t> *perm, size_t pt_num)
+{
+	if (!perm)
+		return;
+	perm->resize(pt_num);
+	std::iota(perm->begin(), perm->end(), uint32_t(0));
+}
+
+int PointSetSort::sort(
+	glm::vec2 *pts, size_t pt_num,
+	double xl, double xu, double yl, double yu,
+	KeyType type,
+	std::vector<uint32_t> *perm)
+{
+	if (type == None || pt_num == 0)
+	{
+		set_identity_perm(perm, pt_num);
+		return 0;
+	}
+
+	keys.resize(pt_num);
+	ids.resize(pt_num);
+	parallel_for(pt_num, thread_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t p_id = begin; p_id < end; ++p_id)
+		{
+			uint32_t qx = quantize(pts[p_id].x, xl, xu, 0xFFFF);
+			uint32_t qy = quantize(pts[p_id].y, yl, yu, 0xFFFF);
+			keys[p_id] = type == Hilbert ?
+				hilbert_code_2d(qx, qy) : morton_code_2d(qx, qy);
+			ids[p_id] = uint32_t(p_id);
+		}
+	});
+
+	radix_sort(pt_num);
+	permute_points(pts, pt_num, perm);
+	return 0;
+}
+
+int PointSetSort::sort(
+	glm::vec3 *pts, size_t pt_num,
+	const glm::vec3 &lower, const glm::vec3 &upper,
+	std::vector<uint32_t> *perm)
+{
+	if (pt_num == 0)
+	{
+		set_identity_perm(perm, pt_num);
+		return 0;
+	}
+
+	keys.resize(pt_num);
+	ids.resize(pt_num);
+	parallel_for(pt_num, thread_num,
+		[&](size_t th_id, size_t begin, size_t end)
+	{
+		for (size_t p_id = begin; p_id < end; ++p_id)
+		{
+			uint32_t qx = quantize(pts[p_id].x, lower.x, upper.x, 0x3FF);
+			uint32_t qy = quantize(pts[p_id].y, lower.y, upper.y, 0x3FF);
+			uint32_t qz = quantize(pts[p_id].z, lower.z, upper.z, 0x3FF);
+			keys[p_id] = morton_code_3d(qx, qy, qz);
+			ids[p_id] = uint32_t(p_id);
+		}
+	});
+
+	radix_sort(pt_num);
+	permute_points(pts, pt_num, perm);
+	return 0;
+}
+
+void PointSetSort::radix_sort(size_t num)
+{
+	size_t th_num = thread_num ? thread_num : get_default_thread_num();
+	if (th_num > num)
+		th_num = num;
+	keys_tmp.resize(num);
+	ids_tmp.resize(num);
+	std::vector<size_t> hists(th_num * RADIX_SIZE);
+
+	for (uint32_t shift = 0; shift < 32; shift += RADIX_BITS)
+	{
+		// count digits in each thread range
+		parallel_for(num, th_num,
+			[&](size_t th_id, size_t begin, size_t end)
+		{
+			size_t *hist = &hists[th_id * RADIX_SIZE];
+			for (size_t d_id = 0; d_id < RADIX_SIZE; ++d_id)
+				hist[d_id] = 0;
+			for (size_t i = begin; i < end; ++i)
+				++hist[(keys[i] >> shift) & (RADIX_SIZE - 1)];
+		});
+
+		// skip pass if all keys share this digit
+		bool is_trivial = false;
+		for (size_t d_id = 0; d_id < RADIX_SIZE; ++d_id)
+		{
+			size_t d_num = 0;
+			for (size_t th_id = 0; th_id < th_num; ++th_id)
+				d_num += hists[th_id * RADIX_SIZE + d_id];
+			if (d_num == num)
+				is_trivial = true;
+			if (d_num)
+				break;
+		}
+		if (is_trivial)
+			continue;
+
+		// exclusive prefix sum ordered by (digit, thread)
+		size_t offset = 0;
+		for (size_t d_id = 0; d_id < RADIX_SIZE; ++d_id)
+			for (size_t th_id = 0; th_id < th_num; ++th_id)
+			{
+				size_t &h = hists[th_id * RADIX_SIZE + d_id];
+				size_t cnt = h;
+				h = offset;
+				offset += cnt;
+			}
+
+		// stable scatter
+		parallel_for(num, th_num,
+			[&](size_t th_id, size_t begin, size_t end)
+		{
+			size_t *pos = &hists[th_id * RADIX_SIZE];
+			for (size_t i = begin; i < end; ++i)
+			{
+				size_t dst = pos[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+				keys_tmp[dst] = keys[i];
+				ids_tmp[dst] = ids[i];
+			}
+		});
+		keys.swap(keys_tmp);
+		ids.swap(ids_tmp);
+	}
+}
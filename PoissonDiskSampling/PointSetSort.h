@@ -0,0 +1,109 @@
+#ifndef __Point_Set_Sort_h__
+#define __Point_Set_Sort_h__
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Reorder point sets along a space filling curve
+// using parallel LSD radix sort on 32 bit keys
+class PointSetSort
+{
+public:
+	enum KeyType
+	{
+		None = 0,
+		Morton = 1,
+		Hilbert = 2
+	};
+
+protected:
+	size_t thread_num;
+
+	std::vector<uint32_t> keys, keys_tmp;
+	std::vector<uint32_t> ids, ids_tmp;
+
+public:
+	PointSetSort() : thread_num(0) {}
+	~PointSetSort() {}
+
+	// 0 means hardware concurrency
+	inline void set_thread_num(size_t num) { thread_num = num; }
+	// keys of the last sort in sorted order
+	inline const std::vector<uint32_t> &get_keys() const { return keys; }
+
+	// sort pts in place, if perm is not null, perm[i] is
+	// the original index of the i-th sorted point
+	int sort(glm::vec2 *pts, size_t pt_num,
+		double xl, double xu, double yl, double yu,
+		KeyType type = Morton,
+		std::vector<uint32_t> *perm = nullptr);
+	inline int sort(std::vector<glm::vec2> &pts,
+		double xl, double xu, double yl, double yu,
+		KeyType type = Morton,
+		std::vector<uint32_t> *perm = nullptr)
+	{
+		return sort(pts.size() ? &pts[0] : nullptr, pts.size(),
+			xl, xu, yl, yu, type, perm);
+	}
+	// 3D points only support morton order
+	int sort(glm::vec3 *pts, size_t pt_num,
+		const glm::vec3 &lower, const glm::vec3 &upper,
+		std::vector<uint32_t> *perm = nullptr);
+
+	// reorder data attached to points, dst[i] = src[perm[i]]
+	template <typename T>
+	static void apply_permutation(const std::vector<uint32_t> &perm,
+		const T *src, T *dst)
+	{
+		for (size_t i = 0; i < perm.size(); ++i)
+			dst[i] = src[perm[i]];
+	}
+
+	// 16 bits per axis
+	static inline uint32_t morton_code_2d(uint32_t x, uint32_t y)
+	{
+		return part_1_by_1(x) | (part_1_by_1(y) << 1);
+	}
+	// 10 bits per axis
+	static inline uint32_t morton_code_3d(uint32_t x, uint32_t y, uint32_t z)
+	{
+		return part_1_by_2(x) | (part_1_by_2(y) << 1) | (part_1_by_2(z) << 2);
+	}
+	// 16 bits per axis
+	static uint32_t hilbert_code_2d(uint32_t x, uint32_t y);
+
+protected:
+	static inline uint32_t part_1_by_1(uint32_t x)
+	{
+		x &= 0x0000FFFF;
+		x = (x | (x << 8)) & 0x00FF00FF;
+		x = (x | (x << 4)) & 0x0F0F0F0F;
+		x = (x | (x << 2)) & 0x33333333;
+		x = (x | (x << 1)) & 0x55555555;
+		return x;
+	}
+	static inline uint32_t part_1_by_2(uint32_t x)
+	{
+		x &= 0x000003FF;
+		x = (x | (x << 16)) & 0x030000FF;
+		x = (x | (x << 8)) & 0x0300F00F;
+		x = (x | (x << 4)) & 0x030C30C3;
+		x = (x | (x << 2)) & 0x09249249;
+		return x;
+	}
+
+	// sort ids by keys, results in keys and ids
+	void radix_sort(size_t num);
+
+	template <typename Point>
+	void permute_points(Point *pts, size_t pt_num, std::vector<uint32_t> *perm)
+	{
+		std::vector<Point> pts_tmp(pts, pts + pt_num);
+		apply_permutation(ids, &pts_tmp[0], pts);
+		if (perm)
+			perm->swap(ids);
+	}
+};
+
+#endif
@@ -1,5 +1,10 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
 #include "BgGrid.h"
 #include "RandomPointQueueByHash.h"
+#include "PointSetFile.h"
 
 #include "PoissonDiskSampling.h"
 
@@ -12,6 +17,20 @@ int PoissonDiskSampling::generate_points_in_rect(
 	double xl, double xu, double yl, double yu,
 	double dist_min)
 {
+	std::string cache_filename;
+	if (!cache_dir.empty())
+	{
+		get_cache_filename(cache_filename, xl, xu, yl, yu, dist_min);
+		if (load_from_cache(cache_filename.c_str(), xl, xu, yl, yu, dist_min))
+		{
+			PointSetSort sorter;
+			sorter.sort(points, xl, xu, yl, yu, sort_key);
+			return 0;
+		}
+	}
+
+	RandNum::set_seed(seed);
+
 	// init grid
 	double cell_size = dist_min / sqrt(2.0); // rule of thumb
 	size_t grid_x_num = size_t(ceil((xu - xl) / cell_size));
@@ -64,9 +83,71 @@ int PoissonDiskSampling::generate_points_in_rect(
 		point.y = pt.y;
 	}
 
+	if (!cache_filename.empty())
+	{
+		PointSetHeader header;
+		header.seed = seed;
+		header.xl = xl;
+		header.xu = xu;
+		header.yl = yl;
+		header.yu = yu;
+		header.dist_min = dist_min;
+		PointSetFile::write(cache_filename.c_str(), header,
+			pt_num ? &points[0] : nullptr, pt_num);
+	}
+
+	PointSetSort sorter;
+	sorter.sort(points, xl, xu, yl, yu, sort_key);
+
 	return 0;
 }
 
+void PoissonDiskSampling::get_cache_filename(
+	std::string &filename,
+	double xl, double xu, double yl, double yu,
+	double dist_min) const
+{
+	// FNV-1a hash of generation parameters
+	const double params[5] = { xl, xu, yl, yu, dist_min };
+	unsigned long long hash = 14695981039346656037ULL;
+	const unsigned char *bytes = (const unsigned char *)params;
+	for (size_t b_id = 0; b_id < sizeof(params); ++b_id)
+		hash = (hash ^ bytes[b_id]) * 1099511628211ULL;
+	bytes = (const unsigned char *)&seed;
+	for (size_t b_id = 0; b_id < sizeof(seed); ++b_id)
+		hash = (hash ^ bytes[b_id]) * 1099511628211ULL;
+
+	char name[32];
+	snprintf(name, sizeof(name), "pds_%016llx.pts", hash);
+	filename = cache_dir + '/' + name;
+}
+
+bool PoissonDiskSampling::load_from_cache(
+	const char *filename,
+	double xl, double xu, double yl, double yu,
+	double dist_min)
+{
+	FILE *test_file = fopen(filename, "rb");
+	if (!test_file)
+		return false;
+	fclose(test_file);
+
+	PointSetFile file;
+	if (file.open(filename))
+		return false;
+
+	// guard against hash collision
+	const PointSetHeader &header = file.get_header();
+	if (header.seed != seed ||
+		header.xl != xl || header.xu != xu ||
+		header.yl != yl || header.yu != yu ||
+		header.dist_min != dist_min)
+		return false;
+
+	file.copy_points(points);
+	return true;
+}
+
 Point2D PoissonDiskSampling::gen_rand_point_around1(Point2D& p, double dist)
 {
 	double radius = dist * (1.0 + RandNum::get_double());
@@ -1,15 +1,18 @@
 #ifndef __Poisson_Disk_Sampling_h__
 #define __Poisson_Disk_Sampling_h__
 
+#include <string>
 #include <vector>
 #include <glm/glm.hpp>
 
 #include "pds_utils.h"
+#include "PointSamplingBase.h"
 
-class PoissonDiskSampling
+class PoissonDiskSampling : public PointSamplingBase
 {
 protected:
-	std::vector<glm::vec2> points;
+	// directory for cached results, disabled if empty
+	std::string cache_dir;
 
 	Point2D gen_rand_point_around1(Point2D &p, double dist_min);
 	Point2D gen_rand_point_around2(Point2D& p, double dist_min);
@@ -17,13 +20,22 @@ protected:
 public:
 	PoissonDiskSampling();
 	~PoissonDiskSampling() { clear(); }
-	inline void clear() { points.clear(); }
 
-	inline std::vector<glm::vec2> &get_points() { return points; }
-	
+	// cache results in binary point set files under dir,
+	// identical generation parameters load from cache
+	inline void set_cache_dir(const char *dir) { cache_dir = dir ? dir : ""; }
+
 	int generate_points_in_rect(
-		double xl, double yl, double xu, double yu,
+		double xl, double xu, double yl, double yu,
+		double dist_min) override;
+
+protected:
+	void get_cache_filename(std::string &filename,
+		double xl, double xu, double yl, double yu,
+		double dist_min) const;
+	bool load_from_cache(const char *filename,
+		double xl, double xu, double yl, double yu,
 		double dist_min);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,144 @@
+#include <cmath>
+#include <iostream>
+
+#include "GLStateCache.h"
+#include "PoissonDiskSamplingGPU.h"
+
+// must match local_size of pds_dart_throwing.comp
+#define LOCAL_SIZE 8
+// cells of the same phase group are PHASE_PERIOD cells apart
+#define PHASE_PERIOD 3
+
+PoissonDiskSamplingGPU::PoissonDiskSamplingGPU() :
+	grid_buf(0), grid_cell_num(0),
+	seed(1), round_num(8), try_num(4)
+{
+
+}
+
+void PoissonDiskSamplingGPU::clear()
+{
+	if (grid_buf)
+	{
+		GLStateCache::get().delete_buffers(1, &grid_buf);
+		grid_buf = 0;
+	}
+	grid_cell_num = 0;
+}
+
+int PoissonDiskSamplingGPU::init(const char *shader_filename)
+{
+	OpenGLShaderSupportCheck support_check;
+	if (!support_check.support_compute_shader())
+	{
+		std::cout << "PoissonDiskSamplingGPU: compute shader is not supported.\n";
+		return -1;
+	}
+
+	const OpenGLShader::ShaderType type = OpenGLShader::Compute;
+	if (!program.create_from_files(&type, &shader_filename, 1))
+		return -1;
+	return 0;
+}
+
+void PoissonDiskSamplingGPU::get_grid_size(
+	double xl, double xu, double yl, double yu,
+	double dist_min,
+	double &cell_size, size_t &x_num, size_t &y_num)
+{
+	// at most one point in each cell
+	cell_size = dist_min / sqrt(2.0);
+	x_num = size_t(ceil((xu - xl) / cell_size));
+	y_num = size_t(ceil((yu - yl) / cell_size));
+	if (x_num == 0) x_num = 1;
+	if (y_num == 0) y_num = 1;
+}
+
+size_t PoissonDiskSamplingGPU::get_max_point_num(
+	double xl, double xu, double yl, double yu,
+	double dist_min)
+{
+	double cell_size;
+	size_t x_num, y_num;
+	get_grid_size(xl, xu, yl, yu, dist_min, cell_size, x_num, y_num);
+	return x_num * y_num;
+}
+
+int PoissonDiskSamplingGPU::generate_points_in_rect(
+	double xl, double xu, double yl, double yu,
+	double dist_min,
+	CirclesGLBuffer &pt_buf)
+{
+	GLStateCache& gl_state = GLStateCache::get();
+
+	if (!is_valid() || !pt_buf.is_gpu_buffer() ||
+		pt_buf.get_inst_style() != CirclesGLBuffer::UniformStyle)
+		return -1;
+	if (dist_min <= 0.0 || xu <= xl || yu <= yl)
+		return -1;
+
+	double cell_size;
+	size_t x_num, y_num;
+	get_grid_size(xl, xu, yl, yu, dist_min, cell_size, x_num, y_num);
+	size_t cell_num = x_num * y_num;
+	if (pt_buf.get_max_point_num() < cell_num)
+	{
+		std::cout << "PoissonDiskSamplingGPU: point buffer is too small.\n";
+		return -1;
+	}
+
+	if (grid_cell_num < cell_num)
+	{
+		clear();
+		glGenBuffers(1, &grid_buf);
+		gl_state.bind_buffer(GL_SHADER_STORAGE_BUFFER, grid_buf);
+		glBufferData(GL_SHADER_STORAGE_BUFFER,
+			sizeof(GLuint) * cell_num, nullptr, GL_DYNAMIC_COPY);
+		grid_cell_num = cell_num;
+	}
+	GLuint zero = 0;
+	gl_state.bind_buffer(GL_SHADER_STORAGE_BUFFER, grid_buf);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER,
+		GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	gl_state.bind_buffer(GL_SHADER_STORAGE_BUFFER, 0);
+	pt_buf.reset_gpu_point_num();
+
+	gl_state.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 0, grid_buf);
+	gl_state.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 1, pt_buf.get_inst_buffer());
+	gl_state.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 2, pt_buf.get_cmd_buffer());
+
+	program.use();
+	program.set_uniform("domain_lower", glm::vec2(float(xl), float(yl)));
+	program.set_uniform("domain_upper", glm::vec2(float(xu), float(yu)));
+	program.set_uniform("cell_size", GLfloat(cell_size));
+	program.set_uniform("dist_min", GLfloat(dist_min));
+	program.set_uniform("try_num", GLuint(try_num));
+	GLint grid_size_loc = program.uniform_loc("grid_size");
+	glUniform2ui(grid_size_loc, GLuint(x_num), GLuint(y_num));
+	GLint phase_loc = program.uniform_loc("phase");
+	GLint rand_seed_loc = program.uniform_loc("rand_seed");
+
+	// cells of one phase group
+	GLuint group_x_num = GLuint((x_num + PHASE_PERIOD - 1) / PHASE_PERIOD);
+	GLuint group_y_num = GLuint((y_num + PHASE_PERIOD - 1) / PHASE_PERIOD);
+	group_x_num = (group_x_num + LOCAL_SIZE - 1) / LOCAL_SIZE;
+	group_y_num = (group_y_num + LOCAL_SIZE - 1) / LOCAL_SIZE;
+	GLuint dispatch_id = 0;
+	for (unsigned int r_id = 0; r_id < round_num; ++r_id)
+		for (GLuint py = 0; py < PHASE_PERIOD; ++py)
+			for (GLuint px = 0; px < PHASE_PERIOD; ++px, ++dispatch_id)
+			{
+				glUniform2ui(phase_loc, px, py);
+				glUniform1ui(rand_seed_loc, seed * 0x9E3779B9U + dispatch_id);
+				glDispatchCompute(group_x_num, group_y_num, 1);
+				// next phase reads points of this phase
+				glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+			}
+
+	program.unuse();
+	// points are drawn straight from the buffers
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+					GL_COMMAND_BARRIER_BIT |
+					GL_BUFFER_UPDATE_BARRIER_BIT);
+	return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef __Poisson_Disk_Sampling_GPU_h__
+#define __Poisson_Disk_Sampling_GPU_h__
+
+#include "OpenGLShaderUtilities.h"
+#include "CirclesGLBuffer.h"
+
+// Poisson disk sampling with parallel phase group dart throwing
+// in compute shader (Shaders/pds_dart_throwing.comp).
+// Points are appended to the instance buffer of CirclesGLBuffer
+// and drawn with indirect command, nothing is read back to cpu.
+// Needs OpenGL 4.3, check with OpenGLShaderSupportCheck and fall
+// back to PoissonDiskSampling if not supported.
+// Also runs on Mesa llvmpipe (LIBGL_ALWAYS_SOFTWARE=1).
+class PoissonDiskSamplingGPU
+{
+protected:
+	OpenGLShaderProgram program;
+	// cell occupancy, index of point + 1
+	GLuint grid_buf;
+	size_t grid_cell_num;
+
+	unsigned int seed;
+	// each round visits all phase groups once
+	unsigned int round_num;
+	// candidates per cell in each phase group dispatch
+	unsigned int try_num;
+
+public:
+	PoissonDiskSamplingGPU();
+	~PoissonDiskSamplingGPU() { clear(); }
+	void clear();
+
+	inline void set_seed(unsigned int _seed) { seed = _seed; }
+	inline void set_round_num(unsigned int num) { round_num = num; }
+	inline void set_try_num(unsigned int num) { try_num = num; }
+
+	// compile compute shader, needs current opengl 4.3 context
+	int init(const char *shader_filename);
+	inline bool is_valid() const { return program.is_linked(); }
+
+	// upper bound of number of points in rect
+	static size_t get_max_point_num(
+		double xl, double xu, double yl, double yu,
+		double dist_min);
+
+	// pt_buf should be initialized by CirclesGLBuffer::init_gpu
+	// with at least get_max_point_num() points
+	int generate_points_in_rect(
+		double xl, double xu, double yl, double yu,
+		double dist_min,
+		CirclesGLBuffer &pt_buf);
+
+protected:
+	static void get_grid_size(
+		double xl, double xu, double yl, double yu,
+		double dist_min,
+		double &cell_size, size_t &x_num, size_t &y_num);
+};
+
+#endif
@@ -1,10 +1,27 @@
 #version 330
 
 in vec3 obj_color;
+in vec2 local_coord;
+flat in float radius_px;
+flat in float coord_scale;
 
 out vec4 frag_color;
 
+uniform int draw_mode;
+
 void main()
 {
-	frag_color = vec4(obj_color, 1.0f);
+	if (draw_mode == 0)
+	{
+		frag_color = vec4(obj_color, 1.0f);
+		return;
+	}
+
+	// sprite coordinate has y pointing down, disc is symmetric
+	vec2 p = draw_mode == 2 ? (gl_PointCoord * 2.0f - 1.0f) * coord_scale : local_coord;
+	// coverage of one pixel wide edge
+	float alpha = clamp((1.0f - length(p)) * radius_px + 0.5f, 0.0f, 1.0f);
+	if (alpha <= 0.0f)
+		discard;
+	frag_color = vec4(obj_color, alpha);
 }
@@ -8,14 +8,31 @@ layout (location = 1) in vec2 pt_coord;
 layout (location = 2) in float pt_radius;
 layout (location = 3) in vec3 pt_color;
 
+#include "frame_data.glsl"
+
 out vec3 obj_color;
+// position in unit disc, beyond 1 on the antialiased rim
+out vec2 local_coord;
+flat out float radius_px;
+flat out float coord_scale;
 
-uniform mat4 proj_mat;
+// 0 mesh, 1 quad, 2 points, see CirclesGLBuffer::DrawMode
+uniform int draw_mode;
+// screen pixels per unit length
+uniform float pixel_scale;
 
 void main()
 {
 	obj_color = pt_color;
-    
-    vec2 cur_coord = node_coord * pt_radius + pt_coord;
-	gl_Position = proj_mat * vec4(cur_coord, 0.0f, 1.0f);
+	radius_px = pt_radius * pixel_scale;
+	// grow quads and sprites by one pixel for the rim
+	coord_scale = draw_mode == 0 ? 1.0f : (radius_px + 1.0f) / max(radius_px, 1.0e-6f);
+
+	local_coord = node_coord * coord_scale;
+	vec2 cur_coord = pt_coord;
+	if (draw_mode == 2)
+		gl_PointSize = 2.0f * (radius_px + 1.0f);
+	else
+		cur_coord += local_coord * pt_radius;
+	gl_Position = projection * vec4(cur_coord, 0.0f, 1.0f);
 }
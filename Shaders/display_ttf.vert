@@ -2,9 +2,9 @@
 
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
 
-out vec2 TexCoords;
+#include "frame_data.glsl"
 
-uniform mat4 projection;
+out vec2 TexCoords;
 
 void main()
 {
@@ -0,0 +1,10 @@
+// per frame constants, see FrameData in OpenGLShaderUtilities.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    // x, y, width, height
+    vec4 viewport;
+    // seconds
+    float time;
+};
@@ -1,12 +1,35 @@
 #version 330 core
 
+#include "mesh_lighting.glsl"
+
 out vec4 FragColor;
 
 in vec2 TexCoords;
+in vec3 Normal;
+#ifdef HAS_NORMAL_MAP
+in mat3 TBN;
+#endif
 
+#ifdef HAS_DIFFUSE_MAP
 uniform sampler2D texture_diffuse1;
+#else
+uniform vec4 base_color = vec4(0.8, 0.8, 0.8, 1.0);
+#endif
+#ifdef HAS_NORMAL_MAP
+uniform sampler2D texture_normal1;
+#endif
 
 void main()
 {    
-    FragColor = texture(texture_diffuse1, TexCoords);
+#ifdef HAS_DIFFUSE_MAP
+    vec4 color = texture(texture_diffuse1, TexCoords);
+#else
+    vec4 color = base_color;
+#endif
+#ifdef HAS_NORMAL_MAP
+    vec3 normal = TBN * (texture(texture_normal1, TexCoords).xyz * 2.0 - 1.0);
+#else
+    vec3 normal = Normal;
+#endif
+    FragColor = vec4(color.rgb * mesh_diffuse(normal), color.a);
 }
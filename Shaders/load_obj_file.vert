@@ -2,15 +2,30 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#ifdef HAS_NORMAL_MAP
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+#endif
+
+#include "frame_data.glsl"
 
 out vec2 TexCoords;
+out vec3 Normal;
+#ifdef HAS_NORMAL_MAP
+out mat3 TBN;
+#endif
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
     TexCoords = aTexCoords;    
+    mat3 normal_mat = mat3(model);
+    Normal = normal_mat * aNormal;
+#ifdef HAS_NORMAL_MAP
+    TBN = mat3(normalize(normal_mat * aTangent),
+               normalize(normal_mat * aBitangent),
+               normalize(Normal));
+#endif
     gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
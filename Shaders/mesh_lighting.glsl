@@ -0,0 +1,9 @@
+// shared by load_obj_file shaders, included after #version
+
+const vec3 light_dir = vec3(0.3, 0.8, 0.5);
+
+// half lambert so that back faces aren't black
+float mesh_diffuse(vec3 normal)
+{
+    return 0.5 + 0.5 * dot(normalize(normal), normalize(light_dir));
+}
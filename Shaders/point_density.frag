@@ -0,0 +1,19 @@
+#version 330
+
+in vec2 tex_coord;
+
+out vec4 frag_color;
+
+// point count of each pixel
+uniform sampler2D density_map;
+uniform sampler1D color_map;
+uniform float log_max_count;
+
+void main()
+{
+	float count = texture(density_map, tex_coord).r;
+	if (count <= 0.0f)
+		discard;
+	float t = log(1.0f + count) / max(log_max_count, 1.0e-6f);
+	frag_color = texture(color_map, t);
+}
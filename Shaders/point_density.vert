@@ -0,0 +1,11 @@
+#version 330
+
+// full screen quad from vertex id, no vertex buffer
+out vec2 tex_coord;
+
+void main()
+{
+	vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+	tex_coord = corner;
+	gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f);
+}
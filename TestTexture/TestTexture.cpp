@@ -27,10 +27,10 @@ int TestTexture::init()
     };
 
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    gl_state.bind_vertex_array(vao);
 
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_state.bind_buffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(
         GL_ARRAY_BUFFER,
         sizeof(vertices),
@@ -39,7 +39,7 @@ int TestTexture::init()
     );
 
     glGenBuffers(1, &ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    gl_state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(
         GL_ELEMENT_ARRAY_BUFFER,
         sizeof(indices),
@@ -66,15 +66,15 @@ int TestTexture::init()
         }
 
         glGenTextures(1, &texture1d);
-        glBindTexture(GL_TEXTURE_1D, texture1d);
+        gl_state.bind_texture(GL_TEXTURE_1D, texture1d);
         glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, 256, 0, GL_RGB, GL_UNSIGNED_BYTE, color_map_data);
         glGenerateMipmap(GL_TEXTURE_1D);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_1D, texture1d);
+        gl_state.active_texture(GL_TEXTURE0);
+        gl_state.bind_texture(GL_TEXTURE_1D, texture1d);
 
         shader_1d.create("../../Shaders/test_texture1D.vert",
                          "../../Shaders/test_texture1D.frag");
@@ -86,7 +86,7 @@ int TestTexture::init()
         // ===================== 2D Texture =====================
         // texture 1
         glGenTextures(1, &texture2d1);
-        glBindTexture(GL_TEXTURE_2D, texture2d1);
+        gl_state.bind_texture(GL_TEXTURE_2D, texture2d1);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
@@ -106,7 +106,7 @@ int TestTexture::init()
 
         // texture 2
         glGenTextures(1, &texture2d2);
-        glBindTexture(GL_TEXTURE_2D, texture2d2);
+        gl_state.bind_texture(GL_TEXTURE_2D, texture2d2);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -123,10 +123,10 @@ int TestTexture::init()
             std::cout << "Failed to load 2d texture.\n";
         stbi_image_free(data);
 
-        glActiveTexture(GL_TEXTURE0); // 0
-        glBindTexture(GL_TEXTURE_2D, texture2d1);
-        glActiveTexture(GL_TEXTURE1); // 1
-        glBindTexture(GL_TEXTURE_2D, texture2d2);
+        gl_state.active_texture(GL_TEXTURE0); // 0
+        gl_state.bind_texture(GL_TEXTURE_2D, texture2d1);
+        gl_state.active_texture(GL_TEXTURE1); // 1
+        gl_state.bind_texture(GL_TEXTURE_2D, texture2d2);
 
         shader_2d.create("../../Shaders/test_texture2D.vert",
                          "../../Shaders/test_texture2D.frag");
@@ -150,7 +150,7 @@ int TestTexture::paint()
     {
         shader_2d.use();
     }
-    glBindVertexArray(vao);
+    gl_state.bind_vertex_array(vao);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
     return 0;
@@ -160,32 +160,32 @@ void TestTexture::destroy()
 {
     if (ebo)
     {
-        glDeleteBuffers(1, &ebo);
+        gl_state.delete_buffers(1, &ebo);
         ebo = 0;
     }
     if (vbo)
     {
-        glDeleteBuffers(1, &vbo);
+        gl_state.delete_buffers(1, &vbo);
         vbo = 0;
     }
     if (vao)
     {
-        glDeleteVertexArrays(1, &vao);
+        gl_state.delete_vertex_arrays(1, &vao);
         vao = 0;
     }
     if (texture1d)
     {
-        glDeleteTextures(1, &texture1d);
+        gl_state.delete_textures(1, &texture1d);
         texture1d = 0;
     }
     if (texture2d1)
     {
-        glDeleteTextures(1, &texture2d1);
+        gl_state.delete_textures(1, &texture2d1);
         texture2d1 = 0;
     }
     if (texture2d2)
     {
-        glDeleteTextures(1, &texture2d2);
+        gl_state.delete_textures(1, &texture2d2);
         texture2d2 = 0;
     }
 }
\ No newline at end of file
@@ -1,19 +1,99 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "GlfwApp.h"
+#include "OpenGLShaderUtilities.h"
+
 #include "TestsMain.h"
 
-int main(int argc, char** argv)
+struct TestEntry
 {
-	//test_imgui(argc, argv);
+	const char* name;
+	int (*func)(int argc, char** argv);
+};
+
+static const TestEntry tests[] = {
+	{ "imgui", test_imgui },
+	{ "load_obj_model", test_load_obj_model },
+	{ "texture", test_texture },
+	{ "display_ttf", test_display_ttf },
+	{ "pds_result_view", test_pds_result_view },
+	{ "random_point_queue", test_random_point_queue },
+	{ "point_set_file", test_point_set_file },
+	{ "pds_analysis", test_pds_analysis },
+	{ "point_set_sort", test_point_set_sort },
+	{ "approx_sampling", test_approx_sampling },
+	{ "pds_gpu", test_pds_gpu },
+	{ "circles_stream", test_circles_stream },
+	{ "point_quadtree", test_point_quadtree },
+	{ "headless", test_headless },
+	{ "spsc_queue", test_spsc_queue },
+	{ "async_shader_build", test_async_shader_build },
+	{ "program_pipeline", test_program_pipeline },
+	{ "obj_file_parser", test_obj_file_parser },
+	{ "mesh_cache", test_mesh_cache },
+	{ "frame_profiler", test_frame_profiler }
+};
 
-	//test_load_obj_model(argc, argv);
+static void print_usage(const char* exe_name)
+{
+	std::cout << "Usage: " << exe_name << " [test] [options]\n"
+		<< "Options:\n"
+		<< "  --headless            render without window\n"
+		<< "  --render-thread       paint in thread separate from events\n"
+		<< "  --shader-cache <dir>  cache program binaries in existing dir\n"
+		<< "  --benchmark           time frames with vsync off\n"
+		<< "  --warmup <num>        warm up frames of benchmark, default 60\n"
+		<< "  --frames <num>        measured frames of benchmark, default 600\n"
+		<< "  --json <file>         write benchmark report\n"
+		<< "Tests:\n";
+	for (size_t t_id = 0; t_id < sizeof(tests) / sizeof(tests[0]); ++t_id)
+		std::cout << "  " << tests[t_id].name << "\n";
+}
 
-	//test_texture(argc, argv);
-	
-	//test_display_ttf(argc, _pds_result_view(argc, argv);
-	
-	test_pds_result_view(argc, argv);
+int main(int argc, char** argv)
+{
+	// keep default of running pds_result_view
+	const char* test_name = "pds_result_view";
+	bool benchmark = false;
+	size_t warmup_num = 60, frame_num = 600;
+	const char* json_filename = nullptr;
+	for (int a_id = 1; a_id < argc; ++a_id)
+	{
+		const char* arg = argv[a_id];
+		if (!strcmp(arg, "--headless"))
+			GlfwApp::set_default_headless(true);
+		else if (!strcmp(arg, "--render-thread"))
+			GlfwApp::set_default_render_thread(true);
+		else if (!strcmp(arg, "--shader-cache") && a_id + 1 < argc)
+			OpenGLShaderProgram::set_binary_cache_dir(argv[++a_id]);
+		else if (!strcmp(arg, "--benchmark"))
+			benchmark = true;
+		else if (!strcmp(arg, "--warmup") && a_id + 1 < argc)
+			warmup_num = size_t(atol(argv[++a_id]));
+		else if (!strcmp(arg, "--frames") && a_id + 1 < argc)
+			frame_num = size_t(atol(argv[++a_id]));
+		else if (!strcmp(arg, "--json") && a_id + 1 < argc)
+			json_filename = argv[++a_id];
+		else if (!strcmp(arg, "--help") || !strcmp(arg, "-h"))
+		{
+			print_usage(argv[0]);
+			return 0;
+		}
+		else if (arg[0] != '-')
+			test_name = arg;
+	}
+	if (benchmark)
+		GlfwApp::set_default_benchmark(warmup_num, frame_num, json_filename);
 
-	//test_random_point_queue(argc, argv);
+	for (size_t t_id = 0; t_id < sizeof(tests) / sizeof(tests[0]); ++t_id)
+	{
+		if (!strcmp(tests[t_id].name, test_name))
+			return tests[t_id].func(argc, argv);
+	}
 
+	std::cout << "Unknown test " << test_name << ".\n";
+	print_usage(argv[0]);
 	//system("pause");
-	return 0;
+	return -1;
 }
@@ -11,5 +11,26 @@ int test_texture(int argc, char** argv);
 int test_display_ttf(int argc, char** argv);
 int test_pds_result_view(int argc, char** argv);
 int test_random_point_queue(int argc, char** argv);
+int test_point_set_file(int argc, char** argv);
+int test_pds_analysis(int argc, char** argv);
+int test_point_set_sort(int argc, char** argv);
+int test_approx_sampling(int argc, char** argv);
+int test_pds_gpu(int argc, char** argv);
+int test_circles_stream(int argc, char** argv);
+int test_point_quadtree(int argc, char** argv);
+int test_headless(int argc, char** argv);
+int test_spsc_queue(int argc, char** argv);
+int test_async_shader_build(int argc, char** argv);
+int test_program_pipeline(int argc, char** argv);
+int test_obj_file_parser(int argc, char** argv);
+int test_mesh_cache(int argc, char** argv);
+int test_frame_profiler(int argc, char** argv);
+
+// test_obj_fixtures.cpp
+// obj of grid_res x grid_res quads, materials "lower" and "upper"
+void write_grid_obj(const char* filename, const char* mtl_filename, size_t grid_res);
+// upper_normal may be nullptr
+void write_grid_mtl(const char* filename, const char* lower_diffuse,
+	const char* upper_diffuse, const char* upper_normal);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "PoissonDiskSampling.h"
+#include "ApproxBlueNoiseSampling.h"
+#include "PDSAnalysis.h"
+
+#include "TestsMain.h"
+
+// time sampler and write its rdf and power spectrum to csv
+static void analyse_sampler(PointSamplingBase &sampler,
+	const char *name, double dist_min)
+{
+	using std::chrono::system_clock;
+
+	system_clock::time_point start_time = system_clock::now();
+	sampler.generate_points_in_rect(0.0, 1.0, 0.0, 1.0, dist_min);
+	system_clock::time_point end_time = system_clock::now();
+	std::chrono::microseconds duration
+		= std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+	std::vector<glm::vec2> &pts = sampler.get_points();
+	double pt_per_sec = duration.count() ?
+		double(pts.size()) / (double(duration.count()) * 1.0e-6) : 0.0;
+	std::cout << name << ": " << pts.size() << " points in "
+		<< duration.count() / 1000 << " ms, "
+		<< pt_per_sec * 1.0e-6 << " M points/s" << std::endl;
+
+	PDSAnalysis analysis;
+	analysis.compute_rdf(pts, 0.0, 1.0, 0.0, 1.0, 5.0 * dist_min, 100);
+	analysis.output_rdf_to_csv((std::string(name) + "_rdf.csv").c_str());
+	analysis.compute_power_spectrum(pts, 0.0, 1.0, 0.0, 1.0, 1024);
+	analysis.output_spectrum_to_csv((std::string(name) + "_spectrum.csv").c_str());
+}
+
+int test_approx_sampling(int argc, char** argv)
+{
+	const double dist_min = 0.002;
+
+	PoissonDiskSampling pds;
+	analyse_sampler(pds, "poisson_disk", dist_min);
+
+	ApproxBlueNoiseSampling approx;
+	approx.set_mode(ApproxBlueNoiseSampling::JitteredGrid);
+	analyse_sampler(approx, "jittered_grid", dist_min);
+	approx.set_mode(ApproxBlueNoiseSampling::HexJitter);
+	analyse_sampler(approx, "hex_jitter", dist_min);
+	approx.set_mode(ApproxBlueNoiseSampling::RelaxedStratified);
+	analyse_sampler(approx, "relaxed_stratified", dist_min);
+
+	// domain narrower than spacing: square lattice keeps one point
+	// per row, hex lattice has no points in odd rows
+	size_t error_num = 0;
+	approx.set_mode(ApproxBlueNoiseSampling::RelaxedStratified);
+	approx.generate_points_in_rect(0.0, 0.05, 0.0, 1.0, 0.1);
+	if (approx.get_points().size() != 10)
+		++error_num;
+	approx.set_mode(ApproxBlueNoiseSampling::HexJitter);
+	approx.generate_points_in_rect(0.0, 0.05, 0.0, 1.0, 0.1);
+	if (approx.get_points().size() != 6)
+		++error_num;
+	std::cout << "narrow domain: " << error_num << " errors" << std::endl;
+
+	return error_num == 0 ? 0 : -1;
+}
@@ -0,0 +1,209 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "GlfwApp.h"
+#include "OpenGLShaderUtilities.h"
+
+#include "TestsMain.h"
+
+// Builds many variants of circles_shader without blocking frames,
+// screen blinks while programs are compiled by driver threads.
+class ShaderBuildView : public GlfwApp
+{
+protected:
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	size_t program_num;
+	std::vector<OpenGLShaderProgram> programs;
+	bool all_built;
+	size_t loading_frame_num;
+	double max_loading_frame_ms;
+	TimePoint build_start_time, last_frame_time;
+
+	static double get_ms(TimePoint start, TimePoint end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+public:
+	ShaderBuildView(size_t num) :
+		program_num(num), programs(num),
+		all_built(false), loading_frame_num(0),
+		max_loading_frame_ms(0.0) {}
+
+	int init() override
+	{
+		std::string vert_code, frag_code;
+		if (!OpenGLShader::preprocess_file("../../Shaders/circles_shader.vert", nullptr, vert_code) ||
+			!OpenGLShader::preprocess_file("../../Shaders/circles_shader.frag", nullptr, frag_code))
+			return -1;
+
+		const OpenGLShader::ShaderType types[2] = { OpenGLShader::Vertex, OpenGLShader::Fragment };
+		build_start_time = std::chrono::steady_clock::now();
+		for (size_t p_id = 0; p_id < program_num; ++p_id)
+		{
+			// different source so that driver can't reuse programs
+			std::string variant_code = frag_code + "\n// variant " + std::to_string(p_id) + "\n";
+			const char* codes[2] = { vert_code.c_str(), variant_code.c_str() };
+			if (!programs[p_id].create_async_from_code(types, codes, 2))
+				return -1;
+		}
+		last_frame_time = std::chrono::steady_clock::now();
+		std::cout << "submit " << program_num << " programs: "
+			<< get_ms(build_start_time, last_frame_time) << " ms\n";
+		return 0;
+	}
+
+	int paint() override
+	{
+		if (all_built)
+		{
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			return 0;
+		}
+
+		size_t built_num = 0, linked_num = 0;
+		for (size_t p_id = 0; p_id < program_num; ++p_id)
+		{
+			if (programs[p_id].poll_build())
+			{
+				++built_num;
+				if (programs[p_id].is_linked())
+					++linked_num;
+			}
+		}
+
+		TimePoint cur_time = std::chrono::steady_clock::now();
+		if (built_num < program_num)
+		{
+			// loading screen
+			float c = float(loading_frame_num % 60) / 60.0f;
+			glClearColor(c, c, c, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			double frame_ms = get_ms(last_frame_time, cur_time);
+			if (frame_ms > max_loading_frame_ms)
+				max_loading_frame_ms = frame_ms;
+			last_frame_time = cur_time;
+			++loading_frame_num;
+			invalidate();
+			return 0;
+		}
+
+		all_built = true;
+		std::cout << linked_num << " of " << program_num << " programs built in "
+			<< get_ms(build_start_time, cur_time) << " ms, "
+			<< loading_frame_num << " loading frames, longest "
+			<< max_loading_frame_ms << " ms\n";
+		// vertex stage is shared by all programs
+		std::cout << OpenGLShaderCache::get_shader_num() << " shaders compiled, "
+			<< OpenGLShaderCache::get_hit_num() << " reused\n";
+		return paint();
+	}
+
+	void destroy() override
+	{
+		programs.clear();
+		if (OpenGLShaderCache::get_shader_num() != 0)
+			std::cout << "shaders are still cached after programs are deleted\n";
+	}
+};
+
+namespace
+{
+	// full screen triangle
+	const char* const stage_vert_code =
+		"#version 330 core\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 pos = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0;\n"
+		"	gl_Position = vec4(pos, 0.0, 1.0);\n"
+		"}\n";
+	const char* const stage_frag_code =
+		"#version 330 core\n"
+		"out vec4 frag_color;\n"
+		"void main()\n"
+		"{\n"
+		"	frag_color = vec4(0.2, 0.6, 1.0, 1.0);\n"
+		"}\n";
+}
+
+// Program is a member and outlives the context, the next app
+// must compile its stages again instead of reusing stale shaders.
+class SharedStageView : public GlfwApp
+{
+protected:
+	OpenGLShaderProgram program;
+	GLuint vao_id;
+
+public:
+	SharedStageView() : vao_id(0) {}
+
+	int init() override
+	{
+		const OpenGLShader::ShaderType types[2] = { OpenGLShader::Vertex, OpenGLShader::Fragment };
+		const char* codes[2] = { stage_vert_code, stage_frag_code };
+		if (!program.create_from_code(types, codes, 2))
+			return -1;
+		glGenVertexArrays(1, &vao_id);
+		return 0;
+	}
+
+	int paint() override
+	{
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		program.use();
+		gl_state.bind_vertex_array(vao_id);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		return 0;
+	}
+
+	void destroy() override
+	{
+		if (vao_id)
+		{
+			gl_state.delete_vertex_arrays(1, &vao_id);
+			vao_id = 0;
+		}
+	}
+};
+
+// same stages in two headless apps one after another
+static int run_shared_stage_apps()
+{
+	SharedStageView first_app, second_app;
+	first_app.set_headless(true);
+	second_app.set_headless(true);
+	if (first_app.run_frames(1, "shared_stage_first.png", 64, 64) ||
+		second_app.run_frames(1, "shared_stage_second.png", 64, 64))
+	{
+		std::cout << "stages can't be built in sequential contexts\n";
+		return -1;
+	}
+	if (OpenGLShaderCache::get_shader_num() != 0 ||
+		first_app.get_drawn_pixel_num() == 0 ||
+		second_app.get_drawn_pixel_num() == 0)
+	{
+		std::cout << "shared stages aren't drawn in sequential contexts\n";
+		return -1;
+	}
+	return 0;
+}
+
+int test_async_shader_build(int argc, char** argv)
+{
+	int res = 0;
+	{
+		ShaderBuildView app(48);
+		app.set_win_name("Async shader build");
+		if (app.is_headless())
+			res = app.run_frames(600);
+		else
+			app.run();
+	}
+	res |= run_shared_stage_apps();
+	return res;
+}
@@ -0,0 +1,124 @@
+#include <cmath>
+#include <chrono>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "OpenGLShaderUtilities.h"
+#include "CirclesGLBuffer.h"
+#include "GlfwApp.h"
+
+#include "TestsMain.h"
+
+// rotate a point cloud every frame through CirclesGLBuffer::update()
+class CirclesStreamView : public GlfwApp
+{
+protected:
+	CirclesGLBuffer point_buf;
+	OpenGLShaderProgram point_shader;
+	OpenGLUniformBuffer frame_ubo;
+
+	CirclesGLBuffer::InstStyle inst_style;
+	std::vector<glm::vec2> init_pts, pts;
+	// used by PerInstanceStyle
+	std::vector<float> radii;
+	std::vector<glm::vec3> colors;
+	size_t frame_id;
+	double update_time_sum;
+
+public:
+	CirclesStreamView(CirclesGLBuffer::InstStyle style) :
+		inst_style(style), frame_id(0), update_time_sum(0.0)
+	{
+		// points move every frame
+		set_continuous_redraw(true);
+	}
+
+	int init() override
+	{
+		FrameData frame_data;
+		frame_data.projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
+		frame_data.view = glm::mat4(1.0f);
+		frame_data.viewport = glm::vec4(0.0f, 0.0f, float(width), float(height));
+		frame_data.time = 0.0f;
+		frame_ubo.create(FrameData::layout);
+		frame_ubo.update(frame_data);
+		point_shader.create("../../Shaders/circles_shader.vert",
+							"../../Shaders/circles_shader.frag");
+		// small points are drawn as sprites in CirclesGLBuffer::AutoMode
+		point_buf.set_pixel_scale(0.5f * float(height));
+
+		// concentric rings of points
+		const size_t ring_num = 1000;
+		const size_t ring_pt_num = 1000;
+		init_pts.resize(ring_num * ring_pt_num);
+		radii.resize(init_pts.size());
+		colors.resize(init_pts.size());
+		for (size_t r_id = 0; r_id < ring_num; ++r_id)
+		{
+			float r = 0.95f * float(r_id + 1) / float(ring_num);
+			for (size_t p_id = 0; p_id < ring_pt_num; ++p_id)
+			{
+				float a = 6.2831853f * float(p_id) / float(ring_pt_num);
+				size_t id = r_id * ring_pt_num + p_id;
+				init_pts[id] = glm::vec2(r * cos(a), r * sin(a));
+				radii[id] = 0.0005f + 0.002f * r;
+				colors[id] = glm::vec3(r, 1.0f - r, 0.804f);
+			}
+		}
+		pts.resize(init_pts.size());
+		return point_buf.init_stream(init_pts.size(), 1.0e-6f,
+			glm::vec3(1.0f, 1.0f, 0.804f), inst_style);
+	}
+
+	int paint() override
+	{
+		// inner rings spin faster
+		float t = float(frame_id) * 0.01f;
+		for (size_t p_id = 0; p_id < pts.size(); ++p_id)
+		{
+			const glm::vec2 &p = init_pts[p_id];
+			float a = t / (0.05f + sqrt(p.x * p.x + p.y * p.y));
+			float c = cos(a), s = sin(a);
+			pts[p_id] = glm::vec2(c * p.x - s * p.y, s * p.x + c * p.y);
+		}
+
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+		point_buf.update(&pts[0], &radii[0], &colors[0], pts.size());
+		std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+		update_time_sum += std::chrono::duration<double, std::milli>(end_time - start_time).count();
+		if (++frame_id % 100 == 0)
+		{
+			std::cout << "update " << pts.size() << " points: "
+				<< update_time_sum / 100.0 << " ms/frame\n";
+			update_time_sum = 0.0;
+		}
+
+		glClear(GL_COLOR_BUFFER_BIT);
+		point_shader.use();
+		point_buf.draw(point_shader);
+		return 0;
+	}
+
+	int resize(int wd, int ht) override
+	{
+		glViewport(0, 0, wd, ht);
+		point_buf.set_pixel_scale(0.5f * float(ht));
+		return 0;
+	}
+
+	void destroy() override
+	{
+		point_buf.clear();
+		frame_ubo.destroy();
+	}
+};
+
+int test_circles_stream(int argc, char** argv)
+{
+	// 8 bytes per point with CirclesGLBuffer::UniformStyle
+	CirclesStreamView view(CirclesGLBuffer::PerInstanceStyle);
+	// persistent mapping needs opengl 4.4
+	view.set_gl_version(4, 4);
+	return view.run();
+}
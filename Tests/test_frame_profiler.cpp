@@ -0,0 +1,238 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+
+#include "FrameProfiler.h"
+
+#include "TestsMain.h"
+
+namespace
+{
+	// Minimal JSON syntax check, return false if value
+	// at pos isn't well formed. Counts "ph":"X" events.
+	class JsonChecker
+	{
+	protected:
+		std::string text;
+		size_t pos;
+
+		void skip_space()
+		{
+			while (pos < text.size() && isspace((unsigned char)text[pos]))
+				++pos;
+		}
+		bool expect(char c)
+		{
+			skip_space();
+			if (pos >= text.size() || text[pos] != c)
+				return false;
+			++pos;
+			return true;
+		}
+		bool parse_string(std::string* str)
+		{
+			if (!expect('"'))
+				return false;
+			for (; pos < text.size(); ++pos)
+			{
+				char c = text[pos];
+				if (c == '"')
+				{
+					++pos;
+					return true;
+				}
+				if ((unsigned char)c < 0x20)
+					return false;
+				if (c == '\\')
+				{
+					if (++pos >= text.size() || !strchr("\"\\/bfnrtu", text[pos]))
+						return false;
+					c = text[pos];
+				}
+				if (str)
+					*str += c;
+			}
+			return false;
+		}
+		bool parse_number()
+		{
+			skip_space();
+			size_t start = pos;
+			if (pos < text.size() && text[pos] == '-')
+				++pos;
+			while (pos < text.size() && (isdigit((unsigned char)text[pos]) ||
+				text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E' ||
+				text[pos] == '+' || text[pos] == '-'))
+				++pos;
+			return pos > start && isdigit((unsigned char)text[pos - 1]);
+		}
+		bool parse_object()
+		{
+			if (!expect('{'))
+				return false;
+			skip_space();
+			if (pos < text.size() && text[pos] == '}')
+				return expect('}');
+			bool is_complete_event = false;
+			do
+			{
+				std::string key, value;
+				if (!parse_string(&key) || !expect(':'))
+					return false;
+				skip_space();
+				if (key == "ph" && pos < text.size() && text[pos] == '"')
+				{
+					if (!parse_string(&value))
+						return false;
+					is_complete_event = value == "X";
+				}
+				else if (!parse_value())
+					return false;
+			} while (expect(','));
+			if (is_complete_event)
+				++event_num;
+			return expect('}');
+		}
+		bool parse_array()
+		{
+			if (!expect('['))
+				return false;
+			skip_space();
+			if (pos < text.size() && text[pos] == ']')
+				return expect(']');
+			do
+			{
+				if (!parse_value())
+					return false;
+			} while (expect(','));
+			return expect(']');
+		}
+		bool parse_value()
+		{
+			skip_space();
+			if (pos >= text.size())
+				return false;
+			switch (text[pos])
+			{
+			case '{':
+				return parse_object();
+			case '[':
+				return parse_array();
+			case '"':
+				return parse_string(nullptr);
+			case 't':
+			case 'f':
+			case 'n':
+			{
+				const char* words[3] = { "true", "false", "null" };
+				for (size_t w_id = 0; w_id < 3; ++w_id)
+				{
+					if (!text.compare(pos, strlen(words[w_id]), words[w_id]))
+					{
+						pos += strlen(words[w_id]);
+						return true;
+					}
+				}
+				return false;
+			}
+			default:
+				return parse_number();
+			}
+		}
+
+	public:
+		size_t event_num;
+
+		JsonChecker(const std::string& txt) : text(txt), pos(0), event_num(0) {}
+
+		bool check()
+		{
+			if (!parse_value())
+				return false;
+			skip_space();
+			return pos == text.size();
+		}
+	};
+
+	size_t check_stats(const char* name, const std::vector<float>& samples,
+		const FrameProfiler::Stats& expected)
+	{
+		FrameProfiler::Stats stats;
+		FrameProfiler::compute_stats(samples, stats);
+		const double eps = 1e-6;
+		if (stats.count != expected.count ||
+			std::abs(stats.mean - expected.mean) > eps ||
+			stats.min != expected.min || stats.p50 != expected.p50 ||
+			stats.p95 != expected.p95 || stats.p99 != expected.p99 ||
+			stats.max != expected.max)
+		{
+			std::cout << name << ": count " << stats.count << ", mean " << stats.mean
+				<< ", min " << stats.min << ", p50 " << stats.p50 << ", p95 " << stats.p95
+				<< ", p99 " << stats.p99 << ", max " << stats.max << "\n";
+			return 1;
+		}
+		return 0;
+	}
+}
+
+// Statistics and trace of FrameProfiler without gl context,
+// only cpu times are added.
+int test_frame_profiler(int argc, char** argv)
+{
+	size_t error_num = 0;
+
+	// nearest rank percentiles, samples in any order
+	std::vector<float> samples;
+	for (size_t s_id = 100; s_id > 0; --s_id)
+		samples.push_back(float(s_id));
+	FrameProfiler::Stats expected = { 100, 50.5, 1.0, 50.0, 95.0, 99.0, 100.0 };
+	error_num += check_stats("1..100", samples, expected);
+	samples.resize(10); // 100..91
+	expected = { 10, 95.5, 91.0, 95.0, 100.0, 100.0, 100.0 };
+	error_num += check_stats("91..100", samples, expected);
+	samples.assign(1, 2.5f);
+	expected = { 1, 2.5, 2.5, 2.5, 2.5, 2.5, 2.5 };
+	error_num += check_stats("single", samples, expected);
+	samples.clear();
+	expected = { 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	error_num += check_stats("empty", samples, expected);
+
+	// rolling window keeps the latest samples
+	FrameProfiler profiler;
+	profiler.set_window_size(4);
+	profiler.set_trace_enabled(true);
+	uint32_t section_id = profiler.get_section_id("upload");
+	for (size_t s_id = 1; s_id <= 6; ++s_id)
+		profiler.add_cpu_time(section_id, s_id * 10000.0, s_id * 10000.0 + s_id * 1000.0);
+	FrameProfiler::Stats stats;
+	if (!profiler.get_cpu_stats("upload", stats) || stats.count != 4 ||
+		stats.min != 3.0 || stats.max != 6.0)
+	{
+		std::cout << "rolling window keeps wrong samples\n";
+		++error_num;
+	}
+
+	// names are escaped in trace
+	uint32_t quoted_id = profiler.get_section_id("say \"hi\" \\ bye");
+	profiler.add_cpu_time(quoted_id, 70000.0, 70500.0);
+	const char* trace_filename = "test_frame_profiler.json";
+	if (profiler.write_chrome_trace(trace_filename))
+		return -1;
+	std::ifstream file(trace_filename);
+	std::stringstream trace;
+	trace << file.rdbuf();
+	JsonChecker checker(trace.str());
+	bool is_valid = checker.check();
+	std::cout << "trace is " << (is_valid ? "" : "not ") << "well formed, "
+		<< checker.event_num << " events\n";
+	if (!is_valid || checker.event_num != 7)
+		++error_num;
+
+	std::cout << error_num << " errors" << std::endl;
+	return error_num == 0 ? 0 : -1;
+}
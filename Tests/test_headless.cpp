@@ -0,0 +1,50 @@
+#include "TestsMain.h"
+
+#include "PDSResultView.h"
+#include "TestTexture.h"
+#include "DisplayTtf.h"
+#include "LoadObjFile.h"
+
+// frame must have content besides clear color
+static int check_frame(GlfwApp& app, const char* name)
+{
+	const size_t min_drawn_pixel_num = 100;
+	size_t drawn_num = app.get_drawn_pixel_num();
+	std::cout << name << ": " << drawn_num << " drawn pixels\n";
+	return drawn_num >= min_drawn_pixel_num ? 0 : -1;
+}
+
+// Render a few frames of each app without window and save the last one.
+// On servers without display, configure with -DGLFWAPP_USE_EGL=ON and
+// set LIBGL_ALWAYS_SOFTWARE=1 to use Mesa llvmpipe.
+int test_headless(int argc, char** argv)
+{
+	int res = 0;
+	{
+		PDSResultView app;
+		app.set_headless(true);
+		res |= app.run_frames(3, "headless_pds_result_view.png");
+		res |= check_frame(app, "pds_result_view");
+	}
+	{
+		TestTexture app;
+		app.set_headless(true);
+		app.set_texture_dim(TestTexture::one_d);
+		res |= app.run_frames(3, "headless_texture.png");
+		res |= check_frame(app, "texture");
+	}
+	{
+		DisplayTtf app;
+		app.set_headless(true);
+		res |= app.run_frames(3, "headless_display_ttf.png");
+		res |= check_frame(app, "display_ttf");
+	}
+	{
+		LoadObjFile app;
+		app.set_headless(true);
+		res |= app.run_frames(3, "headless_load_obj_model.png");
+		res |= check_frame(app, "load_obj_model");
+	}
+	std::cout << (res ? "headless rendering failed\n" : "headless frames saved\n");
+	return res;
+}
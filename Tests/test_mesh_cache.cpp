@@ -0,0 +1,290 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GlfwApp.h"
+#include "PngWriter.h"
+#include "ObjFileParser.h"
+#include "MeshCacheFile.h"
+#include "ObjModel.h"
+
+#include "TestsMain.h"
+
+namespace
+{
+	size_t compare_cache(MeshCacheFile& file, std::vector<MeshGLBuffer>& meshes)
+	{
+		if (file.get_mesh_num() != meshes.size())
+			return 1;
+		size_t error_num = 0;
+		for (size_t m_id = 0; m_id < meshes.size(); ++m_id)
+		{
+			const MeshCacheMesh& cache_mesh = file.get_mesh(m_id);
+			std::vector<Vertex>& vertices = meshes[m_id].get_vertices();
+			std::vector<GLuint>& indices = meshes[m_id].get_indices();
+			if (cache_mesh.vertex_num != vertices.size() ||
+				cache_mesh.index_num != indices.size() ||
+				memcmp(file.get_vertices(m_id), vertices.data(), vertices.size() * sizeof(Vertex)) ||
+				memcmp(file.get_indices(m_id), indices.data(), indices.size() * sizeof(GLuint)))
+				++error_num;
+			// blobs can be passed to glBufferData as they are
+			if ((size_t(file.get_vertices(m_id)) | size_t(file.get_indices(m_id))) % 16)
+				++error_num;
+
+			std::vector<Texture>& textures = meshes[m_id].get_textures();
+			const MeshCacheMaterial& material = file.get_material(cache_mesh.material_id);
+			if (material.texture_num != textures.size())
+			{
+				++error_num;
+				continue;
+			}
+			for (size_t t_id = 0; t_id < textures.size(); ++t_id)
+			{
+				const MeshCacheTexture& texture = file.get_texture(material.first_texture + t_id);
+				if (textures[t_id].filename != texture.filename ||
+					textures[t_id].type != texture.type)
+					++error_num;
+			}
+		}
+		return error_num;
+	}
+
+	const char* const view_vert_code =
+		"#version 330 core\n"
+		"layout(location = 0) in vec3 position;\n"
+		"layout(location = 2) in vec2 tex_coord;\n"
+		"out vec2 uv;\n"
+		"void main()\n"
+		"{\n"
+		"	uv = tex_coord;\n"
+		"	gl_Position = vec4(position.xy * 1.6 - 0.8, 0.0, 1.0);\n"
+		"}\n";
+	const char* const view_frag_code =
+		"#version 330 core\n"
+		"in vec2 uv;\n"
+		"out vec4 frag_color;\n"
+		"uniform sampler2D texture_diffuse1;\n"
+		"void main()\n"
+		"{\n"
+		"	frag_color = texture(texture_diffuse1, uv);\n"
+		"}\n";
+
+	// tells whether meshes were mapped from cache,
+	// they only have gl buffers then
+	class CachedObjModel : public ObjModel
+	{
+	public:
+		using ObjModel::get_cache_filename;
+
+		bool is_from_cache()
+		{
+			for (size_t m_id = 0; m_id < meshes.size(); ++m_id)
+			{
+				if (!meshes[m_id].get_vertices().empty())
+					return false;
+			}
+			return !meshes.empty();
+		}
+	};
+
+	// model drawn with its diffuse textures only
+	class MeshCacheView : public GlfwApp
+	{
+	protected:
+		const char* model_filename;
+		OpenGLShaderProgram* program;
+		CachedObjModel* model;
+		bool from_cache;
+
+	public:
+		MeshCacheView(const char* filename) :
+			model_filename(filename), program(nullptr),
+			model(nullptr), from_cache(false) {}
+
+		inline bool is_from_cache() const { return from_cache; }
+
+		int init() override
+		{
+			const OpenGLShader::ShaderType types[2] = { OpenGLShader::Vertex, OpenGLShader::Fragment };
+			const char* codes[2] = { view_vert_code, view_frag_code };
+			program = new OpenGLShaderProgram;
+			if (!program->create_from_code(types, codes, 2))
+				return -1;
+			model = new CachedObjModel;
+			model->set_cache_dir(".");
+			model->load_model(model_filename);
+			from_cache = model->is_from_cache();
+			return 0;
+		}
+
+		int paint() override
+		{
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			program->use();
+			model->draw(*program);
+			return 0;
+		}
+
+		void destroy() override
+		{
+			// gl objects are deleted while context is current
+			delete model;
+			model = nullptr;
+			delete program;
+			program = nullptr;
+		}
+	};
+
+	int write_color_png(const char* filename, unsigned char r, unsigned char g, unsigned char b)
+	{
+		const int size = 4;
+		std::vector<unsigned char> pixels(size * size * 3);
+		for (size_t p_id = 0; p_id < pixels.size(); p_id += 3)
+		{
+			pixels[p_id] = r;
+			pixels[p_id + 1] = g;
+			pixels[p_id + 2] = b;
+		}
+		return write_png(filename, size, size, 3, &pixels[0]);
+	}
+
+	// Model with a red and a green material is imported, then mapped
+	// from cache, both frames must be the same. Return number of errors.
+	size_t compare_cached_frames()
+	{
+		const char* model_filename = "./test_mesh_cache_view.obj";
+		if (write_color_png("test_mesh_cache_lower.png", 255, 0, 0) ||
+			write_color_png("test_mesh_cache_upper.png", 0, 255, 0))
+			return 1;
+		write_grid_mtl("test_mesh_cache_view.mtl", "test_mesh_cache_lower.png",
+			"test_mesh_cache_upper.png", nullptr);
+		write_grid_obj(model_filename, "test_mesh_cache_view.mtl", 8);
+		// cache of earlier runs is up to date for the same contents
+		{
+			CachedObjModel model;
+			model.set_cache_dir(".");
+			std::remove(model.get_cache_filename(model_filename).c_str());
+		}
+
+		size_t error_num = 0;
+		std::vector<unsigned char> frames[2];
+		const char* png_filenames[2] = { "mesh_cache_imported.png", "mesh_cache_mapped.png" };
+		for (size_t r_id = 0; r_id < 2; ++r_id)
+		{
+			MeshCacheView app(model_filename);
+			app.set_headless(true);
+			if (app.run_frames(1, png_filenames[r_id], 64, 64))
+				return error_num + 1;
+			if (app.is_from_cache() != (r_id == 1))
+			{
+				std::cout << (r_id ? "model isn't mapped from cache\n" : "model isn't imported\n");
+				++error_num;
+			}
+			// both materials are drawn
+			frames[r_id] = app.get_frame_pixels();
+			size_t red_num = 0, green_num = 0;
+			for (size_t p_id = 0; p_id < frames[r_id].size(); p_id += 4)
+			{
+				red_num += frames[r_id][p_id] > 128;
+				green_num += frames[r_id][p_id + 1] > 128;
+			}
+			std::cout << png_filenames[r_id] << ": " << red_num << " red, "
+				<< green_num << " green pixels\n";
+			if (red_num == 0 || green_num == 0)
+				++error_num;
+		}
+		if (frames[0] != frames[1])
+		{
+			std::cout << "frames of imported and cached model differ\n";
+			++error_num;
+		}
+		return error_num;
+	}
+}
+
+int test_mesh_cache(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	const size_t grid_res = 300;
+	write_grid_mtl("test_mesh_cache.mtl", "shared_diffuse.png", "shared_diffuse.png", nullptr);
+	write_grid_obj("test_mesh_cache.obj", "test_mesh_cache.mtl", grid_res);
+
+	system_clock::time_point start_time = system_clock::now();
+	std::vector<MeshGLBuffer> meshes;
+	ObjFileParser parser;
+	if (parser.load("./test_mesh_cache.obj", meshes))
+		return -1;
+	system_clock::time_point parse_time = system_clock::now();
+	if (MeshCacheFile::write("test_mesh_cache.mshc", "test_mesh_cache.obj",
+		meshes.data(), meshes.size(), parser.get_material_filenames()))
+		return -1;
+
+	system_clock::time_point open_time = system_clock::now();
+	MeshCacheFile file;
+	if (file.open("test_mesh_cache.mshc"))
+		return -1;
+	bool up_to_date = file.is_up_to_date("test_mesh_cache.obj");
+	system_clock::time_point end_time = system_clock::now();
+	std::cout << "parse obj " << std::chrono::duration_cast<std::chrono::microseconds>(parse_time - start_time).count()
+		<< " us, map cache " << std::chrono::duration_cast<std::chrono::microseconds>(end_time - open_time).count()
+		<< " us\n";
+
+	size_t error_num = compare_cache(file, meshes);
+	if (file.get_dependency_num() != 1)
+	{
+		std::cout << "mtl file isn't a dependency\n";
+		++error_num;
+	}
+	// both materials only have the same texture
+	std::cout << file.get_mesh_num() << " meshes, "
+		<< file.get_header().material_num << " materials, "
+		<< file.get_header().texture_num << " textures\n";
+	if (file.get_header().material_num != 1 || file.get_header().texture_num != 1)
+		++error_num;
+	if (!up_to_date)
+	{
+		std::cout << "cache is stale after written\n";
+		++error_num;
+	}
+
+	// same contents rewritten, stale only if hash differs
+	write_grid_obj("test_mesh_cache.obj", "test_mesh_cache.mtl", grid_res);
+	if (!file.is_up_to_date("test_mesh_cache.obj"))
+	{
+		std::cout << "cache is stale after source is rewritten\n";
+		++error_num;
+	}
+	// changed source
+	{
+		std::ofstream obj_file("test_mesh_cache.obj", std::ios::app);
+		obj_file << "v 0 0 0\n";
+	}
+	if (file.is_up_to_date("test_mesh_cache.obj"))
+	{
+		std::cout << "cache is up to date after source changes\n";
+		++error_num;
+	}
+
+	// changed materials with the same source
+	write_grid_obj("test_mesh_cache.obj", "test_mesh_cache.mtl", grid_res);
+	{
+		std::ofstream mtl_file("test_mesh_cache.mtl", std::ios::app);
+		mtl_file << "Kd 1.0 0.0 0.0\n";
+	}
+	if (file.is_up_to_date("test_mesh_cache.obj"))
+	{
+		std::cout << "cache is up to date after mtl changes\n";
+		++error_num;
+	}
+
+	error_num += compare_cached_frames();
+
+	std::cout << error_num << " errors" << std::endl;
+	return error_num == 0 ? 0 : -1;
+}
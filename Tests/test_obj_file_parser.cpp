@@ -0,0 +1,115 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "ParallelFor.h"
+#include "ObjFileParser.h"
+
+#include "TestsMain.h"
+
+namespace
+{
+	bool same_meshes(std::vector<MeshGLBuffer>& a, std::vector<MeshGLBuffer>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t m_id = 0; m_id < a.size(); ++m_id)
+		{
+			if (a[m_id].get_indices() != b[m_id].get_indices() ||
+				a[m_id].get_vertices().size() != b[m_id].get_vertices().size() ||
+				memcmp(&a[m_id].get_vertices()[0], &b[m_id].get_vertices()[0],
+					a[m_id].get_vertices().size() * sizeof(Vertex)))
+				return false;
+		}
+		return true;
+	}
+}
+
+int test_obj_file_parser(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	// float parser against strtod
+	const char* numbers[] = { "0", "-1.5", "+2.25e3", "1e-7", "0.000123456789",
+		"123456789.125", "3.4028234e38", "-.5", "7.", "1E+2" };
+	size_t float_error_num = 0;
+	for (size_t n_id = 0; n_id < sizeof(numbers) / sizeof(numbers[0]); ++n_id)
+	{
+		const char* str = numbers[n_id];
+		float value = 0.0f;
+		const char* end = ObjFileParser::parse_float(str, str + strlen(str), value);
+		float expected = float(strtod(str, nullptr));
+		if (end != str + strlen(str) || value != expected)
+		{
+			std::cout << "parse_float(\"" << str << "\") = " << value << ", expected " << expected << "\n";
+			++float_error_num;
+		}
+	}
+
+	const size_t grid_res = 400;
+	write_grid_mtl("test_obj_file_parser.mtl", "lower_diffuse.png", "upper_diffuse.png", "upper_normal.png");
+	write_grid_obj("test_obj_file_parser.obj", "test_obj_file_parser.mtl", grid_res);
+
+	std::vector<MeshGLBuffer> serial_meshes, parallel_meshes;
+	system_clock::time_point start_time = system_clock::now();
+	ObjFileParser serial_parser;
+	serial_parser.set_thread_num(1);
+	if (serial_parser.load("./test_obj_file_parser.obj", serial_meshes))
+		return -1;
+	system_clock::time_point mid_time = system_clock::now();
+	// several chunks even on machines with few cores
+	size_t thread_num = get_default_thread_num();
+	if (thread_num < 4)
+		thread_num = 4;
+	ObjFileParser parallel_parser;
+	parallel_parser.set_thread_num(thread_num);
+	if (parallel_parser.load("./test_obj_file_parser.obj", parallel_meshes))
+		return -1;
+	system_clock::time_point end_time = system_clock::now();
+	std::cout << "load " << grid_res * grid_res << " quads: 1 thread "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(mid_time - start_time).count()
+		<< " ms, " << thread_num << " threads "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end_time - mid_time).count()
+		<< " ms\n";
+
+	// each half has its rows of vertices, two triangles per quad
+	size_t error_num = float_error_num;
+	const size_t half_vert_num = (grid_res + 1) * (grid_res / 2 + 1);
+	const size_t half_index_num = grid_res * grid_res / 2 * 6;
+	if (parallel_meshes.size() != 2)
+		++error_num;
+	for (size_t m_id = 0; m_id < parallel_meshes.size(); ++m_id)
+	{
+		MeshGLBuffer& mesh = parallel_meshes[m_id];
+		std::cout << "mesh " << m_id << ": " << mesh.get_vertices().size() << " vertices, "
+			<< mesh.get_indices().size() << " indices, " << mesh.get_textures().size() << " textures\n";
+		if (mesh.get_vertices().size() != half_vert_num ||
+			mesh.get_indices().size() != half_index_num)
+			++error_num;
+		// tangent follows u, tex coord v is flipped
+		if (!mesh.get_vertices().empty())
+		{
+			const Vertex& vertex = mesh.get_vertices()[0];
+			if (std::abs(vertex.tangent.x - 1.0f) > 1e-4f ||
+				std::abs(vertex.tex_coord.y - (1.0f - vertex.position.y)) > 1e-6f)
+				++error_num;
+		}
+	}
+	if (parallel_meshes.size() == 2 &&
+		(parallel_meshes[0].get_textures().size() != 1 ||
+		 parallel_meshes[1].get_textures().size() != 2 ||
+		 parallel_meshes[1].get_textures()[0].type != "texture_diffuse" ||
+		 parallel_meshes[1].get_textures()[1].filename != "upper_normal.png"))
+		++error_num;
+	if (!same_meshes(serial_meshes, parallel_meshes))
+	{
+		std::cout << "meshes differ between 1 and " << thread_num << " threads\n";
+		++error_num;
+	}
+
+	std::cout << error_num << " errors" << std::endl;
+	return error_num == 0 ? 0 : -1;
+}
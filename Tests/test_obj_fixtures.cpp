@@ -0,0 +1,58 @@
+#include <fstream>
+
+#include "TestsMain.h"
+
+// Grid of quads in two materials, upper half uses negative
+// indices. Vertices of middle row are in both meshes.
+void write_grid_obj(const char* filename, const char* mtl_filename, size_t grid_res)
+{
+	std::ofstream file(filename);
+	file << "mtllib " << mtl_filename << "\n";
+	for (size_t y = 0; y <= grid_res; ++y)
+	{
+		for (size_t x = 0; x <= grid_res; ++x)
+		{
+			file << "v " << float(x) / grid_res << " " << float(y) / grid_res << " 0.0\n";
+			file << "vt " << float(x) / grid_res << " " << float(y) / grid_res << "\n";
+		}
+	}
+	file << "vn 0 0 1\n";
+
+	const size_t row_size = grid_res + 1;
+	const size_t vert_num = row_size * row_size;
+	for (size_t y = 0; y < grid_res; ++y)
+	{
+		if (y == 0)
+			file << "usemtl lower\n";
+		else if (y == grid_res / 2)
+			file << "usemtl upper\n";
+		for (size_t x = 0; x < grid_res; ++x)
+		{
+			size_t ids[4] = { y * row_size + x + 1, y * row_size + x + 2,
+				(y + 1) * row_size + x + 2, (y + 1) * row_size + x + 1 };
+			file << "f";
+			for (size_t c_id = 0; c_id < 4; ++c_id)
+			{
+				if (y < grid_res / 2)
+					file << " " << ids[c_id] << "/" << ids[c_id] << "/1";
+				else
+					file << " " << long(ids[c_id]) - long(vert_num) - 1 << "/"
+						<< long(ids[c_id]) - long(vert_num) - 1 << "/-1";
+			}
+			file << "\n";
+		}
+	}
+}
+
+void write_grid_mtl(const char* filename, const char* lower_diffuse,
+	const char* upper_diffuse, const char* upper_normal)
+{
+	std::ofstream file(filename);
+	file << "newmtl lower\n"
+		<< "Kd 0.8 0.8 0.8\n"
+		<< "map_Kd " << lower_diffuse << "\n"
+		<< "newmtl upper\n";
+	if (upper_normal)
+		file << "map_Bump -bm 0.5 " << upper_normal << "\n";
+	file << "map_Kd " << upper_diffuse << "\n";
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+#include <chrono>
+
+#include "PoissonDiskSampling.h"
+#include "PDSAnalysis.h"
+
+#include "TestsMain.h"
+
+int test_pds_analysis(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	system_clock::time_point start_time, end_time;
+	std::chrono::milliseconds duration;
+
+	const double dist_min = 0.002;
+	PoissonDiskSampling pds;
+	pds.set_cache_dir(".");
+	pds.generate_points_in_rect(0.0, 1.0, 0.0, 1.0, dist_min);
+	std::vector<glm::vec2> &pts = pds.get_points();
+	std::cout << pts.size() << " points" << std::endl;
+
+	PDSAnalysis analysis;
+
+	start_time = system_clock::now();
+	analysis.compute_rdf(pts, 0.0, 1.0, 0.0, 1.0, 5.0 * dist_min, 100);
+	end_time = system_clock::now();
+	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+	std::cout << "rdf: " << duration.count() << " ms" << std::endl;
+	analysis.output_rdf_to_csv("pds_rdf.csv");
+
+	start_time = system_clock::now();
+	analysis.compute_power_spectrum(pts, 0.0, 1.0, 0.0, 1.0, 1024);
+	end_time = system_clock::now();
+	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+	std::cout << "power spectrum: " << duration.count() << " ms" << std::endl;
+	analysis.output_spectrum_to_csv("pds_spectrum.csv");
+
+	return 0;
+}
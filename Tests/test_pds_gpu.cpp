@@ -0,0 +1,128 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "PoissonDiskSampling.h"
+#include "PoissonDiskSamplingGPU.h"
+
+#include "TestsMain.h"
+
+// smallest distance between points, neighbours found with grid
+static double get_min_distance(const std::vector<glm::vec2> &pts,
+	double xl, double xu, double yl, double yu, double cell_size)
+{
+	size_t x_num = size_t((xu - xl) / cell_size) + 1;
+	size_t y_num = size_t((yu - yl) / cell_size) + 1;
+	std::vector<std::vector<size_t>> cells(x_num * y_num);
+	std::vector<size_t> pt_cells(pts.size());
+	for (size_t p_id = 0; p_id < pts.size(); ++p_id)
+	{
+		size_t x_id = size_t((pts[p_id].x - xl) / cell_size);
+		size_t y_id = size_t((pts[p_id].y - yl) / cell_size);
+		if (x_id >= x_num) x_id = x_num - 1;
+		if (y_id >= y_num) y_id = y_num - 1;
+		pt_cells[p_id] = y_id * x_num + x_id;
+		cells[pt_cells[p_id]].push_back(p_id);
+	}
+
+	double dist_min2 = (xu - xl) * (xu - xl) + (yu - yl) * (yu - yl);
+	for (size_t p_id = 0; p_id < pts.size(); ++p_id)
+	{
+		size_t x_id = pt_cells[p_id] % x_num;
+		size_t y_id = pt_cells[p_id] / x_num;
+		for (size_t cy = y_id ? y_id - 1 : 0; cy <= y_id + 1 && cy < y_num; ++cy)
+			for (size_t cx = x_id ? x_id - 1 : 0; cx <= x_id + 1 && cx < x_num; ++cx)
+				for (size_t q_id : cells[cy * x_num + cx])
+				{
+					if (q_id == p_id)
+						continue;
+					double dx = double(pts[p_id].x) - double(pts[q_id].x);
+					double dy = double(pts[p_id].y) - double(pts[q_id].y);
+					double d2 = dx * dx + dy * dy;
+					if (d2 < dist_min2)
+						dist_min2 = d2;
+				}
+	}
+	return sqrt(dist_min2);
+}
+
+// Use Mesa llvmpipe without gpu by
+// setting environment variable LIBGL_ALWAYS_SOFTWARE=1
+int test_pds_gpu(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+	const double dist_min = 0.002;
+
+	if (!glfwInit())
+	{
+		std::cout << "Glfw can't initialize.\n";
+		return -1;
+	}
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow *window = glfwCreateWindow(64, 64, "test_pds_gpu", nullptr, nullptr);
+	if (!window)
+	{
+		std::cout << "Glfw can't create OpenGL 4.3 context.\n";
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGL())
+	{
+		std::cout << "Glad can't load GL functions.\n";
+		glfwTerminate();
+		return -1;
+	}
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
+
+	int res = -1;
+	{
+		PoissonDiskSamplingGPU pds_gpu;
+		CirclesGLBuffer pt_buf;
+		if (!pds_gpu.init("../../Shaders/pds_dart_throwing.comp"))
+		{
+			pt_buf.init_gpu(
+				PoissonDiskSamplingGPU::get_max_point_num(0.0, 1.0, 0.0, 1.0, dist_min),
+				1.0e-4, glm::vec3(1.0f));
+
+			system_clock::time_point start_time = system_clock::now();
+			res = pds_gpu.generate_points_in_rect(0.0, 1.0, 0.0, 1.0, dist_min, pt_buf);
+			glFinish();
+			system_clock::time_point end_time = system_clock::now();
+			std::chrono::microseconds duration
+				= std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+			std::vector<glm::vec2> pts;
+			pt_buf.read_points(pts);
+			double pt_dist = get_min_distance(pts, 0.0, 1.0, 0.0, 1.0, dist_min);
+			std::cout << "gpu: " << pts.size() << " points in "
+				<< duration.count() / 1000 << " ms, min distance "
+				<< pt_dist << " (" << dist_min << ")\n";
+			if (pt_dist < dist_min * (1.0 - 1.0e-5))
+			{
+				std::cout << "test_pds_gpu: points are too close.\n";
+				res = -1;
+			}
+		}
+	}
+
+	PoissonDiskSampling pds;
+	system_clock::time_point start_time = system_clock::now();
+	pds.generate_points_in_rect(0.0, 1.0, 0.0, 1.0, dist_min);
+	system_clock::time_point end_time = system_clock::now();
+	std::chrono::microseconds duration
+		= std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+	std::cout << "cpu: " << pds.get_points().size() << " points in "
+		<< duration.count() / 1000 << " ms\n";
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return res;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+
+#include "PointQuadtree.h"
+
+#include "TestsMain.h"
+
+int test_point_quadtree(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	const size_t pt_num = 4000000;
+	std::vector<glm::vec2> pts(pt_num);
+	std::mt19937 rand_gen(7);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+		pts[p_id] = glm::vec2(dist(rand_gen), dist(rand_gen));
+	std::vector<glm::vec2> init_pts = pts;
+
+	PointQuadtree quadtree;
+	std::vector<uint32_t> perm;
+	system_clock::time_point start_time = system_clock::now();
+	quadtree.build(pts, -1.0, 1.0, -1.0, 1.0, &perm);
+	system_clock::time_point end_time = system_clock::now();
+	std::cout << "build " << pt_num << " points: "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+		<< " ms, " << quadtree.get_nodes().size() << " nodes, "
+		<< quadtree.get_leaf_num() << " leaves" << std::endl;
+
+	size_t mismatch_num = 0;
+	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+	{
+		if (pts[p_id].x != init_pts[perm[p_id]].x ||
+			pts[p_id].y != init_pts[perm[p_id]].y)
+			++mismatch_num;
+	}
+	std::cout << mismatch_num << " permutation mismatches" << std::endl;
+
+	// every point inside the view must be selected without subsampling
+	const double xl = 0.1, xu = 0.3, yl = -0.5, yu = -0.2;
+	std::vector<PointQuadtree::Range> ranges;
+	size_t sel_num = quadtree.select(xl, xu, yl, yu, 0.0, ranges);
+	std::vector<char> selected(pt_num, 0);
+	for (size_t r_id = 0; r_id < ranges.size(); ++r_id)
+		for (uint32_t p_id = 0; p_id < ranges[r_id].num; ++p_id)
+			selected[ranges[r_id].first + p_id] = 1;
+	size_t in_num = 0, missed_num = 0;
+	for (size_t p_id = 0; p_id < pt_num; ++p_id)
+	{
+		const glm::vec2 &p = pts[p_id];
+		if (p.x >= xl && p.x <= xu && p.y >= yl && p.y <= yu)
+		{
+			++in_num;
+			if (!selected[p_id])
+				++missed_num;
+		}
+	}
+	std::cout << "view selects " << sel_num << " points in "
+		<< ranges.size() << " ranges for " << in_num
+		<< " points inside, " << missed_num << " missed" << std::endl;
+
+	// zoomed out to 800 x 800 pixels with 0.5 points per pixel
+	start_time = system_clock::now();
+	sel_num = quadtree.select(-1.0, 1.0, -1.0, 1.0, 0.5 * 400.0 * 400.0, ranges);
+	end_time = system_clock::now();
+	std::cout << "subsample selects " << sel_num << " points in "
+		<< ranges.size() << " ranges: "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count()
+		<< " us" << std::endl;
+
+	return 0;
+}
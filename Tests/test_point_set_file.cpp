@@ -0,0 +1,73 @@
+#include <iostream>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+
+#include "PoissonDiskSampling.h"
+#include "PointSetFile.h"
+
+#include "TestsMain.h"
+
+int test_point_set_file(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	system_clock::time_point start_time, end_time;
+	std::chrono::milliseconds duration;
+
+	// first run generates and writes cache,
+	// second run loads from cache
+	for (size_t i = 0; i < 2; ++i)
+	{
+		PoissonDiskSampling pds;
+		pds.set_cache_dir(".");
+		start_time = system_clock::now();
+		pds.generate_points_in_rect(-1.0, 1.0, -1.0, 1.0, 0.002);
+		end_time = system_clock::now();
+		duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+		std::cout << "run " << i << ": " << pds.get_points().size()
+			<< " points in " << duration.count() << " ms" << std::endl;
+	}
+
+	// write and map
+	PoissonDiskSampling pds;
+	pds.generate_points_in_rect(0.0, 1.0, 0.0, 1.0, 0.01);
+	std::vector<glm::vec2> &pts = pds.get_points();
+	PointSetHeader header;
+	header.seed = pds.get_seed();
+	header.xl = 0.0;
+	header.xu = 1.0;
+	header.yl = 0.0;
+	header.yu = 1.0;
+	header.dist_min = 0.01;
+	if (PointSetFile::write("test_point_set.pts", header, &pts[0], pts.size()))
+		return -1;
+
+	PointSetFile pt_file;
+	if (pt_file.open("test_point_set.pts"))
+		return -1;
+	const glm::vec2 *mapped_pts = pt_file.get_points();
+	size_t mismatch_num = 0;
+	for (size_t p_id = 0; p_id < pts.size(); ++p_id)
+	{
+		if (mapped_pts[p_id].x != pts[p_id].x ||
+			mapped_pts[p_id].y != pts[p_id].y)
+			++mismatch_num;
+	}
+	std::cout << "mapped " << pt_file.get_point_num() << " points, "
+		<< mismatch_num << " mismatches" << std::endl;
+	pt_file.close();
+
+	// point count whose data size overflows must be rejected
+	{
+		std::fstream file("test_point_set.pts", std::ios::in | std::ios::out | std::ios::binary);
+		uint64_t corrupt_pt_num = (~uint64_t(0)) / 8 + 1;
+		file.seekp(offsetof(PointSetHeader, pt_num));
+		file.write((const char *)&corrupt_pt_num, sizeof(corrupt_pt_num));
+	}
+	bool corrupt_opened = pt_file.open("test_point_set.pts") == 0;
+	if (corrupt_opened)
+		std::cout << "corrupt point count accepted" << std::endl;
+
+	return mismatch_num == 0 && !corrupt_opened ? 0 : -1;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+
+#include "PoissonDiskSampling.h"
+#include "PointSetSort.h"
+
+#include "TestsMain.h"
+
+// average distance between consecutive points in memory
+static double get_avg_step(std::vector<glm::vec2> &pts)
+{
+	double dist_sum = 0.0;
+	for (size_t p_id = 1; p_id < pts.size(); ++p_id)
+	{
+		double dx = pts[p_id].x - pts[p_id - 1].x;
+		double dy = pts[p_id].y - pts[p_id - 1].y;
+		dist_sum += sqrt(dx * dx + dy * dy);
+	}
+	return pts.size() > 1 ? dist_sum / double(pts.size() - 1) : 0.0;
+}
+
+int test_point_set_sort(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	system_clock::time_point start_time, end_time;
+	std::chrono::milliseconds duration;
+
+	PoissonDiskSampling pds;
+	pds.set_cache_dir(".");
+	pds.generate_points_in_rect(0.0, 1.0, 0.0, 1.0, 0.001);
+	std::vector<glm::vec2> pts = pds.get_points();
+	std::cout << pts.size() << " points, acceptance order avg step "
+		<< get_avg_step(pts) << std::endl;
+
+	const char *key_names[] = { "none", "morton", "hilbert" };
+	PointSetSort sorter;
+	std::vector<uint32_t> perm;
+	for (int key = PointSetSort::None; key <= PointSetSort::Hilbert; ++key)
+	{
+		pts = pds.get_points();
+		start_time = system_clock::now();
+		sorter.sort(pts, 0.0, 1.0, 0.0, 1.0, PointSetSort::KeyType(key), &perm);
+		end_time = system_clock::now();
+		duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+		if (perm.size() != pts.size())
+		{
+			std::cout << key_names[key] << " order: permutation not filled" << std::endl;
+			return -1;
+		}
+
+		size_t mismatch_num = 0;
+		for (size_t p_id = 0; p_id < pts.size(); ++p_id)
+		{
+			if (pts[p_id].x != pds.get_points()[perm[p_id]].x)
+				++mismatch_num;
+		}
+		std::cout << key_names[key] << " order: " << duration.count() << " ms, avg step "
+			<< get_avg_step(pts) << ", " << mismatch_num << " permutation mismatches" << std::endl;
+	}
+
+	return 0;
+}
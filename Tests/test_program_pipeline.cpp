@@ -0,0 +1,220 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "GlfwApp.h"
+#include "OpenGLShaderUtilities.h"
+
+#include "TestsMain.h"
+
+namespace
+{
+	const size_t vert_num = 4; // e.g. vertex formats
+	const size_t frag_num = 4; // e.g. materials
+
+	// quad of variant size in grid cell, uv is matched by location
+	const char* const vert_code =
+		"out gl_PerVertex { vec4 gl_Position; };\n"
+		"layout(location = 0) out vec2 uv;\n"
+		"uniform vec2 cell;\n"
+		"void main()\n"
+		"{\n"
+		"	uv = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+		"	vec2 pos = (cell + uv * (0.25 + 0.25 * float(VARIANT))) / 4.0;\n"
+		"	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);\n"
+		"}\n";
+	const char* const frag_code =
+		"layout(location = 0) in vec2 uv;\n"
+		"out vec4 frag_color;\n"
+		"void main()\n"
+		"{\n"
+		"	vec3 colors[4] = vec3[](vec3(1.0, 0.2, 0.2), vec3(0.2, 1.0, 0.2),\n"
+		"		vec3(0.2, 0.2, 1.0), vec3(1.0, 1.0, 0.2));\n"
+		"	frag_color = vec4(colors[VARIANT] * (0.5 + 0.5 * uv.x), 1.0);\n"
+		"}\n";
+
+	std::string get_variant_code(const char* code, size_t variant)
+	{
+		return "#version 410 core\n#define VARIANT " + std::to_string(variant) + "\n" + code;
+	}
+}
+
+// Grid of every vertex and fragment combination, drawn with program
+// pipelines on the left and with monolithic programs on the right.
+class ProgramPipelineView : public GlfwApp
+{
+protected:
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	std::vector<OpenGLShaderProgram> vert_programs;
+	std::vector<OpenGLShaderProgram> frag_programs;
+	OpenGLProgramPipeline pipeline;
+	std::vector<OpenGLShaderProgram> linked_programs;
+	GLuint vao_id;
+	bool compared;
+	size_t mismatch_num;
+
+	static double get_ms(TimePoint start, TimePoint end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	void draw_grid(bool use_pipeline)
+	{
+		gl_state.bind_vertex_array(vao_id);
+		if (use_pipeline)
+			pipeline.bind();
+		for (size_t v_id = 0; v_id < vert_num; ++v_id)
+		{
+			for (size_t f_id = 0; f_id < frag_num; ++f_id)
+			{
+				OpenGLShaderProgram* uniform_program;
+				if (use_pipeline)
+				{
+					pipeline.set_stage(OpenGLShader::Vertex, &vert_programs[v_id]);
+					pipeline.set_stage(OpenGLShader::Fragment, &frag_programs[f_id]);
+					pipeline.set_active_program(vert_programs[v_id]);
+					uniform_program = &vert_programs[v_id];
+				}
+				else
+				{
+					uniform_program = &linked_programs[v_id * frag_num + f_id];
+					uniform_program->use();
+				}
+				uniform_program->set_uniform(uniform_program->uniform_loc("cell"),
+					glm::vec2(float(f_id), float(v_id)));
+				glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			}
+		}
+	}
+
+public:
+	ProgramPipelineView() :
+		vert_programs(vert_num), frag_programs(frag_num),
+		linked_programs(vert_num * frag_num),
+		vao_id(0), compared(false), mismatch_num(0) {}
+
+	inline size_t get_mismatch_num() const { return mismatch_num; }
+
+	int init() override
+	{
+		OpenGLShaderSupportCheck support;
+		if (!support.support_separate_shader_objects())
+		{
+			std::cout << "program pipelines are not supported\n";
+			return -1;
+		}
+
+		std::vector<std::string> vert_codes(vert_num), frag_codes(frag_num);
+		for (size_t v_id = 0; v_id < vert_num; ++v_id)
+			vert_codes[v_id] = get_variant_code(vert_code, v_id);
+		for (size_t f_id = 0; f_id < frag_num; ++f_id)
+			frag_codes[f_id] = get_variant_code(frag_code, f_id);
+
+		// one link per stage program
+		TimePoint start_time = std::chrono::steady_clock::now();
+		OpenGLShader::ShaderType type = OpenGLShader::Vertex;
+		for (size_t v_id = 0; v_id < vert_num; ++v_id)
+		{
+			const char* code = vert_codes[v_id].c_str();
+			vert_programs[v_id].set_separable(true);
+			if (!vert_programs[v_id].create_from_code(&type, &code, 1))
+				return -1;
+		}
+		type = OpenGLShader::Fragment;
+		for (size_t f_id = 0; f_id < frag_num; ++f_id)
+		{
+			const char* code = frag_codes[f_id].c_str();
+			frag_programs[f_id].set_separable(true);
+			if (!frag_programs[f_id].create_from_code(&type, &code, 1))
+				return -1;
+		}
+		if (!pipeline.create())
+			return -1;
+		pipeline.set_stage(OpenGLShader::Vertex, &vert_programs[0]);
+		pipeline.set_stage(OpenGLShader::Fragment, &frag_programs[0]);
+		if (!pipeline.validate())
+		{
+			std::cout << "pipeline is invalid:\n" << pipeline.get_log() << "\n";
+			return -1;
+		}
+		TimePoint mid_time = std::chrono::steady_clock::now();
+
+		// one link per combination
+		const OpenGLShader::ShaderType types[2] = { OpenGLShader::Vertex, OpenGLShader::Fragment };
+		for (size_t v_id = 0; v_id < vert_num; ++v_id)
+		{
+			for (size_t f_id = 0; f_id < frag_num; ++f_id)
+			{
+				const char* codes[2] = { vert_codes[v_id].c_str(), frag_codes[f_id].c_str() };
+				if (!linked_programs[v_id * frag_num + f_id].create_from_code(types, codes, 2))
+					return -1;
+			}
+		}
+		TimePoint end_time = std::chrono::steady_clock::now();
+		std::cout << vert_num + frag_num << " separable programs: "
+			<< get_ms(start_time, mid_time) << " ms, "
+			<< vert_num * frag_num << " linked programs: "
+			<< get_ms(mid_time, end_time) << " ms\n";
+
+		glGenVertexArrays(1, &vao_id);
+		return 0;
+	}
+
+	int paint() override
+	{
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		int half_width = width / 2;
+		glViewport(0, 0, half_width, height);
+		draw_grid(true);
+		glViewport(half_width, 0, half_width, height);
+		draw_grid(false);
+		glViewport(0, 0, width, height);
+
+		if (!compared)
+		{
+			std::vector<unsigned char> pixels(size_t(width) * height * 4);
+			glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+			for (int y = 0; y < height; ++y)
+			{
+				const unsigned char* row = &pixels[size_t(y) * width * 4];
+				for (int x = 0; x < half_width * 4; ++x)
+				{
+					if (row[x] != row[half_width * 4 + x])
+						++mismatch_num;
+				}
+			}
+			std::cout << mismatch_num << " pixel channels differ between pipelines and linked programs\n";
+			compared = true;
+		}
+		return 0;
+	}
+
+	void destroy() override
+	{
+		if (vao_id)
+		{
+			gl_state.delete_vertex_arrays(1, &vao_id);
+			vao_id = 0;
+		}
+		pipeline.destroy();
+		vert_programs.clear();
+		frag_programs.clear();
+		linked_programs.clear();
+	}
+};
+
+int test_program_pipeline(int argc, char** argv)
+{
+	ProgramPipelineView app;
+	app.set_win_name("Program pipeline");
+	app.set_gl_version(4, 1);
+	int res = 0;
+	if (app.is_headless())
+		res = app.run_frames(1, "program_pipeline.png");
+	else
+		app.run();
+	return res == 0 && app.get_mismatch_num() == 0 ? 0 : -1;
+}
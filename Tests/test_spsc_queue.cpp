@@ -0,0 +1,61 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#include "SpscQueue.h"
+
+#include "TestsMain.h"
+
+int test_spsc_queue(int argc, char** argv)
+{
+	using std::chrono::system_clock;
+
+	SpscQueue<size_t> queue(1000);
+	std::cout << "capacity " << queue.capacity() << std::endl;
+
+	// fill and drain on one thread
+	size_t push_num = 0;
+	while (queue.push(push_num))
+		++push_num;
+	size_t pop_num = 0, order_error_num = 0, val;
+	while (queue.pop(val))
+	{
+		if (val != pop_num)
+			++order_error_num;
+		++pop_num;
+	}
+	std::cout << "full after " << push_num << " pushes, "
+		<< pop_num << " pops, " << order_error_num << " out of order" << std::endl;
+
+	// producer and consumer threads, consumer checks order
+	const size_t item_num = 10000000;
+	size_t recv_num = 0, error_num = 0;
+	system_clock::time_point start_time = system_clock::now();
+	std::thread consumer([&]()
+		{
+			size_t item;
+			while (recv_num < item_num)
+			{
+				if (!queue.pop(item))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				if (item != recv_num)
+					++error_num;
+				++recv_num;
+			}
+		});
+	for (size_t i_id = 0; i_id < item_num; ++i_id)
+	{
+		while (!queue.push(i_id))
+			std::this_thread::yield();
+	}
+	consumer.join();
+	system_clock::time_point end_time = system_clock::now();
+	std::cout << "pass " << recv_num << " items between threads: "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+		<< " ms, " << error_num << " out of order" << std::endl;
+
+	return order_error_num == 0 && error_num == 0 && queue.empty() ? 0 : -1;
+}